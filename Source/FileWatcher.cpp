@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////////////
+// filewatcher.cpp
+// ============
+// notice when watched files are changed on disk
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FileWatcher.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of the global variables and defines
+namespace
+{
+	// time between two checks of the watched files
+	const double g_PollIntervalSeconds = 0.25;
+}
+
+/***********************************************************
+ *  FileWatcher()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FileWatcher::FileWatcher()
+{
+	m_lastPollTime = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  ~FileWatcher()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FileWatcher::~FileWatcher()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  Watch()
+ *
+ *  This method is used for adding the file at the passed in
+ *  path to the watched files.  Its current contents count as
+ *  already reported, so only later changes are seen.
+ ***********************************************************/
+FileWatcher::WATCH_HANDLE FileWatcher::Watch(const std::string& filename)
+{
+	for (int i = 0; i < m_files.size(); i++)
+	{
+		if (m_files[i].filename == filename)
+		{
+			return(i);
+		}
+	}
+
+	WATCHED_FILE file;
+	file.filename = filename;
+	file.stamp.modifiedTime = 0;
+	file.stamp.size = 0;
+	file.bExists = GetFileStamp(filename, file.stamp);
+	file.pendingStamp = file.stamp;
+	file.bPending = false;
+	m_files.push_back(file);
+
+	return((WATCH_HANDLE)m_files.size() - 1);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for forgetting all the watched files.
+ ***********************************************************/
+void FileWatcher::Clear()
+{
+	m_files.clear();
+}
+
+/***********************************************************
+ *  Poll()
+ *
+ *  This method is used for checking the stamps of all the
+ *  watched files once the poll interval has passed since the
+ *  last check.  A file whose stamp moved is reported when the
+ *  next check finds the same new stamp.
+ ***********************************************************/
+bool FileWatcher::Poll(std::vector<WATCH_HANDLE>& changed)
+{
+	changed.clear();
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (std::chrono::duration<double>(now - m_lastPollTime).count() < g_PollIntervalSeconds)
+	{
+		return(false);
+	}
+	m_lastPollTime = now;
+
+	for (int i = 0; i < m_files.size(); i++)
+	{
+		WATCHED_FILE& file = m_files[i];
+		FILE_STAMP stamp;
+
+		if (GetFileStamp(file.filename, stamp) == false)
+		{
+			file.bPending = false;
+			continue;
+		}
+
+		bool bSameAsReported = (file.bExists == true) &&
+			(stamp.modifiedTime == file.stamp.modifiedTime) &&
+			(stamp.size == file.stamp.size);
+		if (bSameAsReported == true)
+		{
+			file.bPending = false;
+		}
+		else if ((file.bPending == true) &&
+			(stamp.modifiedTime == file.pendingStamp.modifiedTime) &&
+			(stamp.size == file.pendingStamp.size))
+		{
+			// the file has settled since the last check
+			file.stamp = stamp;
+			file.bExists = true;
+			file.bPending = false;
+			changed.push_back(i);
+		}
+		else
+		{
+			file.pendingStamp = stamp;
+			file.bPending = true;
+		}
+	}
+
+	return(changed.size() > 0);
+}
+
+/***********************************************************
+ *  GetFileStamp()
+ *
+ *  This method is used for reading the modification time and
+ *  size of the file at the passed in path.
+ ***********************************************************/
+bool FileWatcher::GetFileStamp(const std::string& filename, FILE_STAMP& stamp)
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &attributes) == FALSE)
+	{
+		return(false);
+	}
+
+	stamp.modifiedTime = ((long long)attributes.ftLastWriteTime.dwHighDateTime << 32) |
+		(long long)attributes.ftLastWriteTime.dwLowDateTime;
+	stamp.size = ((long long)attributes.nFileSizeHigh << 32) | (long long)attributes.nFileSizeLow;
+#else
+	struct stat fileStatus;
+	if (stat(filename.c_str(), &fileStatus) != 0)
+	{
+		return(false);
+	}
+
+	// nanoseconds, so two writes within a second are told apart
+#ifdef __APPLE__
+	const struct timespec& modifiedTime = fileStatus.st_mtimespec;
+#else
+	const struct timespec& modifiedTime = fileStatus.st_mtim;
+#endif
+	stamp.modifiedTime = (long long)modifiedTime.tv_sec * 1000000000LL + (long long)modifiedTime.tv_nsec;
+	stamp.size = (long long)fileStatus.st_size;
+#endif
+
+	return(true);
+}
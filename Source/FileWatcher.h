@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////
+// filewatcher.h
+// ============
+// notice when watched files are changed on disk
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  FileWatcher
+ *
+ *  This class polls the modification time and size of a set
+ *  of files, at most a few times a second, and reports the
+ *  files that changed.  A change is only reported once the
+ *  file has looked the same for two polls in a row, so a
+ *  file that an editor is still writing is not read half
+ *  way.  Files that are missing are skipped until they are
+ *  back, which covers editors that save by replacing the
+ *  file.
+ ***********************************************************/
+class FileWatcher
+{
+public:
+	// constructor
+	FileWatcher();
+	// destructor
+	~FileWatcher();
+
+	typedef int WATCH_HANDLE;
+	static const int INVALID_WATCH = -1;
+
+	// start watching the file at the passed in path, or find
+	// the handle it is already watched with
+	WATCH_HANDLE Watch(const std::string& filename);
+	// stop watching all the files
+	void Clear();
+
+	// check the watched files when the poll interval has passed
+	// and get the handles of the ones that changed, returning
+	// true when there are any
+	bool Poll(std::vector<WATCH_HANDLE>& changed);
+
+	const std::string& GetFilename(WATCH_HANDLE handle) const { return(m_files[handle].filename); }
+	int GetFileCount() const { return((int)m_files.size()); }
+
+private:
+	// modification time and size of a file, which change
+	// whenever the file is written
+	struct FILE_STAMP
+	{
+		long long modifiedTime;
+		long long size;
+	};
+
+	struct WATCHED_FILE
+	{
+		std::string filename;
+		// stamp of the contents that were reported last
+		FILE_STAMP stamp;
+		bool bExists;
+		// stamp of a change waiting for the file to settle
+		FILE_STAMP pendingStamp;
+		bool bPending;
+	};
+
+	std::vector<WATCHED_FILE> m_files;
+	std::chrono::steady_clock::time_point m_lastPollTime;
+
+	// get the current stamp of a file, returning false when
+	// the file does not exist
+	static bool GetFileStamp(const std::string& filename, FILE_STAMP& stamp);
+};
@@ -0,0 +1,548 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.cpp
+// ============
+// measure the CPU and GPU time of named zones in every frame
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// declaration of the global variables and defines
+namespace
+{
+	// frame time at 60 frames per second, shown as half of the
+	// overlay width
+	const float g_OverlayFrameMs = 1000.0f / 60.0f;
+	// height of one overlay bar and the gap between zones, in pixels
+	const int g_OverlayBarHeight = 5;
+	const int g_OverlayZoneGap = 3;
+	const int g_OverlayMargin = 10;
+
+	// colors that the overlay bars of the zones cycle through
+	const float g_OverlayColors[][3] =
+	{
+		{ 0.9f, 0.3f, 0.3f },
+		{ 0.3f, 0.9f, 0.3f },
+		{ 0.3f, 0.5f, 0.9f },
+		{ 0.9f, 0.8f, 0.2f },
+		{ 0.8f, 0.3f, 0.9f },
+		{ 0.2f, 0.9f, 0.9f },
+		{ 0.9f, 0.6f, 0.2f },
+		{ 0.6f, 0.6f, 0.6f }
+	};
+	const int g_OverlayColorCount = sizeof(g_OverlayColors) / sizeof(g_OverlayColors[0]);
+}
+
+/***********************************************************
+ *  FrameProfiler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameProfiler::FrameProfiler()
+{
+	m_startTime = std::chrono::steady_clock::now();
+	m_frameNumber = 0;
+	m_frameStartUs = 0.0;
+	m_bInFrame = false;
+	m_bGpuTiming = false;
+	m_bGpuTimingChecked = false;
+	m_droppedGpuFrames = 0;
+	m_bOverlayVisible = false;
+
+	for (int i = 0; i < QUERY_FRAMES; i++)
+	{
+		m_frameQueries[i].usedPairs = 0;
+		m_frameQueries[i].lastQuery = -1;
+		m_frameQueries[i].frameNumber = 0;
+		m_frameQueries[i].cpuFrameStartUs = 0.0;
+	}
+	for (int i = 0; i < HISTORY_FRAMES; i++)
+	{
+		m_traceFrameNumbers[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~FrameProfiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameProfiler::~FrameProfiler()
+{
+	for (int i = 0; i < QUERY_FRAMES; i++)
+	{
+		if (m_frameQueries[i].queries.size() > 0)
+		{
+			glDeleteQueries((GLsizei)m_frameQueries[i].queries.size(), m_frameQueries[i].queries.data());
+			m_frameQueries[i].queries.clear();
+		}
+	}
+}
+
+/***********************************************************
+ *  GetTimeUs()
+ *
+ *  This method is used for getting the microseconds since
+ *  the profiler was created.
+ ***********************************************************/
+double FrameProfiler::GetTimeUs() const
+{
+	std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - m_startTime;
+	return(elapsed.count());
+}
+
+/***********************************************************
+ *  RegisterZone()
+ *
+ *  This method is used for registering a named zone.  A zone
+ *  that is registered twice under the same name gets the
+ *  same handle.
+ ***********************************************************/
+FrameProfiler::ZONE_HANDLE FrameProfiler::RegisterZone(const char* name)
+{
+	for (int i = 0; i < m_zones.size(); i++)
+	{
+		if (m_zones[i].name == name)
+		{
+			return(i);
+		}
+	}
+
+	ZONE_INFO zone;
+	zone.name = name;
+	zone.cpuFrameMs = 0.0;
+	zone.bEnteredThisFrame = false;
+	zone.cpuStartUs = 0.0;
+	zone.openQueryPair = -1;
+	zone.cpuHistoryNext = 0;
+	zone.gpuHistoryNext = 0;
+	m_zones.push_back(zone);
+
+	return((int)m_zones.size() - 1);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a new frame.  The queries
+ *  of the frame that last used the same query slot are read
+ *  first if the GPU has finished them, and are dropped
+ *  otherwise.
+ ***********************************************************/
+void FrameProfiler::BeginFrame()
+{
+	// the OpenGL context exists once the first frame starts
+	if (m_bGpuTimingChecked == false)
+	{
+		m_bGpuTiming = (GLEW_ARB_timer_query != 0);
+		m_bGpuTimingChecked = true;
+	}
+
+	m_frameNumber++;
+	m_frameStartUs = GetTimeUs();
+	m_bInFrame = true;
+
+	FRAME_QUERIES& frame = m_frameQueries[m_frameNumber % QUERY_FRAMES];
+	if (frame.usedPairs > 0)
+	{
+		ResolveQueries(frame);
+	}
+	frame.usedPairs = 0;
+	frame.lastQuery = -1;
+	frame.frameNumber = m_frameNumber;
+	frame.cpuFrameStartUs = m_frameStartUs;
+
+	int traceSlot = m_frameNumber % HISTORY_FRAMES;
+	m_traceFrames[traceSlot].clear();
+	m_traceFrameNumbers[traceSlot] = m_frameNumber;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for adding the CPU times of the zones
+ *  entered in this frame to their histories.
+ ***********************************************************/
+void FrameProfiler::EndFrame()
+{
+	for (ZONE_INFO& zone : m_zones)
+	{
+		if (zone.bEnteredThisFrame == true)
+		{
+			AddSample(zone.cpuHistory, zone.cpuHistoryNext, (float)zone.cpuFrameMs);
+		}
+		zone.cpuFrameMs = 0.0;
+		zone.bEnteredThisFrame = false;
+		zone.openQueryPair = -1;
+	}
+
+	m_bInFrame = false;
+}
+
+/***********************************************************
+ *  BeginZone()
+ *
+ *  This method is used for starting one pass through the
+ *  passed in zone, taking the CPU time and issuing a GPU
+ *  timestamp query.
+ ***********************************************************/
+void FrameProfiler::BeginZone(ZONE_HANDLE zone)
+{
+	if ((m_bInFrame == false) || (zone < 0) || (zone >= m_zones.size()))
+	{
+		return;
+	}
+
+	ZONE_INFO& info = m_zones[zone];
+	info.cpuStartUs = GetTimeUs();
+	info.bEnteredThisFrame = true;
+
+	if (m_bGpuTiming == true)
+	{
+		FRAME_QUERIES& frame = m_frameQueries[m_frameNumber % QUERY_FRAMES];
+		if ((frame.usedPairs + 1) * 2 > frame.queries.size())
+		{
+			// the queries are reused by later frames, so the pool
+			// only grows until the busiest frame fits
+			int firstNew = (int)frame.queries.size();
+			frame.queries.resize(firstNew + 2);
+			glGenQueries(2, &frame.queries[firstNew]);
+			frame.zones.resize(frame.queries.size() / 2);
+		}
+
+		info.openQueryPair = frame.usedPairs;
+		frame.zones[frame.usedPairs] = zone;
+		glQueryCounter(frame.queries[frame.usedPairs * 2], GL_TIMESTAMP);
+		frame.lastQuery = frame.usedPairs * 2;
+		frame.usedPairs++;
+	}
+}
+
+/***********************************************************
+ *  EndZone()
+ *
+ *  This method is used for ending the current pass through
+ *  the passed in zone.
+ ***********************************************************/
+void FrameProfiler::EndZone(ZONE_HANDLE zone)
+{
+	if ((m_bInFrame == false) || (zone < 0) || (zone >= m_zones.size()))
+	{
+		return;
+	}
+
+	ZONE_INFO& info = m_zones[zone];
+	double endUs = GetTimeUs();
+	info.cpuFrameMs += (endUs - info.cpuStartUs) / 1000.0;
+
+	TRACE_EVENT event;
+	event.zone = zone;
+	event.bGpu = false;
+	event.startUs = info.cpuStartUs;
+	event.durationUs = endUs - info.cpuStartUs;
+	m_traceFrames[m_frameNumber % HISTORY_FRAMES].push_back(event);
+
+	if ((m_bGpuTiming == true) && (info.openQueryPair >= 0))
+	{
+		FRAME_QUERIES& frame = m_frameQueries[m_frameNumber % QUERY_FRAMES];
+		glQueryCounter(frame.queries[info.openQueryPair * 2 + 1], GL_TIMESTAMP);
+		frame.lastQuery = info.openQueryPair * 2 + 1;
+		info.openQueryPair = -1;
+	}
+}
+
+/***********************************************************
+ *  ResolveQueries()
+ *
+ *  This method is used for reading the timestamp queries of
+ *  an older frame.  The queries finish in the order they were
+ *  issued, so when the one issued last is available all of
+ *  them are - otherwise the frame is dropped rather than
+ *  waiting for the GPU.  That is the end of the outermost
+ *  zone, not of the zone that began last.
+ ***********************************************************/
+void FrameProfiler::ResolveQueries(FRAME_QUERIES& frame)
+{
+	GLuint available = 0;
+	if (frame.lastQuery < 0)
+	{
+		return;
+	}
+	glGetQueryObjectuiv(frame.queries[frame.lastQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available == 0)
+	{
+		m_droppedGpuFrames++;
+		return;
+	}
+
+	std::vector<double> frameMs(m_zones.size(), 0.0);
+	std::vector<bool> bEntered(m_zones.size(), false);
+	GLuint64 frameBase = 0;
+
+	// the trace slot still holds this frame unless it was reused
+	int traceSlot = frame.frameNumber % HISTORY_FRAMES;
+	bool bTrace = (m_traceFrameNumbers[traceSlot] == frame.frameNumber);
+
+	for (int pair = 0; pair < frame.usedPairs; pair++)
+	{
+		GLuint64 begin = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(frame.queries[pair * 2], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(frame.queries[pair * 2 + 1], GL_QUERY_RESULT, &end);
+		if (pair == 0)
+		{
+			frameBase = begin;
+		}
+		if (end < begin)
+		{
+			continue;
+		}
+
+		ZONE_HANDLE zone = frame.zones[pair];
+		frameMs[zone] += (end - begin) / 1000000.0;
+		bEntered[zone] = true;
+
+		// the GPU clock is not the CPU clock, so the GPU events
+		// are placed relative to the start of their frame
+		if (bTrace == true)
+		{
+			TRACE_EVENT event;
+			event.zone = zone;
+			event.bGpu = true;
+			event.startUs = frame.cpuFrameStartUs + (double)(begin - frameBase) / 1000.0;
+			event.durationUs = (end - begin) / 1000.0;
+			m_traceFrames[traceSlot].push_back(event);
+		}
+	}
+
+	for (int i = 0; i < m_zones.size(); i++)
+	{
+		if (bEntered[i] == true)
+		{
+			AddSample(m_zones[i].gpuHistory, m_zones[i].gpuHistoryNext, (float)frameMs[i]);
+		}
+	}
+}
+
+/***********************************************************
+ *  AddSample()
+ *
+ *  This method is used for adding a time to a history ring,
+ *  replacing the oldest time once the ring is full.
+ ***********************************************************/
+void FrameProfiler::AddSample(std::vector<float>& history, int& next, float sample)
+{
+	if (history.size() < HISTORY_FRAMES)
+	{
+		history.push_back(sample);
+		return;
+	}
+
+	history[next] = sample;
+	next = (next + 1) % HISTORY_FRAMES;
+}
+
+/***********************************************************
+ *  CalculateStats()
+ *
+ *  This method is used for calculating the minimum, average
+ *  and 99th percentile of the times in a history ring.
+ ***********************************************************/
+void FrameProfiler::CalculateStats(const std::vector<float>& history, ZONE_STATS& stats)
+{
+	stats.minMs = 0.0f;
+	stats.averageMs = 0.0f;
+	stats.p99Ms = 0.0f;
+	stats.sampleCount = (int)history.size();
+	if (history.size() == 0)
+	{
+		return;
+	}
+
+	std::vector<float> sorted(history);
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+	for (float sample : sorted)
+	{
+		total += sample;
+	}
+
+	int p99Index = ((int)sorted.size() * 99 + 99) / 100 - 1;
+	stats.minMs = sorted.front();
+	stats.averageMs = (float)(total / sorted.size());
+	stats.p99Ms = sorted[std::min(std::max(p99Index, 0), (int)sorted.size() - 1)];
+}
+
+/***********************************************************
+ *  GetZoneStats()
+ *
+ *  This method is used for getting the CPU and GPU statistics
+ *  of the passed in zone over the kept frames.
+ ***********************************************************/
+void FrameProfiler::GetZoneStats(ZONE_HANDLE zone, ZONE_STATS& cpuStats, ZONE_STATS& gpuStats) const
+{
+	static const std::vector<float> noSamples;
+
+	bool bValid = ((zone >= 0) && (zone < m_zones.size()));
+	CalculateStats(bValid ? m_zones[zone].cpuHistory : noSamples, cpuStats);
+	CalculateStats(bValid ? m_zones[zone].gpuHistory : noSamples, gpuStats);
+}
+
+/***********************************************************
+ *  DrawOverlay()
+ *
+ *  This method is used for drawing the average CPU and GPU
+ *  time of every zone as a pair of bars in the top left of
+ *  the frame, with a white mark at one 60 Hz frame.  The bars
+ *  are cleared rectangles, so no shader state is touched.
+ ***********************************************************/
+void FrameProfiler::DrawOverlay(int framebufferWidth, int framebufferHeight)
+{
+	if ((m_bOverlayVisible == false) || (framebufferWidth <= 0) || (framebufferHeight <= 0))
+	{
+		return;
+	}
+
+	float pixelsPerMs = (framebufferWidth * 0.5f) / g_OverlayFrameMs;
+	int zoneHeight = g_OverlayBarHeight * 2 + g_OverlayZoneGap;
+	int top = framebufferHeight - g_OverlayMargin;
+
+	glEnable(GL_SCISSOR_TEST);
+	for (int i = 0; i < m_zones.size(); i++)
+	{
+		ZONE_STATS cpuStats;
+		ZONE_STATS gpuStats;
+		GetZoneStats(i, cpuStats, gpuStats);
+
+		const float* pColor = g_OverlayColors[i % g_OverlayColorCount];
+		int y = top - (i + 1) * zoneHeight;
+		int cpuWidth = std::min((int)(cpuStats.averageMs * pixelsPerMs), framebufferWidth - g_OverlayMargin * 2);
+		int gpuWidth = std::min((int)(gpuStats.averageMs * pixelsPerMs), framebufferWidth - g_OverlayMargin * 2);
+
+		// the CPU bar is drawn above the darker GPU bar
+		if (cpuWidth > 0)
+		{
+			glScissor(g_OverlayMargin, y + g_OverlayBarHeight, cpuWidth, g_OverlayBarHeight);
+			glClearColor(pColor[0], pColor[1], pColor[2], 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
+		if (gpuWidth > 0)
+		{
+			glScissor(g_OverlayMargin, y, gpuWidth, g_OverlayBarHeight);
+			glClearColor(pColor[0] * 0.5f, pColor[1] * 0.5f, pColor[2] * 0.5f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
+	}
+
+	int barsHeight = (int)m_zones.size() * zoneHeight;
+	glScissor(g_OverlayMargin + (int)(g_OverlayFrameMs * pixelsPerMs), top - barsHeight, 1, barsHeight);
+	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glDisable(GL_SCISSOR_TEST);
+}
+
+/***********************************************************
+ *  PrintStats()
+ *
+ *  This method is used for printing the statistics of every
+ *  zone to the console, in the order of the overlay bars.
+ ***********************************************************/
+void FrameProfiler::PrintStats() const
+{
+	char line[256];
+
+	std::cout << "\n*** PROFILER (ms over the last " << HISTORY_FRAMES << " frames) ***\n";
+	snprintf(line, sizeof(line), "%-20s %8s %8s %8s %8s %8s %8s\n",
+		"zone", "cpu min", "cpu avg", "cpu p99", "gpu min", "gpu avg", "gpu p99");
+	std::cout << line;
+	for (int i = 0; i < m_zones.size(); i++)
+	{
+		ZONE_STATS cpuStats;
+		ZONE_STATS gpuStats;
+		GetZoneStats(i, cpuStats, gpuStats);
+		snprintf(line, sizeof(line), "%-20s %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n",
+			m_zones[i].name.c_str(),
+			cpuStats.minMs, cpuStats.averageMs, cpuStats.p99Ms,
+			gpuStats.minMs, gpuStats.averageMs, gpuStats.p99Ms);
+		std::cout << line;
+	}
+	if (m_droppedGpuFrames > 0)
+	{
+		std::cout << "GPU frames dropped while still in flight: " << m_droppedGpuFrames << "\n";
+	}
+	std::cout << std::flush;
+}
+
+/***********************************************************
+ *  WriteCSV()
+ *
+ *  This method is used for writing the statistics of every
+ *  zone into the passed in file as comma separated values.
+ ***********************************************************/
+bool FrameProfiler::WriteCSV(const char* filename) const
+{
+	std::ofstream file(filename);
+	if (!file)
+	{
+		std::cout << "Could not write profiler file:" << filename << std::endl;
+		return(false);
+	}
+
+	file << "zone,cpu_min_ms,cpu_avg_ms,cpu_p99_ms,cpu_samples,gpu_min_ms,gpu_avg_ms,gpu_p99_ms,gpu_samples\n";
+	for (int i = 0; i < m_zones.size(); i++)
+	{
+		ZONE_STATS cpuStats;
+		ZONE_STATS gpuStats;
+		GetZoneStats(i, cpuStats, gpuStats);
+		file << m_zones[i].name << ","
+			<< cpuStats.minMs << "," << cpuStats.averageMs << "," << cpuStats.p99Ms << "," << cpuStats.sampleCount << ","
+			<< gpuStats.minMs << "," << gpuStats.averageMs << "," << gpuStats.p99Ms << "," << gpuStats.sampleCount << "\n";
+	}
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  WriteChromeTrace()
+ *
+ *  This method is used for writing every zone pass of the
+ *  kept frames into the passed in file in the Chrome trace
+ *  event format, which chrome://tracing and Perfetto open.
+ *  The CPU passes are on thread 1 and the GPU passes on
+ *  thread 2.
+ ***********************************************************/
+bool FrameProfiler::WriteChromeTrace(const char* filename) const
+{
+	std::ofstream file(filename);
+	if (!file)
+	{
+		std::cout << "Could not write profiler file:" << filename << std::endl;
+		return(false);
+	}
+
+	file << "{\"traceEvents\":[\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+	char line[256];
+	// write the frames from the oldest to the newest
+	for (int i = 1; i <= HISTORY_FRAMES; i++)
+	{
+		int slot = (m_frameNumber + i) % HISTORY_FRAMES;
+		for (const TRACE_EVENT& event : m_traceFrames[slot])
+		{
+			snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				m_zones[event.zone].name.c_str(), event.bGpu ? 2 : 1, event.startUs, event.durationUs);
+			file << line;
+		}
+	}
+	file << "\n]}\n";
+
+	return(file.good());
+}
@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.h
+// ============
+// measure the CPU and GPU time of named zones in every frame
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  FrameProfiler
+ *
+ *  This class measures how long named zones of the frame
+ *  take on the CPU, and on the GPU with timestamp queries.
+ *  The queries of a frame are read two frames later and are
+ *  dropped when they are not ready yet, so the profiler never
+ *  waits for the GPU.  The last frames of every zone are kept
+ *  for rolling statistics, an on-screen bar overlay, and CSV
+ *  and Chrome trace files.  A zone can be entered several
+ *  times in a frame, and its times are added up.
+ ***********************************************************/
+class FrameProfiler
+{
+public:
+	// constructor
+	FrameProfiler();
+	// destructor
+	~FrameProfiler();
+
+	typedef int ZONE_HANDLE;
+	static const int INVALID_ZONE = -1;
+
+	// number of frames the statistics are calculated over
+	static const int HISTORY_FRAMES = 300;
+
+	// statistics of one zone over the kept frames, in milliseconds
+	struct ZONE_STATS
+	{
+		float minMs;
+		float averageMs;
+		float p99Ms;
+		int sampleCount;
+	};
+
+	// register a named zone, or find the one with the same name
+	ZONE_HANDLE RegisterZone(const char* name);
+
+	// mark the start and end of the frame
+	void BeginFrame();
+	void EndFrame();
+
+	// mark the start and end of one pass through a zone
+	void BeginZone(ZONE_HANDLE zone);
+	void EndZone(ZONE_HANDLE zone);
+
+	// get the CPU and GPU statistics of the passed in zone
+	void GetZoneStats(ZONE_HANDLE zone, ZONE_STATS& cpuStats, ZONE_STATS& gpuStats) const;
+	int GetZoneCount() const { return((int)m_zones.size()); }
+	const std::string& GetZoneName(ZONE_HANDLE zone) const { return(m_zones[zone].name); }
+
+	// show or hide the overlay
+	void SetOverlayVisible(bool bVisible) { m_bOverlayVisible = bVisible; }
+	bool IsOverlayVisible() const { return(m_bOverlayVisible); }
+	// draw average zone times as bars over the frame
+	void DrawOverlay(int framebufferWidth, int framebufferHeight);
+
+	// print the zone statistics to the console
+	void PrintStats() const;
+	// write the zone statistics as comma separated values
+	bool WriteCSV(const char* filename) const;
+	// write the kept frames as a Chrome trace event file
+	bool WriteChromeTrace(const char* filename) const;
+
+private:
+	// one pass through a zone for the trace file, in
+	// microseconds since the profiler was created
+	struct TRACE_EVENT
+	{
+		ZONE_HANDLE zone;
+		bool bGpu;
+		double startUs;
+		double durationUs;
+	};
+
+	struct ZONE_INFO
+	{
+		std::string name;
+		// time spent in the zone in the current frame
+		double cpuFrameMs;
+		bool bEnteredThisFrame;
+		double cpuStartUs;
+		// query pair of the pass that is open on the GPU
+		int openQueryPair;
+		// times of the last frames, oldest first once full
+		std::vector<float> cpuHistory;
+		std::vector<float> gpuHistory;
+		int cpuHistoryNext;
+		int gpuHistoryNext;
+	};
+
+	// timestamp queries issued during one frame
+	struct FRAME_QUERIES
+	{
+		// two queries per zone pass, begin and end
+		std::vector<GLuint> queries;
+		std::vector<ZONE_HANDLE> zones;
+		int usedPairs;
+		// index of the timestamp query issued last in the frame,
+		// which finishes after all the others, or -1
+		int lastQuery;
+		unsigned int frameNumber;
+		double cpuFrameStartUs;
+	};
+
+	// number of frames whose queries can be in flight
+	static const int QUERY_FRAMES = 2;
+
+	std::vector<ZONE_INFO> m_zones;
+	FRAME_QUERIES m_frameQueries[QUERY_FRAMES];
+	// trace events of the last frames, by frame number
+	std::vector<TRACE_EVENT> m_traceFrames[HISTORY_FRAMES];
+	unsigned int m_traceFrameNumbers[HISTORY_FRAMES];
+
+	std::chrono::steady_clock::time_point m_startTime;
+	unsigned int m_frameNumber;
+	double m_frameStartUs;
+	bool m_bInFrame;
+	// true when the driver supports timestamp queries
+	bool m_bGpuTiming;
+	bool m_bGpuTimingChecked;
+	// number of frames whose GPU times were not ready in time
+	int m_droppedGpuFrames;
+	bool m_bOverlayVisible;
+
+	// microseconds since the profiler was created
+	double GetTimeUs() const;
+	// read the queries of an older frame into the histories
+	void ResolveQueries(FRAME_QUERIES& frame);
+	// add a time to a history ring
+	static void AddSample(std::vector<float>& history, int& next, float sample);
+	// calculate the statistics of a history ring
+	static void CalculateStats(const std::vector<float>& history, ZONE_STATS& stats);
+};
+
+/***********************************************************
+ *  ProfileZone
+ *
+ *  This class enters a profiler zone when it is constructed
+ *  and leaves it when it goes out of scope.  A NULL profiler
+ *  is allowed and does nothing.
+ ***********************************************************/
+class ProfileZone
+{
+public:
+	ProfileZone(FrameProfiler* pProfiler, FrameProfiler::ZONE_HANDLE zone)
+	{
+		m_pProfiler = pProfiler;
+		m_zone = zone;
+		if (NULL != m_pProfiler)
+		{
+			m_pProfiler->BeginZone(m_zone);
+		}
+	}
+	~ProfileZone()
+	{
+		if (NULL != m_pProfiler)
+		{
+			m_pProfiler->EndZone(m_zone);
+		}
+	}
+
+private:
+	FrameProfiler* m_pProfiler;
+	FrameProfiler::ZONE_HANDLE m_zone;
+
+	ProfileZone(const ProfileZone&);
+	ProfileZone& operator=(const ProfileZone&);
+};
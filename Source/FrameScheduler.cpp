@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+// framescheduler.cpp
+// ============
+// pace the frames and step the simulation at a fixed rate
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameScheduler.h"
+
+#include "GLFW/glfw3.h"
+
+#include <algorithm>
+#include <thread>
+
+// declaration of the global variables and defines
+namespace
+{
+	// rate the camera is updated at, whatever the frame rate
+	const double g_FixedStepSeconds = 1.0 / 120.0;
+	// most time handed out as steps in one frame, so a long
+	// stall does not make the camera jump
+	const double g_MaxStepTimeSeconds = 0.1;
+	// time between two checks for changes in idle mode while
+	// awake
+	const double g_IdleFrameSeconds = 1.0 / 60.0;
+	// longest wait for an event, so the watched files are still
+	// checked at their poll interval
+	const double g_EventTimeoutSeconds = 0.25;
+	// last part of a wait that is spun instead of slept
+	const double g_SpinSeconds = 0.002;
+}
+
+/***********************************************************
+ *  FrameScheduler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameScheduler::FrameScheduler()
+{
+	m_swapInterval = 1;
+	m_frameRateCap = 0.0;
+	m_bIdleSkipping = false;
+	// the first frame is always rendered
+	m_bInvalidated = true;
+	m_bRendering = false;
+	m_bStayAwake = false;
+	m_frameStartTime = std::chrono::steady_clock::now();
+	m_stepAccumulator = 0.0;
+	m_renderedFrames = 0;
+	m_skippedFrames = 0;
+}
+
+/***********************************************************
+ *  SetSwapInterval()
+ *
+ *  This method is used for setting the swap interval of the
+ *  current OpenGL context.
+ ***********************************************************/
+void FrameScheduler::SetSwapInterval(int interval)
+{
+	m_swapInterval = std::max(interval, 0);
+	glfwSwapInterval(m_swapInterval);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a frame.  The time since
+ *  the last frame is added to the time not yet stepped, and
+ *  the whole steps in it are handed out.
+ ***********************************************************/
+int FrameScheduler::BeginFrame()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double elapsed = std::chrono::duration<double>(now - m_frameStartTime).count();
+	m_frameStartTime = now;
+	m_bRendering = false;
+	m_bStayAwake = false;
+
+	m_stepAccumulator = std::min(m_stepAccumulator + elapsed, g_MaxStepTimeSeconds);
+	int steps = (int)(m_stepAccumulator / g_FixedStepSeconds);
+	m_stepAccumulator -= steps * g_FixedStepSeconds;
+
+	return(steps);
+}
+
+/***********************************************************
+ *  GetFixedStep()
+ *
+ *  This method is used for getting the length of one fixed
+ *  time step in seconds.
+ ***********************************************************/
+double FrameScheduler::GetFixedStep() const
+{
+	return(g_FixedStepSeconds);
+}
+
+/***********************************************************
+ *  ShouldRender()
+ *
+ *  This method is used for deciding whether the current
+ *  frame is rendered.  Outside of idle mode every frame is.
+ ***********************************************************/
+bool FrameScheduler::ShouldRender(bool bChanged)
+{
+	m_bRendering = (m_bIdleSkipping == false) || (bChanged == true) || (m_bInvalidated == true);
+	m_bInvalidated = false;
+
+	if (m_bRendering == true)
+	{
+		m_renderedFrames++;
+	}
+	else
+	{
+		m_skippedFrames++;
+	}
+
+	return(m_bRendering);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for waiting until the next frame may
+ *  start - until the frame time of the cap has passed, or
+ *  the idle frame time when nothing was rendered.  A skipped
+ *  frame that may sleep waits for the next event instead,
+ *  and the time spent waiting is not stepped, since nothing
+ *  moved while the loop was asleep.
+ ***********************************************************/
+void FrameScheduler::EndFrame()
+{
+	if ((m_bRendering == false) && (m_bStayAwake == false))
+	{
+		glfwWaitEventsTimeout(g_EventTimeoutSeconds);
+		m_frameStartTime = std::chrono::steady_clock::now();
+		return;
+	}
+
+	double frameSeconds = 0.0;
+	if (m_frameRateCap > 0.0)
+	{
+		frameSeconds = 1.0 / m_frameRateCap;
+	}
+	if (m_bRendering == false)
+	{
+		frameSeconds = std::max(frameSeconds, g_IdleFrameSeconds);
+	}
+
+	if (frameSeconds > 0.0)
+	{
+		WaitUntil(m_frameStartTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(frameSeconds)));
+	}
+}
+
+/***********************************************************
+ *  WaitUntil()
+ *
+ *  This method is used for waiting until the passed in time.
+ *  The thread sleeps until shortly before it, and yields for
+ *  the rest, so the wait neither ends late nor keeps a core
+ *  busy for long.
+ ***********************************************************/
+void FrameScheduler::WaitUntil(std::chrono::steady_clock::time_point time)
+{
+	while (true)
+	{
+		double remaining = std::chrono::duration<double>(time - std::chrono::steady_clock::now()).count();
+		if (remaining <= 0.0)
+		{
+			break;
+		}
+
+		if (remaining > g_SpinSeconds)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>(remaining - g_SpinSeconds));
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// framescheduler.h
+// ============
+// pace the frames and step the simulation at a fixed rate
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+
+/***********************************************************
+ *  FrameScheduler
+ *
+ *  This class paces the main loop.  The time that passes is
+ *  handed out as a whole number of fixed time steps, so the
+ *  camera moves the same way at any frame rate.  Frames can
+ *  be capped to a rate, waiting with a sleep for most of the
+ *  remaining time and spinning for the last part, since a
+ *  sleep can wake up late.  In idle mode a frame is only
+ *  rendered when something changed, and a skipped frame
+ *  waits for the next window event instead of swapping, so
+ *  an unchanged scene costs next to nothing.  A skipped
+ *  frame waits a short time only while something that sends
+ *  no events, like a held key, can still change the frame.
+ ***********************************************************/
+class FrameScheduler
+{
+public:
+	// constructor
+	FrameScheduler();
+
+	// set the number of display refreshes to wait for between
+	// two swaps, 0 for none
+	void SetSwapInterval(int interval);
+	int GetSwapInterval() const { return(m_swapInterval); }
+	// set the most frames rendered per second, 0 for no cap
+	void SetFrameRateCap(double framesPerSecond) { m_frameRateCap = framesPerSecond; }
+	// only render a frame when something changed
+	void SetIdleSkipping(bool bEnabled) { m_bIdleSkipping = bEnabled; }
+
+	// start a frame and get the number of fixed time steps that
+	// passed since the last one
+	int BeginFrame();
+	// length of one fixed time step in seconds
+	double GetFixedStep() const;
+
+	// render the next frame even when nothing has changed
+	void Invalidate() { m_bInvalidated = true; }
+	// do not wait for events at the end of this frame, since the
+	// frame can change without any
+	void StayAwake() { m_bStayAwake = true; }
+	// decide whether the frame is rendered, passing whether
+	// anything changed since the last rendered frame
+	bool ShouldRender(bool bChanged);
+
+	// wait until the next frame may start, or for the next
+	// event after a skipped frame
+	void EndFrame();
+
+	// get the number of frames rendered and skipped
+	int GetRenderedFrameCount() const { return(m_renderedFrames); }
+	int GetSkippedFrameCount() const { return(m_skippedFrames); }
+
+private:
+	int m_swapInterval;
+	double m_frameRateCap;
+	bool m_bIdleSkipping;
+	bool m_bInvalidated;
+	// true when the current frame is rendered, and when it
+	// must not wait for events
+	bool m_bRendering;
+	bool m_bStayAwake;
+
+	// start of the last frame and the time not yet handed out
+	// as fixed steps
+	std::chrono::steady_clock::time_point m_frameStartTime;
+	double m_stepAccumulator;
+
+	int m_renderedFrames;
+	int m_skippedFrames;
+
+	// wait until the passed in time, sleeping for most of it
+	static void WaitUntil(std::chrono::steady_clock::time_point time);
+};
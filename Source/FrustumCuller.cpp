@@ -0,0 +1,220 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.cpp
+// ============
+// test world-space bounding spheres against the view frustum
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrustumCuller.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  FrustumCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrustumCuller::FrustumCuller()
+{
+	// until a frustum is set every plane accepts everything
+	for (int i = 0; i < 6; i++)
+	{
+		m_planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	m_depthRow = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for setting the number of bounding
+ *  spheres.  New spheres start as a point at the origin.
+ ***********************************************************/
+void FrustumCuller::Resize(int count)
+{
+	m_centerX.resize(count, 0.0f);
+	m_centerY.resize(count, 0.0f);
+	m_centerZ.resize(count, 0.0f);
+	m_radius.resize(count, 0.0f);
+}
+
+/***********************************************************
+ *  SetBounds()
+ *
+ *  This method is used for setting the world-space bounding
+ *  sphere at the passed in index.
+ ***********************************************************/
+void FrustumCuller::SetBounds(int index, const glm::vec3& center, float radius)
+{
+	if ((index < 0) || (index >= (int)m_radius.size()))
+	{
+		return;
+	}
+
+	m_centerX[index] = center.x;
+	m_centerY[index] = center.y;
+	m_centerZ[index] = center.z;
+	m_radius[index] = radius;
+}
+
+/***********************************************************
+ *  SetFrustum()
+ *
+ *  This method is used for extracting the left, right,
+ *  bottom, top, near and far planes from the rows of the
+ *  passed in view and projection matrix, which works for
+ *  both perspective and orthographic projections.
+ ***********************************************************/
+void FrustumCuller::SetFrustum(const glm::mat4& viewProjection)
+{
+	// glm matrices are stored by column, so build the rows
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	}
+
+	m_planes[0] = rows[3] + rows[0];
+	m_planes[1] = rows[3] - rows[0];
+	m_planes[2] = rows[3] + rows[1];
+	m_planes[3] = rows[3] - rows[1];
+	m_planes[4] = rows[3] + rows[2];
+	m_planes[5] = rows[3] - rows[2];
+	m_depthRow = rows[3];
+
+	for (int i = 0; i < 6; i++)
+	{
+		float length = glm::length(glm::vec3(m_planes[i]));
+		if (length > 0.0f)
+		{
+			m_planes[i] /= length;
+		}
+	}
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for testing every bounding sphere
+ *  against the six frustum planes.
+ ***********************************************************/
+int FrustumCuller::Cull(std::vector<unsigned char>& visible) const
+{
+	visible.resize(m_radius.size());
+
+	return(Cull(0, (int)m_radius.size(), visible.data()));
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for testing the bounding spheres in
+ *  the passed in range against the six frustum planes.  Each
+ *  plane is applied to all the spheres in one branch-free
+ *  loop over the separate arrays, so the compiler can run it
+ *  on several spheres at a time.  Separate ranges can be
+ *  culled on separate threads.
+ ***********************************************************/
+int FrustumCuller::Cull(int first, int end, unsigned char* pVisible) const
+{
+	if (first >= end)
+	{
+		return(0);
+	}
+
+	const float* pCenterX = m_centerX.data();
+	const float* pCenterY = m_centerY.data();
+	const float* pCenterZ = m_centerZ.data();
+	const float* pRadius = m_radius.data();
+
+	for (int i = first; i < end; i++)
+	{
+		pVisible[i] = 1;
+	}
+
+	for (int plane = 0; plane < 6; plane++)
+	{
+		float a = m_planes[plane].x;
+		float b = m_planes[plane].y;
+		float c = m_planes[plane].z;
+		float d = m_planes[plane].w;
+
+		for (int i = first; i < end; i++)
+		{
+			float distance = a * pCenterX[i] + b * pCenterY[i] + c * pCenterZ[i] + d;
+			pVisible[i] &= (unsigned char)(distance >= -pRadius[i]);
+		}
+	}
+
+	int visibleCount = 0;
+	for (int i = first; i < end; i++)
+	{
+		visibleCount += pVisible[i];
+	}
+
+	return(visibleCount);
+}
+
+/***********************************************************
+ *  GetProjectedRadii()
+ *
+ *  This method is used for estimating how large every
+ *  bounding sphere appears on the screen.
+ ***********************************************************/
+void FrustumCuller::GetProjectedRadii(float pixelScale, std::vector<float>& radii) const
+{
+	radii.resize(m_radius.size());
+
+	GetProjectedRadii(0, (int)m_radius.size(), pixelScale, radii.data());
+}
+
+/***********************************************************
+ *  GetProjectedRadii()
+ *
+ *  This method is used for estimating how large the bounding
+ *  spheres in the passed in range appear on the screen.  The
+ *  clip space w of the center is the view depth for a
+ *  perspective projection and 1 for an orthographic one, so
+ *  dividing by it covers both.
+ ***********************************************************/
+void FrustumCuller::GetProjectedRadii(int first, int end, float pixelScale, float* pRadii) const
+{
+	const float* pCenterX = m_centerX.data();
+	const float* pCenterY = m_centerY.data();
+	const float* pCenterZ = m_centerZ.data();
+	const float* pRadius = m_radius.data();
+	float a = m_depthRow.x;
+	float b = m_depthRow.y;
+	float c = m_depthRow.z;
+	float d = m_depthRow.w;
+
+	for (int i = first; i < end; i++)
+	{
+		// spheres around the eye count as filling the screen
+		float w = std::max(a * pCenterX[i] + b * pCenterY[i] + c * pCenterZ[i] + d, 0.0001f);
+		pRadii[i] = pRadius[i] * pixelScale / w;
+	}
+}
+
+/***********************************************************
+ *  TransformSphere()
+ *
+ *  This method is used for moving a local bounding sphere
+ *  into world space.  The radius grows with the largest
+ *  scale of the model matrix, so the sphere still encloses
+ *  the object when it is scaled unevenly.
+ ***********************************************************/
+void FrustumCuller::TransformSphere(
+	const glm::mat4& modelMatrix,
+	const glm::vec3& localCenter,
+	float localRadius,
+	glm::vec3& center,
+	float& radius)
+{
+	center = glm::vec3(modelMatrix * glm::vec4(localCenter, 1.0f));
+
+	float scaleX = glm::length(glm::vec3(modelMatrix[0]));
+	float scaleY = glm::length(glm::vec3(modelMatrix[1]));
+	float scaleZ = glm::length(glm::vec3(modelMatrix[2]));
+	radius = localRadius * std::max(scaleX, std::max(scaleY, scaleZ));
+}
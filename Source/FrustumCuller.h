@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.h
+// ============
+// test world-space bounding spheres against the view frustum
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  FrustumCuller
+ *
+ *  This class keeps one world-space bounding sphere per
+ *  object, stored as separate arrays of center coordinates
+ *  and radii so that the culling loop runs over contiguous
+ *  floats and can be vectorized by the compiler.  The six
+ *  frustum planes are extracted from the combined view and
+ *  projection matrix.
+ ***********************************************************/
+class FrustumCuller
+{
+public:
+	// constructor
+	FrustumCuller();
+
+	// set the number of bounding spheres
+	void Resize(int count);
+	// set the bounding sphere at the passed in index
+	void SetBounds(int index, const glm::vec3& center, float radius);
+
+	// extract the frustum planes from the passed in matrix
+	void SetFrustum(const glm::mat4& viewProjection);
+	// set a flag per bounding sphere that is non-zero when the
+	// sphere touches the frustum, and return the visible count
+	int Cull(std::vector<unsigned char>& visible) const;
+	// cull only the spheres from first up to end, into the flags
+	// at the same indices, and return their visible count
+	int Cull(int first, int end, unsigned char* pVisible) const;
+	// get the radius of every bounding sphere on the screen,
+	// where pixelScale is the size of one unit at distance 1
+	void GetProjectedRadii(float pixelScale, std::vector<float>& radii) const;
+	// get the radii of the spheres from first up to end only
+	void GetProjectedRadii(int first, int end, float pixelScale, float* pRadii) const;
+
+	// get the world-space bounding sphere of a local sphere
+	// transformed by the passed in model matrix
+	static void TransformSphere(
+		const glm::mat4& modelMatrix,
+		const glm::vec3& localCenter,
+		float localRadius,
+		glm::vec3& center,
+		float& radius);
+
+	int GetCount() const { return((int)m_radius.size()); }
+
+private:
+	// bounding spheres as separate arrays
+	std::vector<float> m_centerX;
+	std::vector<float> m_centerY;
+	std::vector<float> m_centerZ;
+	std::vector<float> m_radius;
+
+	// normalized frustum planes - xyz is the inward normal
+	// and w the distance from the origin
+	glm::vec4 m_planes[6];
+	// last row of the view and projection matrix, giving the
+	// clip space w of a point
+	glm::vec4 m_depthRow;
+};
@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpumemorytracker.cpp
+// ============
+// account for the GPU memory of the scene resources against budgets
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuMemoryTracker.h"
+
+#include <iomanip>
+
+// declaration of the global variables and defines
+namespace
+{
+	// names of the categories in the reports, in category order
+	const char* g_CategoryNames[GpuMemoryTracker::MEMORY_CATEGORY_COUNT] =
+	{
+		"textures",
+		"mip_chains",
+		"vertex_buffers",
+		"index_buffers",
+		"stream_buffers"
+	};
+
+	const double g_BytesPerMegabyte = 1024.0 * 1024.0;
+}
+
+/***********************************************************
+ *  GpuMemoryTracker()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GpuMemoryTracker::GpuMemoryTracker()
+{
+	for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++)
+	{
+		m_bytes[i] = 0;
+		m_peakBytes[i] = 0;
+		m_budgets[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for counting the passed in bytes as
+ *  allocated in the passed in category.
+ ***********************************************************/
+void GpuMemoryTracker::Allocate(MEMORY_CATEGORY category, size_t bytes)
+{
+	m_bytes[category] += bytes;
+	if (m_bytes[category] > m_peakBytes[category])
+	{
+		m_peakBytes[category] = m_bytes[category];
+	}
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for counting the passed in bytes of
+ *  the passed in category as freed.
+ ***********************************************************/
+void GpuMemoryTracker::Release(MEMORY_CATEGORY category, size_t bytes)
+{
+	m_bytes[category] -= (bytes < m_bytes[category]) ? bytes : m_bytes[category];
+}
+
+/***********************************************************
+ *  GetTotalBytes()
+ *
+ *  This method is used for getting the bytes allocated in
+ *  all the categories together.
+ ***********************************************************/
+size_t GpuMemoryTracker::GetTotalBytes() const
+{
+	size_t totalBytes = 0;
+	for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++)
+	{
+		totalBytes += m_bytes[i];
+	}
+	return(totalBytes);
+}
+
+/***********************************************************
+ *  IsOverBudget()
+ *
+ *  This method is used for checking whether the passed in
+ *  category holds more bytes than its budget.  A category
+ *  without a budget is never over it.
+ ***********************************************************/
+bool GpuMemoryTracker::IsOverBudget(MEMORY_CATEGORY category) const
+{
+	return((m_budgets[category] > 0) && (m_bytes[category] > m_budgets[category]));
+}
+
+/***********************************************************
+ *  GetCategoryName()
+ *
+ *  This method is used for getting the name of the passed in
+ *  category as it is written in the reports.
+ ***********************************************************/
+const char* GpuMemoryTracker::GetCategoryName(MEMORY_CATEGORY category)
+{
+	return(g_CategoryNames[category]);
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method is used for writing one line per category
+ *  with its size, peak and budget in megabytes.
+ ***********************************************************/
+void GpuMemoryTracker::WriteReport(std::ostream& output) const
+{
+	std::ios::fmtflags flags = output.flags();
+	std::streamsize precision = output.precision();
+
+	output << std::fixed << std::setprecision(2);
+	for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++)
+	{
+		output << "  " << std::left << std::setw(16) << g_CategoryNames[i] << std::right
+			<< std::setw(10) << m_bytes[i] / g_BytesPerMegabyte << " MB, peak "
+			<< std::setw(10) << m_peakBytes[i] / g_BytesPerMegabyte << " MB";
+		if (m_budgets[i] > 0)
+		{
+			output << ", budget " << m_budgets[i] / g_BytesPerMegabyte << " MB";
+			if (IsOverBudget((MEMORY_CATEGORY)i) == true)
+			{
+				output << " (over)";
+			}
+		}
+		output << std::endl;
+	}
+	output << "  " << std::left << std::setw(16) << "total" << std::right
+		<< std::setw(10) << GetTotalBytes() / g_BytesPerMegabyte << " MB" << std::endl;
+
+	output.flags(flags);
+	output.precision(precision);
+}
+
+/***********************************************************
+ *  WriteJson()
+ *
+ *  This method is used for writing the bytes, peak bytes and
+ *  budget of every category as the members of a JSON object,
+ *  without the braces around them.
+ ***********************************************************/
+void GpuMemoryTracker::WriteJson(std::ostream& output) const
+{
+	for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++)
+	{
+		output << "\"" << g_CategoryNames[i] << "\": { \"bytes\": " << m_bytes[i]
+			<< ", \"peak_bytes\": " << m_peakBytes[i]
+			<< ", \"budget_bytes\": " << m_budgets[i] << " }, ";
+	}
+	output << "\"total_bytes\": " << GetTotalBytes();
+}
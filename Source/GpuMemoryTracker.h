@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpumemorytracker.h
+// ============
+// account for the GPU memory of the scene resources against budgets
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+/***********************************************************
+ *  GpuMemoryTracker
+ *
+ *  This class counts the bytes of GPU memory allocated by
+ *  the classes owning the OpenGL objects of the scene, by
+ *  category.  Each owner adds the size of an object when it
+ *  allocates its storage and removes it when it frees it, so
+ *  the counts always match the live objects.  A category can
+ *  be given a budget, which the owners check to decide when
+ *  to free resources that are no longer used.  The counts
+ *  are estimates from the sizes and formats of the objects,
+ *  since OpenGL does not report what the driver allocates.
+ ***********************************************************/
+class GpuMemoryTracker
+{
+public:
+	// constructor
+	GpuMemoryTracker();
+
+	// kinds of GPU memory that are counted separately
+	enum MEMORY_CATEGORY
+	{
+		MEMORY_TEXTURES = 0,
+		MEMORY_MIP_CHAINS,
+		MEMORY_VERTEX_BUFFERS,
+		MEMORY_INDEX_BUFFERS,
+		MEMORY_STREAM_BUFFERS,
+		MEMORY_CATEGORY_COUNT
+	};
+
+	// count an allocation or a release of the passed in bytes
+	void Allocate(MEMORY_CATEGORY category, size_t bytes);
+	void Release(MEMORY_CATEGORY category, size_t bytes);
+
+	// get the bytes allocated in a category now, and the most
+	// that were allocated at once
+	size_t GetBytes(MEMORY_CATEGORY category) const { return(m_bytes[category]); }
+	size_t GetPeakBytes(MEMORY_CATEGORY category) const { return(m_peakBytes[category]); }
+	size_t GetTotalBytes() const;
+
+	// set the most bytes a category should hold, or 0 for no
+	// budget, and check whether it holds more than that
+	void SetBudget(MEMORY_CATEGORY category, size_t bytes) { m_budgets[category] = bytes; }
+	size_t GetBudget(MEMORY_CATEGORY category) const { return(m_budgets[category]); }
+	bool IsOverBudget(MEMORY_CATEGORY category) const;
+
+	// get the name of a category for the reports
+	static const char* GetCategoryName(MEMORY_CATEGORY category);
+	// write the bytes and budget of every category as text, or
+	// as the members of a JSON object
+	void WriteReport(std::ostream& output) const;
+	void WriteJson(std::ostream& output) const;
+
+private:
+	// bytes allocated now, most bytes allocated at once and the
+	// budget of every category
+	size_t m_bytes[MEMORY_CATEGORY_COUNT];
+	size_t m_peakBytes[MEMORY_CATEGORY_COUNT];
+	size_t m_budgets[MEMORY_CATEGORY_COUNT];
+};
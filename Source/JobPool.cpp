@@ -0,0 +1,198 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobpool.cpp
+// ============
+// run independent jobs on a pool of worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobPool.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  JobPool()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JobPool::JobPool(int threadCount)
+{
+	m_runningJobs = 0;
+	m_bStopping = false;
+
+	if (threadCount <= 0)
+	{
+		// leave one hardware thread for the main thread
+		threadCount = (int)std::thread::hardware_concurrency() - 1;
+		if (threadCount < 1)
+		{
+			threadCount = 1;
+		}
+	}
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		m_threads.push_back(std::thread(&JobPool::WorkerLoop, this));
+	}
+}
+
+/***********************************************************
+ *  ~JobPool()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JobPool::~JobPool()
+{
+	WaitIdle();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_jobAvailable.notify_all();
+
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+	m_threads.clear();
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queuing the passed in job to run
+ *  on the next free worker thread.
+ ***********************************************************/
+void JobPool::Submit(const std::function<void()>& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(job);
+	}
+	m_jobAvailable.notify_one();
+}
+
+/***********************************************************
+ *  WaitIdle()
+ *
+ *  This method is used for blocking the calling thread until
+ *  every submitted job has finished running.
+ ***********************************************************/
+void JobPool::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idle.wait(lock, [this]() { return(m_jobs.empty() && (m_runningJobs == 0)); });
+}
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This method is used for splitting a loop over the passed
+ *  in count into chunks run by the calling thread and the
+ *  worker threads.  The chunks are handed out from a shared
+ *  counter, so a thread that is held up by a longer chunk or
+ *  a queued job simply takes fewer of them.  A loop with a
+ *  single chunk runs on the calling thread only.
+ ***********************************************************/
+void JobPool::ParallelFor(int count, int grainSize, const std::function<void(int, int)>& job)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	grainSize = std::max(grainSize, 1);
+	int chunkCount = (count + grainSize - 1) / grainSize;
+	if ((chunkCount == 1) || (m_threads.size() == 0))
+	{
+		job(0, count);
+		return;
+	}
+
+	std::shared_ptr<PARALLEL_RANGE> pRange = std::make_shared<PARALLEL_RANGE>();
+	pRange->job = job;
+	pRange->count = count;
+	pRange->grainSize = grainSize;
+	pRange->chunkCount = chunkCount;
+	pRange->nextChunk = 0;
+	pRange->finishedChunks = 0;
+
+	int helperCount = std::min((int)m_threads.size(), chunkCount - 1);
+	for (int i = 0; i < helperCount; i++)
+	{
+		Submit([pRange]() { RunChunks(*pRange); });
+	}
+	RunChunks(*pRange);
+
+	// wait for the chunks still running on the workers
+	std::unique_lock<std::mutex> lock(pRange->mutex);
+	pRange->finished.wait(lock, [&pRange]() { return(pRange->finishedChunks == pRange->chunkCount); });
+}
+
+/***********************************************************
+ *  RunChunks()
+ *
+ *  This method is used for taking the next chunk of a
+ *  parallel loop and running it, until every chunk has been
+ *  taken.  The thread finishing the last chunk wakes up the
+ *  thread waiting for the loop.
+ ***********************************************************/
+void JobPool::RunChunks(PARALLEL_RANGE& range)
+{
+	while (true)
+	{
+		int chunk = range.nextChunk.fetch_add(1);
+		if (chunk >= range.chunkCount)
+		{
+			return;
+		}
+
+		int first = chunk * range.grainSize;
+		range.job(first, std::min(first + range.grainSize, range.count));
+
+		if (range.finishedChunks.fetch_add(1) + 1 == range.chunkCount)
+		{
+			std::lock_guard<std::mutex> lock(range.mutex);
+			range.finished.notify_all();
+		}
+	}
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is used by every worker thread for taking the
+ *  next job from the queue and running it, until the pool
+ *  is stopped.
+ ***********************************************************/
+void JobPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobAvailable.wait(lock, [this]() { return(m_bStopping || !m_jobs.empty()); });
+			if (m_jobs.empty())
+			{
+				return;
+			}
+
+			job = m_jobs.front();
+			m_jobs.pop_front();
+			m_runningJobs++;
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_runningJobs--;
+			if (m_jobs.empty() && (m_runningJobs == 0))
+			{
+				m_idle.notify_all();
+			}
+		}
+	}
+}
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobpool.h
+// ============
+// run independent jobs on a pool of worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  JobPool
+ *
+ *  This class owns a fixed number of worker threads that
+ *  take submitted jobs from a shared queue.  A range of work
+ *  can also be split into chunks that the calling thread and
+ *  the workers take one at a time, so the threads that get
+ *  through their chunks faster take over the rest.  Jobs
+ *  must not make OpenGL calls, since the context is only
+ *  current on the main thread.
+ ***********************************************************/
+class JobPool
+{
+public:
+	// constructor - zero threads means one less than the
+	// number of hardware threads, but at least one
+	JobPool(int threadCount = 0);
+	// destructor
+	~JobPool();
+
+	// queue the passed in job to run on a worker thread
+	void Submit(const std::function<void()>& job);
+	// block until the queue is empty and no job is running
+	void WaitIdle();
+	// run the passed in job over the range 0 to count in chunks
+	// of grainSize, on the calling thread and the workers, and
+	// block until every chunk has run - the job is passed the
+	// start and end of its chunk
+	void ParallelFor(int count, int grainSize, const std::function<void(int, int)>& job);
+
+	int GetThreadCount() const { return((int)m_threads.size()); }
+
+private:
+	// range of a parallel loop, shared with the workers helping
+	// with it - a worker can start after the loop has finished,
+	// and then finds no chunk left
+	struct PARALLEL_RANGE
+	{
+		std::function<void(int, int)> job;
+		int count;
+		int grainSize;
+		int chunkCount;
+		std::atomic<int> nextChunk;
+		std::atomic<int> finishedChunks;
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+
+	// worker threads
+	std::vector<std::thread> m_threads;
+	// jobs waiting to run
+	std::deque<std::function<void()>> m_jobs;
+	// number of jobs currently running
+	int m_runningJobs;
+	// true when the worker threads should exit
+	bool m_bStopping;
+
+	std::mutex m_mutex;
+	std::condition_variable m_jobAvailable;
+	std::condition_variable m_idle;
+
+	// take and run jobs until the pool is stopped
+	void WorkerLoop();
+	// take and run chunks of a parallel loop until none is left
+	static void RunChunks(PARALLEL_RANGE& range);
+};
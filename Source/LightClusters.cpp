@@ -0,0 +1,346 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightclusters.cpp
+// ============
+// bin the light sources into view space clusters for forward lighting
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightClusters.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// declaration of the global variables and defines
+namespace
+{
+	// depth the near plane is moved to when a projection puts
+	// it at or behind the camera, which the log cannot take
+	const float g_MinimumNearPlane = 0.01f;
+
+	/***********************************************************
+	 *  GetDepthSlice()
+	 *
+	 *  This function is used for getting the depth slice of a
+	 *  positive view depth, the same way the fragment shader
+	 *  does.
+	 ***********************************************************/
+	int GetDepthSlice(float depth, const glm::vec4& slicing)
+	{
+		int slice = (int)floorf(logf(depth) * slicing.x + slicing.y);
+		return(std::min(std::max(slice, 0), LightClusters::GRID_Z - 1));
+	}
+
+	/***********************************************************
+	 *  GetTile()
+	 *
+	 *  This function is used for getting the tile column or row
+	 *  of a normalized device coordinate.
+	 ***********************************************************/
+	int GetTile(float coordinate, int tileCount)
+	{
+		int tile = (int)floorf((coordinate * 0.5f + 0.5f) * tileCount);
+		return(std::min(std::max(tile, 0), tileCount - 1));
+	}
+}
+
+/***********************************************************
+ *  LightClusters()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightClusters::LightClusters()
+{
+	m_unboundedCount = 0;
+	m_pClusterBuffer = NULL;
+	m_listBufferID = 0;
+	m_listTextureID = 0;
+	m_listCapacity = 0;
+	m_maxClusterLights = 0;
+	m_listedLightCount = 0;
+}
+
+/***********************************************************
+ *  ~LightClusters()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightClusters::~LightClusters()
+{
+	if (NULL != m_pClusterBuffer)
+	{
+		delete m_pClusterBuffer;
+		m_pClusterBuffer = NULL;
+	}
+	if (0 != m_listTextureID)
+	{
+		glDeleteTextures(1, &m_listTextureID);
+		m_listTextureID = 0;
+	}
+	if (0 != m_listBufferID)
+	{
+		glDeleteBuffers(1, &m_listBufferID);
+		m_listBufferID = 0;
+	}
+}
+
+/***********************************************************
+ *  CreateBuffers()
+ *
+ *  This method is used for creating the cluster uniform
+ *  buffer and the buffer texture of the light lists on first
+ *  use, since the OpenGL context does not exist yet in the
+ *  constructor.
+ ***********************************************************/
+void LightClusters::CreateBuffers()
+{
+	if (NULL != m_pClusterBuffer)
+	{
+		return;
+	}
+
+	m_pClusterBuffer = new UniformBuffer();
+	m_pClusterBuffer->Create(CLUSTER_BLOCK_BINDING, sizeof(CLUSTER_UNIFORMS));
+
+	glGenBuffers(1, &m_listBufferID);
+	glBindBuffer(GL_TEXTURE_BUFFER, m_listBufferID);
+	glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint) * 2 * CLUSTER_COUNT, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	m_listCapacity = 2 * CLUSTER_COUNT;
+
+	glGenTextures(1, &m_listTextureID);
+	glBindTexture(GL_TEXTURE_BUFFER, m_listTextureID);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, m_listBufferID);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+	// OpenGL 3.3 only promises buffer textures of 65536 texels,
+	// so a cluster may have to leave out some of its lights
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	m_maxClusterLights = std::max(((int)maxTexels - 2 * CLUSTER_COUNT) / CLUSTER_COUNT, 0);
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method is used for setting the light sources that
+ *  are binned.  The light sources without a range at the
+ *  start of the table are left out of the lists, and any
+ *  later light source without a range is listed in every
+ *  cluster.
+ ***********************************************************/
+void LightClusters::SetLights(const std::vector<glm::vec4>& lights)
+{
+	m_lights = lights;
+	m_unboundedCount = 0;
+	while ((m_unboundedCount < m_lights.size()) && (m_lights[m_unboundedCount].w <= 0.0f))
+	{
+		m_unboundedCount++;
+	}
+}
+
+/***********************************************************
+ *  GetClusterRange()
+ *
+ *  This method is used for finding the clusters that the
+ *  sphere of a light source overlaps.  The depth slices come
+ *  from the nearest and farthest depth of the sphere, and the
+ *  tiles from the screen rectangle of its bounding box, which
+ *  contains the sphere on the screen.  A sphere crossing the
+ *  near plane of a perspective projection can cover any part
+ *  of the screen, so it reaches all the tiles.
+ ***********************************************************/
+bool LightClusters::GetClusterRange(
+	const glm::vec4& light,
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	float nearPlane,
+	float farPlane,
+	const glm::vec4& slicing,
+	CLUSTER_RANGE& range)
+{
+	range.minX = 0;
+	range.maxX = GRID_X - 1;
+	range.minY = 0;
+	range.maxY = GRID_Y - 1;
+	range.minZ = 0;
+	range.maxZ = GRID_Z - 1;
+
+	// a light source without a range reaches every cluster
+	float radius = light.w;
+	if (radius <= 0.0f)
+	{
+		return(true);
+	}
+
+	// view space looks down the negative z axis
+	glm::vec3 center = glm::vec3(view * glm::vec4(glm::vec3(light), 1.0f));
+	float minDepth = -center.z - radius;
+	float maxDepth = -center.z + radius;
+	if ((maxDepth < nearPlane) || (minDepth > farPlane))
+	{
+		return(false);
+	}
+	range.minZ = GetDepthSlice(std::max(minDepth, nearPlane), slicing);
+	range.maxZ = GetDepthSlice(std::min(maxDepth, farPlane), slicing);
+
+	bool bPerspective = (projection[2][3] != 0.0f);
+	if ((bPerspective == true) && (minDepth <= nearPlane))
+	{
+		return(true);
+	}
+
+	glm::vec2 minimum(FLT_MAX);
+	glm::vec2 maximum(-FLT_MAX);
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 offset(
+			(corner & 1) ? radius : -radius,
+			(corner & 2) ? radius : -radius,
+			(corner & 4) ? radius : -radius);
+		glm::vec4 clip = projection * glm::vec4(center + offset, 1.0f);
+		glm::vec2 ndc = glm::vec2(clip) / clip.w;
+		minimum = glm::min(minimum, ndc);
+		maximum = glm::max(maximum, ndc);
+	}
+	if ((maximum.x < -1.0f) || (maximum.y < -1.0f) || (minimum.x > 1.0f) || (minimum.y > 1.0f))
+	{
+		return(false);
+	}
+
+	range.minX = GetTile(minimum.x, GRID_X);
+	range.maxX = GetTile(maximum.x, GRID_X);
+	range.minY = GetTile(minimum.y, GRID_Y);
+	range.maxY = GetTile(maximum.y, GRID_Y);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for listing the light sources of
+ *  every cluster for the passed in view.  The lights are
+ *  counted per cluster first, so the lists are laid out one
+ *  after the other without moving anything, and then filled
+ *  in.  The lists are only uploaded when they changed, and
+ *  the buffer is only reallocated when it needs to grow.
+ ***********************************************************/
+void LightClusters::Update(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	int viewportWidth,
+	int viewportHeight)
+{
+	CreateBuffers();
+	if ((viewportWidth <= 0) || (viewportHeight <= 0))
+	{
+		return;
+	}
+
+	// recover the near and far planes from either kind of
+	// projection matrix
+	float nearPlane = 0.0f;
+	float farPlane = 0.0f;
+	if (projection[2][3] != 0.0f)
+	{
+		nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+		farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+	}
+	else
+	{
+		nearPlane = (projection[3][2] + 1.0f) / projection[2][2];
+		farPlane = (projection[3][2] - 1.0f) / projection[2][2];
+	}
+	nearPlane = std::max(nearPlane, g_MinimumNearPlane);
+	farPlane = std::max(farPlane, nearPlane * 2.0f);
+
+	float logDepthRange = logf(farPlane / nearPlane);
+	CLUSTER_UNIFORMS uniforms;
+	uniforms.grid = glm::ivec4(GRID_X, GRID_Y, GRID_Z, m_unboundedCount);
+	uniforms.slicing = glm::vec4(
+		GRID_Z / logDepthRange,
+		-GRID_Z * logf(nearPlane) / logDepthRange,
+		(float)viewportWidth / GRID_X,
+		(float)viewportHeight / GRID_Y);
+	m_pClusterBuffer->Update(&uniforms, sizeof(uniforms));
+
+	// count the lights reaching every cluster
+	m_clusterCounts.assign(CLUSTER_COUNT, 0);
+	m_lightRanges.resize(m_lights.size());
+	for (int i = m_unboundedCount; i < m_lights.size(); i++)
+	{
+		CLUSTER_RANGE& range = m_lightRanges[i];
+		if (GetClusterRange(m_lights[i], view, projection, nearPlane, farPlane, uniforms.slicing, range) == false)
+		{
+			// an empty range
+			range.minZ = 1;
+			range.maxZ = 0;
+			continue;
+		}
+
+		for (int z = range.minZ; z <= range.maxZ; z++)
+		{
+			for (int y = range.minY; y <= range.maxY; y++)
+			{
+				for (int x = range.minX; x <= range.maxX; x++)
+				{
+					m_clusterCounts[(z * GRID_Y + y) * GRID_X + x]++;
+				}
+			}
+		}
+	}
+
+	// lay out the lists after the offset and count of every
+	// cluster, and fill them in light table order
+	GLuint listEnd = 2 * CLUSTER_COUNT;
+	m_lists.resize(2 * CLUSTER_COUNT);
+	for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++)
+	{
+		m_lists[2 * cluster] = listEnd;
+		m_lists[2 * cluster + 1] = 0;
+		listEnd += std::min((int)m_clusterCounts[cluster], m_maxClusterLights);
+	}
+	m_lists.resize(listEnd);
+	for (int i = m_unboundedCount; i < m_lights.size(); i++)
+	{
+		const CLUSTER_RANGE& range = m_lightRanges[i];
+		for (int z = range.minZ; z <= range.maxZ; z++)
+		{
+			for (int y = range.minY; y <= range.maxY; y++)
+			{
+				for (int x = range.minX; x <= range.maxX; x++)
+				{
+					int cluster = (z * GRID_Y + y) * GRID_X + x;
+					GLuint& count = m_lists[2 * cluster + 1];
+					if (count < (GLuint)m_maxClusterLights)
+					{
+						m_lists[m_lists[2 * cluster] + count] = (GLuint)i;
+						count++;
+					}
+				}
+			}
+		}
+	}
+	m_listedLightCount = (int)listEnd - 2 * CLUSTER_COUNT;
+
+	if (m_lists != m_uploadedLists)
+	{
+		glBindBuffer(GL_TEXTURE_BUFFER, m_listBufferID);
+		if ((int)m_lists.size() > m_listCapacity)
+		{
+			glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint) * m_lists.size(), m_lists.data(), GL_DYNAMIC_DRAW);
+			m_listCapacity = (int)m_lists.size();
+		}
+		else
+		{
+			glBufferSubData(GL_TEXTURE_BUFFER, 0, sizeof(GLuint) * m_lists.size(), m_lists.data());
+		}
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		m_uploadedLists = m_lists;
+	}
+
+	glActiveTexture(GL_TEXTURE0 + LIGHT_LIST_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, m_listTextureID);
+	glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightclusters.h
+// ============
+// bin the light sources into view space clusters for forward lighting
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "UniformBuffer.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  LightClusters
+ *
+ *  This class splits the view frustum into a grid of
+ *  clusters - screen tiles cut into depth slices that get
+ *  deeper with the distance - and lists the light sources
+ *  reaching each cluster, so the fragment shader only loops
+ *  over the lights near its pixel.  A light source with a
+ *  range reaches the clusters its sphere overlaps, and the
+ *  light sources without one at the start of the light table
+ *  reach every cluster without being listed.  The lists are
+ *  built on the CPU every frame and read by the shader from
+ *  a buffer texture, which only needs OpenGL 3.3.
+ ***********************************************************/
+class LightClusters
+{
+public:
+	// constructor
+	LightClusters();
+	// destructor
+	~LightClusters();
+
+	// size of the cluster grid
+	static const int GRID_X = 16;
+	static const int GRID_Y = 9;
+	static const int GRID_Z = 24;
+	static const int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+
+	// texture unit the light lists are bound to
+	static const int LIGHT_LIST_TEXTURE_UNIT = 1;
+
+	// std140 layout of the ClusterBlock uniform block
+	struct CLUSTER_UNIFORMS
+	{
+		// cluster counts in x, y and z, and the number of light
+		// sources without a range at the start of the table
+		glm::ivec4 grid;
+		// scale and bias turning the log of the view depth into
+		// a depth slice, and the tile size in pixels
+		glm::vec4 slicing;
+	};
+
+	// set the world-space position and range of every light
+	// source, in light table order - a range of 0 reaches
+	// everything
+	void SetLights(const std::vector<glm::vec4>& lights);
+
+	// list the lights of every cluster for the passed in view
+	// and projection, and upload and bind the lists
+	void Update(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		int viewportWidth,
+		int viewportHeight);
+
+	// get the number of light indices in the lists of the last
+	// update
+	int GetListedLightCount() const { return(m_listedLightCount); }
+
+private:
+	// range of clusters a light source reaches, inclusive
+	struct CLUSTER_RANGE
+	{
+		int minX;
+		int maxX;
+		int minY;
+		int maxY;
+		int minZ;
+		int maxZ;
+	};
+
+	// positions and ranges of the light sources
+	std::vector<glm::vec4> m_lights;
+	// number of light sources without a range at the start
+	int m_unboundedCount;
+
+	// uniform buffer holding the grid and slicing values
+	UniformBuffer* m_pClusterBuffer;
+	// buffer of the lists and the buffer texture reading it -
+	// the offset and count of every cluster, followed by the
+	// light indices of all the clusters
+	GLuint m_listBufferID;
+	GLuint m_listTextureID;
+	int m_listCapacity;
+	// most light indices one cluster can list, so the lists
+	// fit into the largest buffer texture
+	int m_maxClusterLights;
+
+	// lists built by the last update, the lists in the buffer,
+	// and the cluster ranges of the lights
+	std::vector<GLuint> m_lists;
+	std::vector<GLuint> m_uploadedLists;
+	std::vector<CLUSTER_RANGE> m_lightRanges;
+	std::vector<GLuint> m_clusterCounts;
+	int m_listedLightCount;
+
+	// create the buffers once the OpenGL context exists
+	void CreateBuffers();
+	// find the clusters a light source reaches, returning false
+	// when it is outside of the view
+	static bool GetClusterRange(
+		const glm::vec4& light,
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		float nearPlane,
+		float farPlane,
+		const glm::vec4& slicing,
+		CLUSTER_RANGE& range);
+
+	// the buffers cannot be shared between objects
+	LightClusters(const LightClusters&);
+	LightClusters& operator=(const LightClusters&);
+};
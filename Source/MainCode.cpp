@@ -1,5 +1,12 @@
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <string>           // window title text
+#include <algorithm>        // sorting the benchmark frame times
+#include <cstring>          // command line options
+#include <fstream>          // benchmark report file
+#include <sstream>          // benchmark report text
+#include <vector>           // benchmark frame times
+#include <chrono>           // transform benchmark timing
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -13,6 +20,14 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "ShaderStateCache.h"
+#include "ProgramCache.h"
+#include "JobPool.h"
+#include "FrameProfiler.h"
+#include "RenderStats.h"
+#include "FileWatcher.h"
+#include "FrameScheduler.h"
+#include "TransformBuilder.h"
 
 // Namespace for declaring global variables
 namespace
@@ -27,14 +42,103 @@ namespace
 	SceneManager* g_SceneManager = nullptr;
 	// shader manager object for dynamic interaction with the shader code
 	ShaderManager* g_ShaderManager = nullptr;
+	// cached uniform locations and values of the shader program
+	ShaderStateCache* g_ShaderState = nullptr;
+	// linked shader program binaries kept on disk
+	ProgramCache* g_ProgramCache = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// worker threads for the jobs that can run off the main thread
+	JobPool* g_JobPool = nullptr;
+	// CPU and GPU timing of the steps of every frame
+	FrameProfiler* g_Profiler = nullptr;
+	FrameProfiler::ZONE_HANDLE g_FrameZone = FrameProfiler::INVALID_ZONE;
+	FrameProfiler::ZONE_HANDLE g_ViewZone = FrameProfiler::INVALID_ZONE;
+	FrameProfiler::ZONE_HANDLE g_SceneZone = FrameProfiler::INVALID_ZONE;
+	FrameProfiler::ZONE_HANDLE g_SwapZone = FrameProfiler::INVALID_ZONE;
+	// counters of the rendering work of every frame
+	RenderStats* g_RenderStats = nullptr;
+	// GPU memory of the scene resources, by category
+	GpuMemoryTracker* g_MemoryTracker = nullptr;
+	// watches the scene, shader and texture files for changes
+	FileWatcher* g_FileWatcher = nullptr;
+	// paces the frames and steps the camera at a fixed rate
+	FrameScheduler* g_FrameScheduler = nullptr;
+
+	// shader files of the shader program
+	const char* const VERTEX_SHADER_FILENAME = "shaders/vertexShader.glsl";
+	const char* const FRAGMENT_SHADER_FILENAME = "shaders/fragmentShader.glsl";
+	// fragment shader of the depth pre-pass program
+	const char* const DEPTH_FRAGMENT_SHADER_FILENAME = "shaders/depthFragmentShader.glsl";
+	// directory the linked shader program binaries are kept in
+	const char* const PROGRAM_CACHE_DIRECTORY = "programcache";
+
+	// files the profiler statistics and trace are written to
+	const char* const PROFILE_CSV_FILENAME = "profile.csv";
+	const char* const PROFILE_TRACE_FILENAME = "profile_trace.json";
+
+	// options of the headless benchmark mode
+	struct BENCHMARK_SETTINGS
+	{
+		bool bEnabled;
+		// number of measured frames
+		int frameCount;
+		// number of copies of the scene
+		int sceneCopies;
+		// file the JSON report is written to, empty for the console only
+		std::string outputFilename;
+		// scene file loaded in both modes, empty for the scene
+		// built into the scene manager
+		std::string sceneFilename;
+		// submit the scene with indirect draw calls in both modes
+		bool bIndirectDrawing;
+		// draw a depth pre-pass in both modes
+		bool bDepthPrepass;
+		// display refreshes between two swaps, the most frames
+		// per second or 0 for no cap, and whether frames are
+		// skipped while nothing changes - the benchmark renders
+		// every frame as fast as it can
+		int swapInterval;
+		int frameRateCap;
+		bool bIdleSkipping;
+		// number of model matrices built by the transform
+		// benchmark, 0 when it is not run
+		int transformCount;
+		// most megabytes of textures kept before the unused ones
+		// are evicted, or 0 for no budget
+		int textureBudgetMB;
+	};
+
+	// scene file loaded when none is passed on the command line
+	const char* const DEFAULT_SCENE_FILENAME = "scenes/kitchen.scene";
+
+	// distance between the copies of the scene, wider than the
+	// ground plane so the copies do not overlap
+	const float BENCHMARK_SCENE_SPACING = 100.0f;
+	// frames rendered before measuring, once the textures are loaded
+	const int BENCHMARK_WARMUP_FRAMES = 30;
+	// longest time to wait for the textures to finish loading
+	const double BENCHMARK_LOAD_TIMEOUT = 30.0;
+	// model matrices and passes of the transform benchmark
+	const int TRANSFORM_BENCHMARK_DEFAULT_COUNT = 10000;
+	const int TRANSFORM_BENCHMARK_PASSES = 200;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+void Key_Callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void Window_Refresh_Callback(GLFWwindow* window);
+bool ParseCommandLine(int argc, char* argv[], BENCHMARK_SETTINGS& settings);
+void RenderFrame();
+int RunBenchmark(const BENCHMARK_SETTINGS& settings);
+int RunTransformBenchmark(const BENCHMARK_SETTINGS& settings);
+void SetBenchmarkCamera(int frame, int frameCount);
+void PrintRenderStats(const RenderStats::FRAME_STATS& stats);
+void WatchSceneFiles();
+bool CheckForFileChanges();
+bool ReloadShaders();
 
 
 /***********************************************************
@@ -45,20 +149,60 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	int exitCode = EXIT_SUCCESS;
+
+	// read the benchmark options from the command line
+	BENCHMARK_SETTINGS benchmark;
+	if (ParseCommandLine(argc, argv, benchmark) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// the transform benchmark only measures the CPU, so it runs
+	// without a window
+	if (benchmark.transformCount > 0)
+	{
+		return(RunTransformBenchmark(benchmark));
+	}
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
 		return(EXIT_FAILURE);
 	}
 
+	// the benchmark renders into a window that is never shown
+	if (benchmark.bEnabled == true)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
+
 	// try to create a new shader manager object
 	g_ShaderManager = new ShaderManager();
+	// try to create a new shader state cache object
+	g_ShaderState = new ShaderStateCache();
+	// create the tracker of the GPU memory, shared by the view
+	// and the scene
+	g_MemoryTracker = new GpuMemoryTracker();
+	g_MemoryTracker->SetBudget(
+		GpuMemoryTracker::MEMORY_TEXTURES, (size_t)benchmark.textureBudgetMB * 1024 * 1024);
 	// try to create a new view manager object
 	g_ViewManager = new ViewManager(
-		g_ShaderManager);
+		g_ShaderManager,
+		g_ShaderState,
+		g_MemoryTracker);
 
 	// try to create the main display window
 	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	// if the window could not be created, GLFW is already terminated
+	if (NULL == g_Window)
+	{
+		return(EXIT_FAILURE);
+	}
+	// this callback is used to receive the profiler key presses
+	glfwSetKeyCallback(g_Window, &Key_Callback);
+	// this callback is used to redraw the window when it is uncovered
+	glfwSetWindowRefreshCallback(g_Window, &Window_Refresh_Callback);
 
 	// if GLEW fails initialization, then terminate the application
 	if (InitializeGLEW() == false)
@@ -66,73 +210,216 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"../../../Utilities/shaders/vertexShader.glsl",
-		"../../../Utilities/shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
+	// Enable z-depth - the scene manager restores it after any
+	// pass that changes it, so it is only set once
+	glEnable(GL_DEPTH_TEST);
+
+	// try to create the frame scheduler
+	g_FrameScheduler = new FrameScheduler();
+
+	// the shader programs are loaded from their cached binaries,
+	// or compiled from the external GLSL files
+	g_ProgramCache = new ProgramCache(PROGRAM_CACHE_DIRECTORY);
+
+	// try to create the worker threads for decoding the textures
+	g_JobPool = new JobPool();
+
+	// try to create the frame profiler and its top level zones
+	g_Profiler = new FrameProfiler();
+	g_FrameZone = g_Profiler->RegisterZone("frame");
+	g_ViewZone = g_Profiler->RegisterZone("view setup");
+	g_SceneZone = g_Profiler->RegisterZone("render scene");
+	g_SwapZone = g_Profiler->RegisterZone("swap buffers");
+	// try to create the render counters
+	g_RenderStats = new RenderStats();
 
 	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
+	g_SceneManager = new SceneManager(g_ShaderManager, g_ShaderState, g_ProgramCache, g_JobPool, g_Profiler, g_RenderStats, g_MemoryTracker);
+	g_SceneManager->PrepareScene(
+		(benchmark.sceneFilename.length() > 0) ? benchmark.sceneFilename.c_str() : NULL);
+	g_SceneManager->SetIndirectDrawing(benchmark.bIndirectDrawing);
+	// every variant of the shader program, and the depth pre-pass
+	// program sharing its vertex shader
+	g_SceneManager->LoadShaderVariants(VERTEX_SHADER_FILENAME, FRAGMENT_SHADER_FILENAME);
+	g_SceneManager->LoadDepthProgram(VERTEX_SHADER_FILENAME, DEPTH_FRAGMENT_SHADER_FILENAME);
+	g_SceneManager->SetDepthPrepass(benchmark.bDepthPrepass);
 
-	std::cout << "\n*** KEY FUNCTIONS: ***\n";
-	std::cout << "ESC - close the window and exit\n";
-	std::cout << "W - zoom in\t" << "S - zoom out\n";
-	std::cout << "A - pan left\t" << "D - pan right\n";
-	std::cout << "Q - pan up\t" << "E - pan down\n";
-	std::cout << "1 - front view (ortho)\n";
-	std::cout << "2 - side view (ortho)\n";
-	std::cout << "3 - top view (ortho)\n";
-	std::cout << "4 - perspective view\n";
-	std::cout << "\n*** MOUSE WHEEL FUNCTIONS: ***\n";
-	std::cout << "Scroll up to increase movement speed\n";
-	std::cout << "Scroll down to decrease movement speed\n";
+	if (benchmark.bEnabled == true)
+	{
+		if (benchmark.sceneCopies > 1)
+		{
+			g_SceneManager->ReplicateScene(benchmark.sceneCopies, BENCHMARK_SCENE_SPACING);
+		}
 
-	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
+		// do not wait for the display refresh between frames
+		g_FrameScheduler->SetSwapInterval(0);
+		exitCode = RunBenchmark(benchmark);
+	}
+	else
 	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		std::cout << "\n*** KEY FUNCTIONS: ***\n";
+		std::cout << "ESC - close the window and exit\n";
+		std::cout << "W - zoom in\t" << "S - zoom out\n";
+		std::cout << "A - pan left\t" << "D - pan right\n";
+		std::cout << "Q - pan up\t" << "E - pan down\n";
+		std::cout << "1 - front view (ortho)\n";
+		std::cout << "2 - side view (ortho)\n";
+		std::cout << "3 - top view (ortho)\n";
+		std::cout << "4 - perspective view\n";
+		std::cout << "\n*** MOUSE WHEEL FUNCTIONS: ***\n";
+		std::cout << "Scroll up to increase movement speed\n";
+		std::cout << "Scroll down to decrease movement speed\n";
+		std::cout << "\n*** PROFILER FUNCTIONS: ***\n";
+		std::cout << "F3 - show or hide the profiler overlay\n";
+		std::cout << "F4 - write " << PROFILE_CSV_FILENAME << " and " << PROFILE_TRACE_FILENAME << "\n";
+		std::cout << "F5 - switch between instanced and indirect draw calls\n";
+		std::cout << "F6 - switch the depth pre-pass on or off\n";
+		std::cout << "F7 - print the GPU memory report\n";
+		std::cout << "\nThe scene, shader and texture files are reloaded when they are saved\n";
 
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		g_FrameScheduler->SetSwapInterval(benchmark.swapInterval);
+		g_FrameScheduler->SetFrameRateCap(benchmark.frameRateCap);
+		g_FrameScheduler->SetIdleSkipping(benchmark.bIdleSkipping);
 
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
+		// watch the files the scene was built from
+		g_FileWatcher = new FileWatcher();
+		WatchSceneFiles();
 
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
+		// time when the render stats were last shown in the window title
+		double lastStatsTime = glfwGetTime();
 
+		// loop will keep running until the application is closed 
+		// or until an error has occurred
+		while (!glfwWindowShouldClose(g_Window))
+		{
+			// move the camera by the fixed time steps that passed
+			// since the last frame
+			int steps = g_FrameScheduler->BeginFrame();
+			for (int step = 0; step < steps; step++)
+			{
+				g_ViewManager->UpdateCamera((float)g_FrameScheduler->GetFixedStep());
+			}
 
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
+			// reload the files that were edited since the last check
+			bool bChanged = CheckForFileChanges();
 
-		// query the latest GLFW events
-		glfwPollEvents();
+			// only render when the camera or the scene changed, or
+			// the profiler overlay is shown
+			bChanged = bChanged ||
+				(g_ViewManager->IsViewChanged() == true) ||
+				(g_SceneManager->IsSceneChanged() == true) ||
+				(g_Profiler->IsOverlayVisible() == true);
+
+			// held keys, decoding textures and the overlay change
+			// the frame without sending any events
+			if ((g_ViewManager->IsCameraMoving() == true) ||
+				(g_SceneManager->IsLoadingTextures() == true) ||
+				(g_Profiler->IsOverlayVisible() == true))
+			{
+				g_FrameScheduler->StayAwake();
+			}
+
+			// draw and show the next frame
+			if (g_FrameScheduler->ShouldRender(bChanged) == true)
+			{
+				RenderFrame();
+			}
+
+			// show the uniform upload counters in the window title
+			// about once per second
+			if ((glfwGetTime() - lastStatsTime) >= 1.0)
+			{
+				const RenderStats::FRAME_STATS& stats = g_RenderStats->GetFrameStats();
+				std::string title = std::string(WINDOW_TITLE) +
+					" - draws: " + std::to_string(stats.drawCalls) +
+					", triangles: " + std::to_string(stats.trianglesSubmitted) +
+					", binds: " + std::to_string(stats.textureBinds) +
+					", uniforms issued: " + std::to_string(stats.uniformWrites) +
+					", skipped: " + std::to_string(stats.uniformWritesSkipped) +
+					" - objects drawn: " + std::to_string(g_SceneManager->GetVisibleObjectCount()) +
+					" of " + std::to_string(g_SceneManager->GetObjectCount()) +
+					" - frames: " + std::to_string(g_FrameScheduler->GetRenderedFrameCount()) +
+					", idle: " + std::to_string(g_FrameScheduler->GetSkippedFrameCount());
+				glfwSetWindowTitle(g_Window, title.c_str());
+				lastStatsTime = glfwGetTime();
+
+				if (g_Profiler->IsOverlayVisible() == true)
+				{
+					g_Profiler->PrintStats();
+					PrintRenderStats(stats);
+				}
+			}
+
+			// wait for the frame rate cap, or for the next event
+			// while idle
+			g_FrameScheduler->EndFrame();
+
+			// query the latest GLFW events
+			glfwPollEvents();
+		}
 	}
 
 	// clear the allocated manager objects from memory
+	if (NULL != g_FileWatcher)
+	{
+		delete g_FileWatcher;
+		g_FileWatcher = NULL;
+	}
+	if (NULL != g_FrameScheduler)
+	{
+		delete g_FrameScheduler;
+		g_FrameScheduler = NULL;
+	}
 	if (NULL != g_SceneManager)
 	{
 		delete g_SceneManager;
 		g_SceneManager = NULL;
 	}
+	if (NULL != g_JobPool)
+	{
+		delete g_JobPool;
+		g_JobPool = NULL;
+	}
+	if (NULL != g_Profiler)
+	{
+		delete g_Profiler;
+		g_Profiler = NULL;
+	}
+	if (NULL != g_RenderStats)
+	{
+		delete g_RenderStats;
+		g_RenderStats = NULL;
+	}
 	if (NULL != g_ViewManager)
 	{
 		delete g_ViewManager;
 		g_ViewManager = NULL;
 	}
+	// the tracker goes after the scene and the view, since they
+	// count the release of their GPU memory in it
+	if (NULL != g_MemoryTracker)
+	{
+		delete g_MemoryTracker;
+		g_MemoryTracker = NULL;
+	}
+	if (NULL != g_ShaderState)
+	{
+		delete g_ShaderState;
+		g_ShaderState = NULL;
+	}
+	if (NULL != g_ProgramCache)
+	{
+		delete g_ProgramCache;
+		g_ProgramCache = NULL;
+	}
 	if (NULL != g_ShaderManager)
 	{
 		delete g_ShaderManager;
 		g_ShaderManager = NULL;
 	}
 
-	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
+	// Terminates the program
+	exit(exitCode); 
 }
 
 /***********************************************************
@@ -187,4 +474,611 @@ bool InitializeGLEW()
 	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
 
 	return(true);
-}
\ No newline at end of file
+}
+
+/***********************************************************
+ *	Key_Callback()
+ *
+ *  This function is automatically called from GLFW whenever
+ *  a key is pressed, and handles the profiler keys, the
+ *  draw call and depth pre-pass switches, and the report of
+ *  the GPU memory.
+ ***********************************************************/
+void Key_Callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if ((action != GLFW_PRESS) || (NULL == g_Profiler))
+	{
+		return;
+	}
+
+	// the switches change the frame while the view stays the same
+	if (NULL != g_FrameScheduler)
+	{
+		g_FrameScheduler->Invalidate();
+	}
+
+	if (key == GLFW_KEY_F3)
+	{
+		g_Profiler->SetOverlayVisible(!g_Profiler->IsOverlayVisible());
+	}
+	if (key == GLFW_KEY_F4)
+	{
+		if ((g_Profiler->WriteCSV(PROFILE_CSV_FILENAME) == true) &&
+			(g_Profiler->WriteChromeTrace(PROFILE_TRACE_FILENAME) == true))
+		{
+			std::cout << "INFO: profiler written to " << PROFILE_CSV_FILENAME << " and " << PROFILE_TRACE_FILENAME << std::endl;
+		}
+	}
+	if ((key == GLFW_KEY_F5) && (NULL != g_SceneManager))
+	{
+		g_SceneManager->SetIndirectDrawing(!g_SceneManager->IsIndirectDrawing());
+		std::cout << "INFO: " << (g_SceneManager->IsIndirectDrawing() ? "indirect" : "instanced") << " draw calls" << std::endl;
+	}
+	if ((key == GLFW_KEY_F6) && (NULL != g_SceneManager))
+	{
+		g_SceneManager->SetDepthPrepass(!g_SceneManager->IsDepthPrepass());
+		std::cout << "INFO: depth pre-pass " << (g_SceneManager->IsDepthPrepass() ? "on" : "off") << std::endl;
+	}
+	if ((key == GLFW_KEY_F7) && (NULL != g_MemoryTracker))
+	{
+		std::cout << "INFO: GPU memory" << std::endl;
+		g_MemoryTracker->WriteReport(std::cout);
+	}
+}
+
+/***********************************************************
+ *	Window_Refresh_Callback()
+ *
+ *  This function is automatically called from GLFW whenever
+ *  the contents of the window need to be drawn again, such
+ *  as after it was uncovered.
+ ***********************************************************/
+void Window_Refresh_Callback(GLFWwindow* window)
+{
+	if (NULL != g_FrameScheduler)
+	{
+		g_FrameScheduler->Invalidate();
+	}
+}
+
+/***********************************************************
+ *	RenderFrame()
+ *
+ *  This function is used to draw and show one frame of the
+ *  3D scene.
+ ***********************************************************/
+void RenderFrame()
+{
+	// start counting the uniform uploads and the render work
+	// and timing the zones for this frame
+	g_ShaderState->BeginFrame();
+	g_RenderStats->BeginFrame();
+	g_Profiler->BeginFrame();
+	g_Profiler->BeginZone(g_FrameZone);
+
+	// Clear the frame and z buffers
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// convert from 3D object space to 2D view
+	g_Profiler->BeginZone(g_ViewZone);
+	g_ViewManager->PrepareSceneView();
+	g_SceneManager->SetViewFrustum(
+		g_ViewManager->GetViewMatrix(),
+		g_ViewManager->GetProjectionMatrix(),
+		g_ViewManager->GetViewportWidth(),
+		g_ViewManager->GetViewportHeight());
+	g_Profiler->EndZone(g_ViewZone);
+
+	// refresh the 3D scene
+	g_Profiler->BeginZone(g_SceneZone);
+	g_SceneManager->RenderScene();
+	g_Profiler->EndZone(g_SceneZone);
+
+	g_Profiler->DrawOverlay(g_ViewManager->GetViewportWidth(), g_ViewManager->GetViewportHeight());
+
+	// Flips the the back buffer with the front buffer every frame.
+	g_Profiler->BeginZone(g_SwapZone);
+	glfwSwapBuffers(g_Window);
+	g_Profiler->EndZone(g_SwapZone);
+	g_Profiler->EndZone(g_FrameZone);
+	g_Profiler->EndFrame();
+
+	ShaderStateCache::UNIFORM_STATS uniformStats = g_ShaderState->GetFrameStats();
+	g_RenderStats->AddUniformWrites(uniformStats.uploadsIssued, uniformStats.uploadsSkipped);
+}
+
+/***********************************************************
+ *	PrintRenderStats()
+ *
+ *  This function is used to print the render counters of a
+ *  frame to the console.
+ ***********************************************************/
+void PrintRenderStats(const RenderStats::FRAME_STATS& stats)
+{
+	std::cout << "draw calls: " << stats.drawCalls
+		<< " (" << stats.indirectCommands << " indirect commands)"
+		<< ", instances: " << stats.instancesDrawn
+		<< ", triangles: " << stats.trianglesSubmitted
+		<< ", texture binds: " << stats.textureBinds
+		<< ", uniform writes: " << stats.uniformWrites
+		<< " (" << stats.uniformWritesSkipped << " skipped)"
+		<< ", material lookups: " << stats.materialLookups
+		<< ", texture lookups: " << stats.textureLookups << std::endl;
+}
+
+/***********************************************************
+ *	WatchSceneFiles()
+ *
+ *  This function is used to watch the shader files, the
+ *  scene file and the image files of the textures.  Files
+ *  that are already watched keep their handles, so it can be
+ *  called again when the scene adds textures.
+ ***********************************************************/
+void WatchSceneFiles()
+{
+	std::vector<std::string> textureFilenames;
+
+	g_FileWatcher->Watch(VERTEX_SHADER_FILENAME);
+	g_FileWatcher->Watch(FRAGMENT_SHADER_FILENAME);
+	g_FileWatcher->Watch(DEPTH_FRAGMENT_SHADER_FILENAME);
+	if (g_SceneManager->GetSceneFilename().length() > 0)
+	{
+		g_FileWatcher->Watch(g_SceneManager->GetSceneFilename());
+	}
+
+	g_SceneManager->GetTextureFilenames(textureFilenames);
+	for (const std::string& filename : textureFilenames)
+	{
+		g_FileWatcher->Watch(filename);
+	}
+}
+
+/***********************************************************
+ *	CheckForFileChanges()
+ *
+ *  This function is used to reload only the files that were
+ *  changed since the last check - a shader file relinks the
+ *  shader program, the scene file replaces the objects,
+ *  materials and lights, and an image file decodes the
+ *  textures using it again.  Returns whether any file was
+ *  reloaded.
+ ***********************************************************/
+bool CheckForFileChanges()
+{
+	std::vector<FileWatcher::WATCH_HANDLE> changed;
+	bool bShadersChanged = false;
+	bool bSceneChanged = false;
+
+	if (g_FileWatcher->Poll(changed) == false)
+	{
+		return(false);
+	}
+
+	for (FileWatcher::WATCH_HANDLE handle : changed)
+	{
+		const std::string& filename = g_FileWatcher->GetFilename(handle);
+		std::cout << "File changed:" << filename << std::endl;
+
+		if ((filename == VERTEX_SHADER_FILENAME) || (filename == FRAGMENT_SHADER_FILENAME) ||
+			(filename == DEPTH_FRAGMENT_SHADER_FILENAME))
+		{
+			bShadersChanged = true;
+		}
+		else if (filename == g_SceneManager->GetSceneFilename())
+		{
+			bSceneChanged = true;
+		}
+		else
+		{
+			g_SceneManager->ReloadTexture(filename);
+		}
+	}
+
+	// the shader files are linked together, so they are only
+	// reloaded once when several have changed
+	if (bShadersChanged == true)
+	{
+		ReloadShaders();
+	}
+	if (bSceneChanged == true)
+	{
+		std::string sceneFilename = g_SceneManager->GetSceneFilename();
+		if (g_SceneManager->LoadSceneFile(sceneFilename.c_str()) == true)
+		{
+			WatchSceneFiles();
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *	ReloadShaders()
+ *
+ *  This function is used to load, compile and link the
+ *  shader files again, through the program cache.  When all
+ *  the new shader variants link, they replace the old ones
+ *  and the cached uniforms are written into them as they are
+ *  used, otherwise the old variants are kept.
+ ***********************************************************/
+bool ReloadShaders()
+{
+	if (g_SceneManager->LoadShaderVariants(VERTEX_SHADER_FILENAME, FRAGMENT_SHADER_FILENAME) == false)
+	{
+		// keep rendering with the programs that worked
+		std::cout << "Could not reload the shaders, keeping the previous shader program" << std::endl;
+		return(false);
+	}
+
+	// the depth pre-pass shares the vertex shader
+	g_SceneManager->LoadDepthProgram(VERTEX_SHADER_FILENAME, DEPTH_FRAGMENT_SHADER_FILENAME);
+	std::cout << "Successfully reloaded the shaders" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *	ParseCommandLine()
+ *
+ *  This function is used to read the benchmark options from
+ *  the command line:
+ *    --benchmark        run the headless benchmark
+ *    --frames=N         number of measured frames
+ *    --copies=N         number of copies of the scene
+ *    --output=FILE      also write the JSON report to FILE
+ *    --scene=FILE       load the scene from FILE, or pass
+ *                       --scene= for the built-in scene
+ *    --indirect         submit the scene with indirect draws
+ *    --depth-prepass    draw the depth before shading
+ *    --swap-interval=N  display refreshes between two swaps
+ *    --fps-cap=N        render at most N frames per second
+ *    --no-idle          render every frame, even when
+ *                       nothing changed
+ *    --transform-benchmark[=N]
+ *                       time building N model matrices in
+ *                       batches against composing them
+ *    --texture-budget=MB
+ *                       evict the unused textures when the
+ *                       textures take more than MB megabytes
+ ***********************************************************/
+bool ParseCommandLine(int argc, char* argv[], BENCHMARK_SETTINGS& settings)
+{
+	settings.bEnabled = false;
+	settings.frameCount = 2000;
+	settings.sceneCopies = 1;
+	settings.outputFilename.clear();
+	settings.sceneFilename = DEFAULT_SCENE_FILENAME;
+	settings.bIndirectDrawing = false;
+	settings.bDepthPrepass = false;
+	settings.swapInterval = 1;
+	settings.frameRateCap = 0;
+	settings.bIdleSkipping = true;
+	settings.transformCount = 0;
+	settings.textureBudgetMB = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* pArgument = argv[i];
+
+		if (strcmp(pArgument, "--benchmark") == 0)
+		{
+			settings.bEnabled = true;
+		}
+		else if (strncmp(pArgument, "--frames=", 9) == 0)
+		{
+			settings.frameCount = atoi(pArgument + 9);
+		}
+		else if (strncmp(pArgument, "--copies=", 9) == 0)
+		{
+			settings.sceneCopies = atoi(pArgument + 9);
+		}
+		else if (strncmp(pArgument, "--output=", 9) == 0)
+		{
+			settings.outputFilename = pArgument + 9;
+		}
+		else if (strncmp(pArgument, "--scene=", 8) == 0)
+		{
+			settings.sceneFilename = pArgument + 8;
+		}
+		else if (strcmp(pArgument, "--indirect") == 0)
+		{
+			settings.bIndirectDrawing = true;
+		}
+		else if (strcmp(pArgument, "--depth-prepass") == 0)
+		{
+			settings.bDepthPrepass = true;
+		}
+		else if (strncmp(pArgument, "--swap-interval=", 16) == 0)
+		{
+			settings.swapInterval = atoi(pArgument + 16);
+		}
+		else if (strncmp(pArgument, "--fps-cap=", 10) == 0)
+		{
+			settings.frameRateCap = atoi(pArgument + 10);
+		}
+		else if (strcmp(pArgument, "--no-idle") == 0)
+		{
+			settings.bIdleSkipping = false;
+		}
+		else if (strcmp(pArgument, "--transform-benchmark") == 0)
+		{
+			settings.transformCount = TRANSFORM_BENCHMARK_DEFAULT_COUNT;
+		}
+		else if (strncmp(pArgument, "--transform-benchmark=", 22) == 0)
+		{
+			settings.transformCount = atoi(pArgument + 22);
+		}
+		else if (strncmp(pArgument, "--texture-budget=", 17) == 0)
+		{
+			settings.textureBudgetMB = atoi(pArgument + 17);
+		}
+		else
+		{
+			std::cerr << "Unknown option: " << pArgument << "\n"
+				<< "Usage: " << argv[0] << " [--scene=FILE] [--indirect] [--depth-prepass] [--swap-interval=N] [--fps-cap=N] [--no-idle] [--texture-budget=MB] [--benchmark [--frames=N] [--copies=N] [--output=FILE]] [--transform-benchmark[=N] [--output=FILE]]" << std::endl;
+			return(false);
+		}
+	}
+
+	if ((settings.frameCount <= 0) || (settings.sceneCopies <= 0))
+	{
+		std::cerr << "The frame count and the number of copies must be positive" << std::endl;
+		return(false);
+	}
+	if ((settings.swapInterval < 0) || (settings.frameRateCap < 0) || (settings.transformCount < 0) ||
+		(settings.textureBudgetMB < 0))
+	{
+		std::cerr << "The swap interval, the frame rate cap, the transform count and the texture budget cannot be negative" << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *	SetBenchmarkCamera()
+ *
+ *  This function is used to place the camera for the passed
+ *  in benchmark frame.  The first half of the frames holds
+ *  each of the four preset views in turn, and the second
+ *  half circles once around the table in perspective, so
+ *  every run renders exactly the same frames.
+ ***********************************************************/
+void SetBenchmarkCamera(int frame, int frameCount)
+{
+	int presetFrames = frameCount / 8;
+	if ((presetFrames > 0) && (frame < presetFrames * 4))
+	{
+		g_ViewManager->ApplyViewPreset((ViewManager::VIEW_PRESET)(frame / presetFrames));
+		return;
+	}
+
+	const glm::vec3 center(0.0f, 0.0f, -20.0f);
+	const float radius = 32.0f;
+	const float height = 12.0f;
+
+	int orbitFrames = frameCount - presetFrames * 4;
+	float angle = 2.0f * 3.14159265f * (frame - presetFrames * 4) / orbitFrames;
+	glm::vec3 position = center + glm::vec3(radius * cosf(angle), height, radius * sinf(angle));
+
+	g_ViewManager->SetCameraPose(
+		position,
+		glm::normalize(center - position),
+		glm::vec3(0.0f, 1.0f, 0.0f),
+		false);
+}
+
+/***********************************************************
+ *	RunBenchmark()
+ *
+ *  This function is used to render the scripted camera path
+ *  without waiting for the display, and to report the frame
+ *  rate, the frame time percentiles, the draw calls and the
+ *  uniform uploads per frame as JSON.
+ ***********************************************************/
+int RunBenchmark(const BENCHMARK_SETTINGS& settings)
+{
+	// textures arrive over the first frames, so wait for them
+	// before measuring
+	double loadStart = glfwGetTime();
+	SetBenchmarkCamera(0, settings.frameCount);
+	while ((g_SceneManager->IsLoadingTextures() == true) &&
+		((glfwGetTime() - loadStart) < BENCHMARK_LOAD_TIMEOUT))
+	{
+		RenderFrame();
+		glfwPollEvents();
+	}
+	for (int i = 0; i < BENCHMARK_WARMUP_FRAMES; i++)
+	{
+		RenderFrame();
+		glfwPollEvents();
+	}
+
+	std::vector<double> frameTimes;
+	double totalDrawCalls = 0.0;
+	double totalIndirectCommands = 0.0;
+	double totalTriangles = 0.0;
+	double totalTextureBinds = 0.0;
+	double totalUploadsIssued = 0.0;
+	double totalUploadsSkipped = 0.0;
+	double totalMaterialLookups = 0.0;
+	double totalTextureLookups = 0.0;
+	double totalObjectsDrawn = 0.0;
+
+	frameTimes.reserve(settings.frameCount);
+	double benchmarkStart = glfwGetTime();
+	for (int frame = 0; frame < settings.frameCount; frame++)
+	{
+		SetBenchmarkCamera(frame, settings.frameCount);
+
+		double frameStart = glfwGetTime();
+		RenderFrame();
+		frameTimes.push_back((glfwGetTime() - frameStart) * 1000.0);
+
+		const RenderStats::FRAME_STATS& stats = g_RenderStats->GetFrameStats();
+		totalDrawCalls += stats.drawCalls;
+		totalIndirectCommands += stats.indirectCommands;
+		totalTriangles += (double)stats.trianglesSubmitted;
+		totalTextureBinds += stats.textureBinds;
+		totalUploadsIssued += stats.uniformWrites;
+		totalUploadsSkipped += stats.uniformWritesSkipped;
+		totalMaterialLookups += stats.materialLookups;
+		totalTextureLookups += stats.textureLookups;
+		totalObjectsDrawn += g_SceneManager->GetVisibleObjectCount();
+
+		glfwPollEvents();
+	}
+	double benchmarkSeconds = glfwGetTime() - benchmarkStart;
+
+	std::vector<double> sorted(frameTimes);
+	std::sort(sorted.begin(), sorted.end());
+	double totalFrameTime = 0.0;
+	for (double frameTime : sorted)
+	{
+		totalFrameTime += frameTime;
+	}
+	// nearest rank percentile of the sorted frame times
+	auto percentile = [&sorted](int percent)
+	{
+		int rank = ((int)sorted.size() * percent + 99) / 100;
+		return(sorted[std::min(std::max(rank - 1, 0), (int)sorted.size() - 1)]);
+	};
+
+	double frames = (double)settings.frameCount;
+	std::ostringstream report;
+	report << "{\n"
+		<< "  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n"
+		<< "  \"frames\": " << settings.frameCount << ",\n"
+		<< "  \"scene_copies\": " << settings.sceneCopies << ",\n"
+		<< "  \"objects\": " << g_SceneManager->GetObjectCount() << ",\n"
+		<< "  \"indirect_drawing\": " << (g_SceneManager->IsIndirectDrawing() ? "true" : "false") << ",\n"
+		<< "  \"depth_prepass\": " << (g_SceneManager->IsDepthPrepass() ? "true" : "false") << ",\n"
+		<< "  \"seconds\": " << benchmarkSeconds << ",\n"
+		<< "  \"fps\": " << (frames / benchmarkSeconds) << ",\n"
+		<< "  \"frame_ms\": {"
+		<< "\"min\": " << sorted.front()
+		<< ", \"avg\": " << (totalFrameTime / frames)
+		<< ", \"p50\": " << percentile(50)
+		<< ", \"p90\": " << percentile(90)
+		<< ", \"p99\": " << percentile(99)
+		<< ", \"max\": " << sorted.back() << "},\n"
+		<< "  \"draw_calls_per_frame\": " << (totalDrawCalls / frames) << ",\n"
+		<< "  \"indirect_commands_per_frame\": " << (totalIndirectCommands / frames) << ",\n"
+		<< "  \"triangles_per_frame\": " << (totalTriangles / frames) << ",\n"
+		<< "  \"objects_drawn_per_frame\": " << (totalObjectsDrawn / frames) << ",\n"
+		<< "  \"texture_binds_per_frame\": " << (totalTextureBinds / frames) << ",\n"
+		<< "  \"uniform_uploads_per_frame\": " << (totalUploadsIssued / frames) << ",\n"
+		<< "  \"uniform_uploads_skipped_per_frame\": " << (totalUploadsSkipped / frames) << ",\n"
+		<< "  \"material_lookups_per_frame\": " << (totalMaterialLookups / frames) << ",\n"
+		<< "  \"texture_lookups_per_frame\": " << (totalTextureLookups / frames) << ",\n"
+		<< "  \"gpu_memory\": { ";
+	g_MemoryTracker->WriteJson(report);
+	report << " }\n"
+		<< "}\n";
+
+	std::cout << report.str() << std::flush;
+	if (settings.outputFilename.length() > 0)
+	{
+		std::ofstream file(settings.outputFilename.c_str());
+		file << report.str();
+		if (!file)
+		{
+			std::cerr << "Could not write benchmark report:" << settings.outputFilename << std::endl;
+			return(EXIT_FAILURE);
+		}
+	}
+
+	return(EXIT_SUCCESS);
+}
+
+/***********************************************************
+ *	RunTransformBenchmark()
+ *
+ *  This function is used to time building the model
+ *  matrices of many objects in one batch against composing
+ *  each of them from separate scale, rotation and
+ *  translation matrices, and to report both and the largest
+ *  difference between their results as JSON.
+ ***********************************************************/
+int RunTransformBenchmark(const BENCHMARK_SETTINGS& settings)
+{
+	int count = settings.transformCount;
+	std::vector<glm::vec3> scales(count);
+	std::vector<glm::vec3> rotations(count);
+	std::vector<glm::vec3> positions(count);
+	TransformBuilder builder;
+
+	// the same transformations on every run, spread over the
+	// ranges the scenes use
+	unsigned int seed = 12345;
+	auto random = [&seed](float minimum, float maximum)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return(minimum + (maximum - minimum) * (float)(seed >> 8) / 16777216.0f);
+	};
+	for (int i = 0; i < count; i++)
+	{
+		scales[i] = glm::vec3(random(0.1f, 10.0f), random(0.1f, 10.0f), random(0.1f, 10.0f));
+		rotations[i] = glm::vec3(random(-180.0f, 180.0f), random(-180.0f, 180.0f), random(-180.0f, 180.0f));
+		positions[i] = glm::vec3(random(-50.0f, 50.0f), random(-10.0f, 10.0f), random(-50.0f, 50.0f));
+		builder.Add(scales[i], rotations[i], positions[i]);
+	}
+
+	std::vector<glm::mat4> composed(count);
+	std::vector<glm::mat4> built(count);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < TRANSFORM_BENCHMARK_PASSES; pass++)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			composed[i] = TransformBuilder::ComposeModelMatrix(scales[i], rotations[i], positions[i]);
+		}
+	}
+	double composeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < TRANSFORM_BENCHMARK_PASSES; pass++)
+	{
+		builder.Build(built.data());
+	}
+	double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	float maxError = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				maxError = std::max(maxError, fabsf(composed[i][column][row] - built[i][column][row]));
+			}
+		}
+	}
+
+	double matrices = (double)count * TRANSFORM_BENCHMARK_PASSES;
+	std::ostringstream report;
+	report << "{\n"
+		<< "  \"matrices\": " << count << ",\n"
+		<< "  \"passes\": " << TRANSFORM_BENCHMARK_PASSES << ",\n"
+		<< "  \"compose_ns_per_matrix\": " << (composeSeconds * 1.0e9 / matrices) << ",\n"
+		<< "  \"batch_ns_per_matrix\": " << (batchSeconds * 1.0e9 / matrices) << ",\n"
+		<< "  \"speedup\": " << (composeSeconds / std::max(batchSeconds, 1.0e-9)) << ",\n"
+		<< "  \"max_error\": " << maxError << "\n"
+		<< "}\n";
+
+	std::cout << report.str() << std::flush;
+	if (settings.outputFilename.length() > 0)
+	{
+		std::ofstream file(settings.outputFilename.c_str());
+		file << report.str();
+		if (!file)
+		{
+			std::cerr << "Could not write benchmark report:" << settings.outputFilename << std::endl;
+			return(EXIT_FAILURE);
+		}
+	}
+
+	return(EXIT_SUCCESS);
+}
@@ -0,0 +1,47 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// map a file read-only into memory
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class maps the whole of a file read-only into the
+ *  address space of the process, so its contents can be
+ *  used in place without copying them into a buffer first.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+	// map the file at the passed in path
+	bool Open(const char* filename);
+	// unmap the file
+	void Close();
+
+	const unsigned char* GetData() const { return(m_pData); }
+	size_t GetSize() const { return(m_size); }
+	bool IsOpen() const { return(NULL != m_pData); }
+
+private:
+	// start and size of the mapped contents
+	const unsigned char* m_pData;
+	size_t m_size;
+	// operating system handles of the file and the mapping
+	void* m_fileHandle;
+	void* m_mappingHandle;
+
+	// the mapping cannot be shared between objects
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+};
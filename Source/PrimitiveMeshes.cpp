@@ -0,0 +1,864 @@
+///////////////////////////////////////////////////////////////////////////////
+// primitivemeshes.cpp
+// ============
+// generate the basic 3D shape meshes and draw them with per-instance data
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PrimitiveMeshes.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+// declaration of the global variables and defines
+namespace
+{
+	// number of floats per vertex - position, normal, texture coordinate
+	const int g_FloatsPerVertex = 8;
+	// attribute locations used by the vertex shader
+	const GLuint g_PositionLocation = 0;
+	const GLuint g_NormalLocation = 1;
+	const GLuint g_TextureCoordinateLocation = 2;
+	const GLuint g_InstanceModelLocation = 3;
+	const GLuint g_InstanceUVscaleLocation = 7;
+	const GLuint g_InstanceIndicesLocation = 8;
+
+	// tessellation of the round meshes at each level of detail,
+	// from the finest to the coarsest - the stacks are even so
+	// the half sphere ends on a ring
+	const int g_RoundSlices[PrimitiveMeshes::LOD_LEVELS] = { 36, 18, 10 };
+	const int g_SphereStacks[PrimitiveMeshes::LOD_LEVELS] = { 18, 10, 6 };
+
+	const float g_Pi = 3.14159265358979f;
+
+	/***********************************************************
+	 *  AddVertex()
+	 *
+	 *  This function is used for appending one interleaved
+	 *  vertex to the passed in vertex list.
+	 ***********************************************************/
+	void AddVertex(
+		std::vector<GLfloat>& vertices,
+		glm::vec3 position,
+		glm::vec3 normal,
+		glm::vec2 textureCoordinate)
+	{
+		vertices.push_back(position.x);
+		vertices.push_back(position.y);
+		vertices.push_back(position.z);
+		vertices.push_back(normal.x);
+		vertices.push_back(normal.y);
+		vertices.push_back(normal.z);
+		vertices.push_back(textureCoordinate.x);
+		vertices.push_back(textureCoordinate.y);
+	}
+
+	/***********************************************************
+	 *  AddQuad()
+	 *
+	 *  This function is used for appending a quad around the
+	 *  passed in center, spanned by the half extents u and v.
+	 *  The cross product of u and v points along the normal.
+	 ***********************************************************/
+	void AddQuad(
+		std::vector<GLfloat>& vertices,
+		std::vector<GLuint>& indices,
+		glm::vec3 center,
+		glm::vec3 u,
+		glm::vec3 v)
+	{
+		GLuint first = (GLuint)(vertices.size() / g_FloatsPerVertex);
+		glm::vec3 normal = glm::normalize(glm::cross(u, v));
+
+		AddVertex(vertices, center - u - v, normal, glm::vec2(0.0f, 0.0f));
+		AddVertex(vertices, center + u - v, normal, glm::vec2(1.0f, 0.0f));
+		AddVertex(vertices, center + u + v, normal, glm::vec2(1.0f, 1.0f));
+		AddVertex(vertices, center - u + v, normal, glm::vec2(0.0f, 1.0f));
+
+		indices.push_back(first);
+		indices.push_back(first + 1);
+		indices.push_back(first + 2);
+		indices.push_back(first);
+		indices.push_back(first + 2);
+		indices.push_back(first + 3);
+	}
+
+	/***********************************************************
+	 *  AddDisc()
+	 *
+	 *  This function is used for appending a disc of radius 1
+	 *  in the XZ plane at the passed in height, facing up or
+	 *  down, with the passed in number of slices.
+	 ***********************************************************/
+	void AddDisc(
+		std::vector<GLfloat>& vertices,
+		std::vector<GLuint>& indices,
+		float height,
+		bool bFacingUp,
+		int slices)
+	{
+		GLuint center = (GLuint)(vertices.size() / g_FloatsPerVertex);
+		glm::vec3 normal(0.0f, bFacingUp ? 1.0f : -1.0f, 0.0f);
+
+		AddVertex(vertices, glm::vec3(0.0f, height, 0.0f), normal, glm::vec2(0.5f, 0.5f));
+		for (int i = 0; i <= slices; i++)
+		{
+			float angle = 2.0f * g_Pi * i / slices;
+			float x = cosf(angle);
+			float z = sinf(angle);
+			AddVertex(vertices, glm::vec3(x, height, z), normal, glm::vec2(0.5f + 0.5f * x, 0.5f + 0.5f * z));
+		}
+
+		for (int i = 0; i < slices; i++)
+		{
+			indices.push_back(center);
+			if (bFacingUp)
+			{
+				indices.push_back(center + i + 2);
+				indices.push_back(center + i + 1);
+			}
+			else
+			{
+				indices.push_back(center + i + 1);
+				indices.push_back(center + i + 2);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  AddSphereRings()
+	 *
+	 *  This function is used for appending the rings of a unit
+	 *  sphere with the passed in number of slices and stacks,
+	 *  from the top pole down to the passed in stack.
+	 ***********************************************************/
+	void AddSphereRings(
+		std::vector<GLfloat>& vertices,
+		std::vector<GLuint>& indices,
+		int slices,
+		int stacks,
+		int lastStack)
+	{
+		GLuint first = (GLuint)(vertices.size() / g_FloatsPerVertex);
+		int ringVertices = slices + 1;
+
+		for (int stack = 0; stack <= lastStack; stack++)
+		{
+			float polar = g_Pi * stack / stacks;
+			for (int i = 0; i <= slices; i++)
+			{
+				float angle = 2.0f * g_Pi * i / slices;
+				glm::vec3 position(sinf(polar) * cosf(angle), cosf(polar), sinf(polar) * sinf(angle));
+				AddVertex(vertices, position, position,
+					glm::vec2((float)i / slices, 1.0f - (float)stack / stacks));
+			}
+		}
+
+		for (int stack = 0; stack < lastStack; stack++)
+		{
+			for (int i = 0; i < slices; i++)
+			{
+				GLuint upper = first + stack * ringVertices + i;
+				GLuint lower = upper + ringVertices;
+
+				indices.push_back(upper);
+				indices.push_back(upper + 1);
+				indices.push_back(lower);
+				indices.push_back(upper + 1);
+				indices.push_back(lower + 1);
+				indices.push_back(lower);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  PrimitiveMeshes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PrimitiveMeshes::PrimitiveMeshes(RenderStats* pRenderStats, GpuMemoryTracker* pMemoryTracker)
+{
+	m_pRenderStats = pRenderStats;
+	m_pMemoryTracker = pMemoryTracker;
+	for (int kind = 0; kind < MESH_KIND_COUNT; kind++)
+	{
+		for (int level = 0; level < LOD_LEVELS; level++)
+		{
+			m_meshRanges[kind][level] = MESH_RANGE();
+		}
+	}
+	m_vertexArrayID = 0;
+	m_vertexBufferID = 0;
+	m_indexBufferID = 0;
+	m_pInstanceRing = new RingBuffer(m_pMemoryTracker);
+	m_instancePointerBufferID = 0;
+	m_instancePointerGeneration = 0;
+	m_instanceBase = 0;
+	m_instanceCount = 0;
+	m_bBaseInstance = false;
+	m_pCommandRing = new RingBuffer(m_pMemoryTracker);
+	m_commandOffset = 0;
+	m_commandCount = 0;
+}
+
+/***********************************************************
+ *  ~PrimitiveMeshes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PrimitiveMeshes::~PrimitiveMeshes()
+{
+	if (0 != m_vertexArrayID)
+	{
+		glDeleteVertexArrays(1, &m_vertexArrayID);
+		m_vertexArrayID = 0;
+	}
+	if (0 != m_vertexBufferID)
+	{
+		glDeleteBuffers(1, &m_vertexBufferID);
+		m_vertexBufferID = 0;
+	}
+	if (0 != m_indexBufferID)
+	{
+		glDeleteBuffers(1, &m_indexBufferID);
+		m_indexBufferID = 0;
+	}
+	TrackBufferSizes(false);
+	m_vertices.clear();
+	m_indices.clear();
+	if (NULL != m_pInstanceRing)
+	{
+		delete m_pInstanceRing;
+		m_pInstanceRing = NULL;
+	}
+	m_instanceCount = 0;
+	if (NULL != m_pCommandRing)
+	{
+		delete m_pCommandRing;
+		m_pCommandRing = NULL;
+	}
+	m_commandCount = 0;
+}
+
+/***********************************************************
+ *  CreateVertexArray()
+ *
+ *  This method is used for creating the vertex array shared
+ *  by all the meshes, with its vertex and index buffers.
+ *  The per-instance attributes are pointed at the instance
+ *  ring buffer once it has been created.
+ ***********************************************************/
+void PrimitiveMeshes::CreateVertexArray()
+{
+	GLsizei stride = sizeof(GLfloat) * g_FloatsPerVertex;
+
+	if (0 != m_vertexArrayID)
+	{
+		return;
+	}
+
+	m_bBaseInstance = (GLEW_VERSION_4_2 || GLEW_ARB_base_instance);
+
+	glGenVertexArrays(1, &m_vertexArrayID);
+	glGenBuffers(1, &m_vertexBufferID);
+	glGenBuffers(1, &m_indexBufferID);
+
+	glBindVertexArray(m_vertexArrayID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+
+	glVertexAttribPointer(g_PositionLocation, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+	glEnableVertexAttribArray(g_PositionLocation);
+	glVertexAttribPointer(g_NormalLocation, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(GLfloat) * 3));
+	glEnableVertexAttribArray(g_NormalLocation);
+	glVertexAttribPointer(g_TextureCoordinateLocation, 2, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(GLfloat) * 6));
+	glEnableVertexAttribArray(g_TextureCoordinateLocation);
+
+	// the per-instance attributes advance once per instance
+	for (GLuint location = g_InstanceModelLocation; location <= g_InstanceIndicesLocation; location++)
+	{
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisor(location, 1);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for appending the generated vertices
+ *  and indices of a mesh to the shared geometry, recording
+ *  its range, and uploading the shared buffers again.  The
+ *  indices stay relative to the first vertex of the mesh,
+ *  which is passed as the base vertex when drawing.  A mesh
+ *  that is already loaded is not added again.
+ ***********************************************************/
+void PrimitiveMeshes::AddMesh(
+	MESH_KIND kind,
+	int lodLevel,
+	const std::vector<GLfloat>& vertices,
+	const std::vector<GLuint>& indices)
+{
+	MESH_RANGE& range = m_meshRanges[kind][lodLevel];
+	if (range.indexCount > 0)
+	{
+		return;
+	}
+
+	CreateVertexArray();
+	TrackBufferSizes(false);
+
+	range.baseVertex = (GLint)(m_vertices.size() / g_FloatsPerVertex);
+	range.firstIndex = (GLuint)m_indices.size();
+	range.indexCount = (GLuint)indices.size();
+	m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+	m_indices.insert(m_indices.end(), indices.begin(), indices.end());
+
+	// the index buffer binding is part of the vertex array
+	glBindVertexArray(m_vertexArrayID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * m_vertices.size(), m_vertices.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * m_indices.size(), m_indices.data(), GL_STATIC_DRAW);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	TrackBufferSizes(true);
+}
+
+/***********************************************************
+ *  TrackBufferSizes()
+ *
+ *  This method is used for adding the sizes of the shared
+ *  vertex and index buffers to the memory tracker, or for
+ *  removing them before the buffers are replaced or freed.
+ *  The sizes are those of the kept geometry, which is what
+ *  the buffers hold.
+ ***********************************************************/
+void PrimitiveMeshes::TrackBufferSizes(bool bAllocate)
+{
+	if (NULL == m_pMemoryTracker)
+	{
+		return;
+	}
+
+	size_t vertexBytes = sizeof(GLfloat) * m_vertices.size();
+	size_t indexBytes = sizeof(GLuint) * m_indices.size();
+	if (bAllocate == true)
+	{
+		m_pMemoryTracker->Allocate(GpuMemoryTracker::MEMORY_VERTEX_BUFFERS, vertexBytes);
+		m_pMemoryTracker->Allocate(GpuMemoryTracker::MEMORY_INDEX_BUFFERS, indexBytes);
+	}
+	else
+	{
+		m_pMemoryTracker->Release(GpuMemoryTracker::MEMORY_VERTEX_BUFFERS, vertexBytes);
+		m_pMemoryTracker->Release(GpuMemoryTracker::MEMORY_INDEX_BUFFERS, indexBytes);
+	}
+}
+
+/***********************************************************
+ *  ShareFirstLevel()
+ *
+ *  This method is used for drawing a mesh that has a single
+ *  level of detail the same at every level.
+ ***********************************************************/
+void PrimitiveMeshes::ShareFirstLevel(MESH_KIND kind)
+{
+	for (int level = 1; level < LOD_LEVELS; level++)
+	{
+		m_meshRanges[kind][level] = m_meshRanges[kind][0];
+	}
+}
+
+/***********************************************************
+ *  SetInstancePointers()
+ *
+ *  This method is used for pointing the per-instance
+ *  attributes of the bound vertex array at the passed in
+ *  offset into the bound instance buffer.
+ ***********************************************************/
+void PrimitiveMeshes::SetInstancePointers(size_t offset)
+{
+	GLsizei stride = sizeof(INSTANCE_DATA);
+
+	// a matrix attribute takes one location per column
+	for (GLuint column = 0; column < 4; column++)
+	{
+		glVertexAttribPointer(g_InstanceModelLocation + column, 4, GL_FLOAT, GL_FALSE, stride,
+			(void*)(offset + offsetof(INSTANCE_DATA, modelMatrix) + sizeof(glm::vec4) * column));
+	}
+	glVertexAttribPointer(g_InstanceUVscaleLocation, 2, GL_FLOAT, GL_FALSE, stride,
+		(void*)(offset + offsetof(INSTANCE_DATA, UVscale)));
+	glVertexAttribIPointer(g_InstanceIndicesLocation, 2, GL_INT, stride,
+		(void*)(offset + offsetof(INSTANCE_DATA, materialIndex)));
+}
+
+/***********************************************************
+ *  LoadPlaneMesh()
+ *
+ *  This method is used for generating a flat plane in the
+ *  XZ plane from -1 to 1, facing up.
+ ***********************************************************/
+void PrimitiveMeshes::LoadPlaneMesh()
+{
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+
+	AddQuad(vertices, indices, glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+
+	AddMesh(MESH_KIND_PLANE, 0, vertices, indices);
+	ShareFirstLevel(MESH_KIND_PLANE);
+}
+
+/***********************************************************
+ *  LoadBoxMesh()
+ *
+ *  This method is used for generating a 1x1x1 box centered
+ *  on the origin, with each face fully textured.
+ ***********************************************************/
+void PrimitiveMeshes::LoadBoxMesh()
+{
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+
+	glm::vec3 x(0.5f, 0.0f, 0.0f);
+	glm::vec3 y(0.0f, 0.5f, 0.0f);
+	glm::vec3 z(0.0f, 0.0f, 0.5f);
+
+	AddQuad(vertices, indices, z, x, y);	// front
+	AddQuad(vertices, indices, -z, -x, y);	// back
+	AddQuad(vertices, indices, x, -z, y);	// right
+	AddQuad(vertices, indices, -x, z, y);	// left
+	AddQuad(vertices, indices, y, x, -z);	// top
+	AddQuad(vertices, indices, -y, x, z);	// bottom
+
+	AddMesh(MESH_KIND_BOX, 0, vertices, indices);
+	ShareFirstLevel(MESH_KIND_BOX);
+}
+
+/***********************************************************
+ *  LoadCylinderMesh()
+ *
+ *  This method is used for generating a closed cylinder with
+ *  a radius of 1 that stands on the origin and is 1 tall,
+ *  at every level of detail.
+ ***********************************************************/
+void PrimitiveMeshes::LoadCylinderMesh()
+{
+	for (int level = 0; level < LOD_LEVELS; level++)
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+		int slices = g_RoundSlices[level];
+
+		for (int i = 0; i <= slices; i++)
+		{
+			float angle = 2.0f * g_Pi * i / slices;
+			glm::vec3 normal(cosf(angle), 0.0f, sinf(angle));
+			float u = (float)i / slices;
+
+			AddVertex(vertices, normal, normal, glm::vec2(u, 0.0f));
+			AddVertex(vertices, normal + glm::vec3(0.0f, 1.0f, 0.0f), normal, glm::vec2(u, 1.0f));
+		}
+
+		for (int i = 0; i < slices; i++)
+		{
+			GLuint bottom = i * 2;
+
+			indices.push_back(bottom);
+			indices.push_back(bottom + 1);
+			indices.push_back(bottom + 2);
+			indices.push_back(bottom + 2);
+			indices.push_back(bottom + 1);
+			indices.push_back(bottom + 3);
+		}
+
+		AddDisc(vertices, indices, 1.0f, true, slices);
+		AddDisc(vertices, indices, 0.0f, false, slices);
+
+		AddMesh(MESH_KIND_CYLINDER, level, vertices, indices);
+	}
+}
+
+/***********************************************************
+ *  LoadConeMesh()
+ *
+ *  This method is used for generating a closed cone with a
+ *  base radius of 1 on the origin and its tip at a height
+ *  of 1, at every level of detail.
+ ***********************************************************/
+void PrimitiveMeshes::LoadConeMesh()
+{
+	for (int level = 0; level < LOD_LEVELS; level++)
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+		int slices = g_RoundSlices[level];
+
+		for (int i = 0; i < slices; i++)
+		{
+			float angle = 2.0f * g_Pi * i / slices;
+			float nextAngle = 2.0f * g_Pi * (i + 1) / slices;
+			float middleAngle = (angle + nextAngle) * 0.5f;
+			GLuint first = (GLuint)(vertices.size() / g_FloatsPerVertex);
+
+			// the side slopes at 45 degrees, since radius and height are equal
+			glm::vec3 base(cosf(angle), 0.0f, sinf(angle));
+			glm::vec3 nextBase(cosf(nextAngle), 0.0f, sinf(nextAngle));
+			glm::vec3 tipNormal = glm::normalize(glm::vec3(cosf(middleAngle), 1.0f, sinf(middleAngle)));
+
+			AddVertex(vertices, base, glm::normalize(base + glm::vec3(0.0f, 1.0f, 0.0f)),
+				glm::vec2((float)i / slices, 0.0f));
+			AddVertex(vertices, glm::vec3(0.0f, 1.0f, 0.0f), tipNormal,
+				glm::vec2((i + 0.5f) / slices, 1.0f));
+			AddVertex(vertices, nextBase, glm::normalize(nextBase + glm::vec3(0.0f, 1.0f, 0.0f)),
+				glm::vec2((float)(i + 1) / slices, 0.0f));
+
+			indices.push_back(first);
+			indices.push_back(first + 1);
+			indices.push_back(first + 2);
+		}
+
+		AddDisc(vertices, indices, 0.0f, false, slices);
+
+		AddMesh(MESH_KIND_CONE, level, vertices, indices);
+	}
+}
+
+/***********************************************************
+ *  LoadSphereMesh()
+ *
+ *  This method is used for generating a sphere with a radius
+ *  of 1 centered on the origin, at every level of detail.
+ ***********************************************************/
+void PrimitiveMeshes::LoadSphereMesh()
+{
+	for (int level = 0; level < LOD_LEVELS; level++)
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+
+		AddSphereRings(vertices, indices, g_RoundSlices[level], g_SphereStacks[level], g_SphereStacks[level]);
+
+		AddMesh(MESH_KIND_SPHERE, level, vertices, indices);
+	}
+}
+
+/***********************************************************
+ *  LoadHalfSphereMesh()
+ *
+ *  This method is used for generating the upper half of a
+ *  sphere with a radius of 1, closed at the bottom, at
+ *  every level of detail.
+ ***********************************************************/
+void PrimitiveMeshes::LoadHalfSphereMesh()
+{
+	for (int level = 0; level < LOD_LEVELS; level++)
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+
+		AddSphereRings(vertices, indices, g_RoundSlices[level], g_SphereStacks[level], g_SphereStacks[level] / 2);
+		AddDisc(vertices, indices, 0.0f, false, g_RoundSlices[level]);
+
+		AddMesh(MESH_KIND_HALF_SPHERE, level, vertices, indices);
+	}
+}
+
+/***********************************************************
+ *  SetInstanceData()
+ *
+ *  This method is used for writing the passed in instances
+ *  into the next region of the instance ring buffer, so the
+ *  draws still reading the previous instances are never
+ *  waited for.  The instances start at a whole instance into
+ *  the buffer, and the draws add that base instance.  When
+ *  the ring buffer has grown, the per-instance attributes
+ *  are pointed at the new buffer.
+ ***********************************************************/
+void PrimitiveMeshes::SetInstanceData(const INSTANCE_DATA* pInstances, int instanceCount)
+{
+	size_t offset = 0;
+
+	CreateVertexArray();
+
+	// one extra instance leaves room for the alignment
+	m_pInstanceRing->BeginFrame(sizeof(INSTANCE_DATA) * (instanceCount + 1));
+	m_instanceBase = 0;
+	m_instanceCount = 0;
+	if (instanceCount > 0)
+	{
+		void* pData = m_pInstanceRing->Map(sizeof(INSTANCE_DATA) * instanceCount, sizeof(INSTANCE_DATA), offset);
+		if (NULL == pData)
+		{
+			return;
+		}
+		memcpy(pData, pInstances, sizeof(INSTANCE_DATA) * instanceCount);
+		m_pInstanceRing->Unmap();
+
+		m_instanceBase = (int)(offset / sizeof(INSTANCE_DATA));
+		m_instanceCount = instanceCount;
+	}
+
+	// a grown ring is a new buffer even when it reuses the name,
+	// and deleting the old one detached it from the vertex array
+	if (m_pInstanceRing->GetGeneration() != m_instancePointerGeneration)
+	{
+		m_instancePointerGeneration = m_pInstanceRing->GetGeneration();
+		m_instancePointerBufferID = m_pInstanceRing->GetBufferID();
+		glBindVertexArray(m_vertexArrayID);
+		glBindBuffer(GL_ARRAY_BUFFER, m_instancePointerBufferID);
+		SetInstancePointers(0);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+/***********************************************************
+ *  ClampLevel()
+ *
+ *  This method is used for limiting the passed in level of
+ *  detail to the generated levels.
+ ***********************************************************/
+int PrimitiveMeshes::ClampLevel(int lodLevel)
+{
+	if (lodLevel < 0)
+	{
+		return(0);
+	}
+	if (lodLevel >= LOD_LEVELS)
+	{
+		return(LOD_LEVELS - 1);
+	}
+	return(lodLevel);
+}
+
+/***********************************************************
+ *  BindGeometry()
+ *
+ *  This method is used for binding the vertex array shared
+ *  by all the meshes.  It is bound once before the draws of
+ *  a frame, and stays bound between them.
+ ***********************************************************/
+void PrimitiveMeshes::BindGeometry()
+{
+	CreateVertexArray();
+	glBindVertexArray(m_vertexArrayID);
+}
+
+/***********************************************************
+ *  GetMeshRange()
+ *
+ *  This method is used for getting the range of the shared
+ *  buffers holding the passed in mesh at the passed in level
+ *  of detail.
+ ***********************************************************/
+const PrimitiveMeshes::MESH_RANGE& PrimitiveMeshes::GetMeshRange(MESH_KIND kind, int lodLevel) const
+{
+	static const MESH_RANGE emptyRange = MESH_RANGE();
+
+	if ((kind < 0) || (kind >= MESH_KIND_COUNT))
+	{
+		return(emptyRange);
+	}
+
+	return(m_meshRanges[kind][ClampLevel(lodLevel)]);
+}
+
+/***********************************************************
+ *  DrawMeshInstanced()
+ *
+ *  This method is used for drawing all the instances of the
+ *  passed in mesh with one call, reading the per-instance
+ *  data from firstInstance on, after the base instance of
+ *  the written data.  When the driver cannot start a draw at
+ *  an instance, the per-instance attributes are pointed at
+ *  the first instance instead.
+ ***********************************************************/
+void PrimitiveMeshes::DrawMeshInstanced(
+	MESH_KIND kind,
+	int lodLevel,
+	int instanceCount,
+	int firstInstance)
+{
+	const MESH_RANGE& range = GetMeshRange(kind, lodLevel);
+
+	if ((0 == range.indexCount) || (instanceCount <= 0) ||
+		(firstInstance + instanceCount > m_instanceCount))
+	{
+		return;
+	}
+
+	void* pFirstIndex = (void*)(sizeof(GLuint) * range.firstIndex);
+	if (m_bBaseInstance == true)
+	{
+		glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT,
+			pFirstIndex, instanceCount, range.baseVertex, m_instanceBase + firstInstance);
+	}
+	else
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_instancePointerBufferID);
+		SetInstancePointers(sizeof(INSTANCE_DATA) * (m_instanceBase + firstInstance));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT,
+			pFirstIndex, instanceCount, range.baseVertex);
+	}
+
+	if (NULL != m_pRenderStats)
+	{
+		m_pRenderStats->CountDraw(range.indexCount / 3, instanceCount);
+	}
+}
+
+/***********************************************************
+ *  DrawPlaneMeshInstanced()
+ *
+ *  This method is used for drawing instances of the plane.
+ ***********************************************************/
+void PrimitiveMeshes::DrawPlaneMeshInstanced(int instanceCount, int firstInstance)
+{
+	DrawMeshInstanced(MESH_KIND_PLANE, 0, instanceCount, firstInstance);
+}
+
+/***********************************************************
+ *  DrawBoxMeshInstanced()
+ *
+ *  This method is used for drawing instances of the box.
+ ***********************************************************/
+void PrimitiveMeshes::DrawBoxMeshInstanced(int instanceCount, int firstInstance)
+{
+	DrawMeshInstanced(MESH_KIND_BOX, 0, instanceCount, firstInstance);
+}
+
+/***********************************************************
+ *  DrawCylinderMeshInstanced()
+ *
+ *  This method is used for drawing instances of the cylinder
+ *  at the passed in level of detail.
+ ***********************************************************/
+void PrimitiveMeshes::DrawCylinderMeshInstanced(int instanceCount, int firstInstance, int lodLevel)
+{
+	DrawMeshInstanced(MESH_KIND_CYLINDER, lodLevel, instanceCount, firstInstance);
+}
+
+/***********************************************************
+ *  DrawConeMeshInstanced()
+ *
+ *  This method is used for drawing instances of the cone at
+ *  the passed in level of detail.
+ ***********************************************************/
+void PrimitiveMeshes::DrawConeMeshInstanced(int instanceCount, int firstInstance, int lodLevel)
+{
+	DrawMeshInstanced(MESH_KIND_CONE, lodLevel, instanceCount, firstInstance);
+}
+
+/***********************************************************
+ *  DrawSphereMeshInstanced()
+ *
+ *  This method is used for drawing instances of the sphere
+ *  at the passed in level of detail.
+ ***********************************************************/
+void PrimitiveMeshes::DrawSphereMeshInstanced(int instanceCount, int firstInstance, int lodLevel)
+{
+	DrawMeshInstanced(MESH_KIND_SPHERE, lodLevel, instanceCount, firstInstance);
+}
+
+/***********************************************************
+ *  DrawHalfSphereMeshInstanced()
+ *
+ *  This method is used for drawing instances of the half
+ *  sphere at the passed in level of detail.
+ ***********************************************************/
+void PrimitiveMeshes::DrawHalfSphereMeshInstanced(int instanceCount, int firstInstance, int lodLevel)
+{
+	DrawMeshInstanced(MESH_KIND_HALF_SPHERE, lodLevel, instanceCount, firstInstance);
+}
+
+/***********************************************************
+ *  IsIndirectSupported()
+ *
+ *  This method is used for checking that the driver can
+ *  submit several draw commands from a buffer with one call,
+ *  each command starting at its own instance.
+ ***********************************************************/
+bool PrimitiveMeshes::IsIndirectSupported() const
+{
+	if ((GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect) && (m_bBaseInstance == true))
+	{
+		return(true);
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  SetDrawCommands()
+ *
+ *  This method is used for writing the passed in commands
+ *  into the next region of the command ring buffer.  The
+ *  base instance of the written instance data is added to
+ *  every command, so the instances must be written first.
+ ***********************************************************/
+void PrimitiveMeshes::SetDrawCommands(const DRAW_COMMAND* pCommands, int commandCount)
+{
+	m_drawCommands.assign(pCommands, pCommands + commandCount);
+	m_commandCount = 0;
+	if (IsIndirectSupported() == false)
+	{
+		return;
+	}
+
+	m_pCommandRing->BeginFrame(sizeof(DRAW_COMMAND) * (commandCount + 1));
+	if (commandCount > 0)
+	{
+		DRAW_COMMAND* pData = (DRAW_COMMAND*)m_pCommandRing->Map(
+			sizeof(DRAW_COMMAND) * commandCount, sizeof(DRAW_COMMAND), m_commandOffset);
+		if (NULL == pData)
+		{
+			return;
+		}
+		for (int i = 0; i < commandCount; i++)
+		{
+			pData[i] = pCommands[i];
+			pData[i].baseInstance += m_instanceBase;
+		}
+		m_pCommandRing->Unmap();
+		m_commandCount = commandCount;
+	}
+}
+
+/***********************************************************
+ *  DrawIndirect()
+ *
+ *  This method is used for drawing the passed in range of
+ *  the written commands with one call.  Each command reads
+ *  its instances from its base instance on, so the per-draw
+ *  model matrices, materials and texture layers come from
+ *  the instance buffer without any state change in between.
+ ***********************************************************/
+void PrimitiveMeshes::DrawIndirect(int firstCommand, int commandCount)
+{
+	if ((commandCount <= 0) || (firstCommand < 0) ||
+		(firstCommand + commandCount > m_commandCount) || (IsIndirectSupported() == false))
+	{
+		return;
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_pCommandRing->GetBufferID());
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+		(void*)(m_commandOffset + sizeof(DRAW_COMMAND) * firstCommand), commandCount, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	if (NULL != m_pRenderStats)
+	{
+		long long triangles = 0;
+		int instances = 0;
+		for (int i = firstCommand; i < firstCommand + commandCount; i++)
+		{
+			triangles += (long long)(m_drawCommands[i].indexCount / 3) * m_drawCommands[i].instanceCount;
+			instances += m_drawCommands[i].instanceCount;
+		}
+		m_pRenderStats->CountIndirectDraw(commandCount, triangles, instances);
+	}
+}
@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////
+// primitivemeshes.h
+// ============
+// generate the basic 3D shape meshes and draw them with per-instance data
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderStats.h"
+#include "RingBuffer.h"
+#include "GpuMemoryTracker.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  PrimitiveMeshes
+ *
+ *  This class generates the same basic shapes as the
+ *  ShapeMeshes class, with the same dimensions, but every
+ *  mesh is drawn instanced.  The model matrix, UV scale and
+ *  material and texture indices of each instance are read
+ *  from one shared per-instance attribute buffer, so any
+ *  number of copies of a mesh are drawn with one call.  The
+ *  instances and the indirect draw commands are streamed
+ *  through fenced ring buffers, so writing the next frame
+ *  never waits for the draws of the previous ones.
+ *  The round meshes are generated at several levels of
+ *  detail, level 0 being the finest.  All the meshes are
+ *  packed into one shared vertex and index buffer behind a
+ *  single vertex array, each mesh being a range of them, so
+ *  any mesh is drawn without binding another vertex array.
+ ***********************************************************/
+class PrimitiveMeshes
+{
+public:
+	// constructor - the buffers are counted in the memory
+	// tracker, when there is one
+	PrimitiveMeshes(RenderStats* pRenderStats = NULL, GpuMemoryTracker* pMemoryTracker = NULL);
+	// destructor
+	~PrimitiveMeshes();
+
+	// number of levels of detail of the round meshes
+	static const int LOD_LEVELS = 3;
+
+	// per-instance vertex attributes, read at locations 3 to 8
+	struct INSTANCE_DATA
+	{
+		glm::mat4 modelMatrix;
+		glm::vec2 UVscale;
+		GLint materialIndex;
+		GLint textureIndex;
+	};
+
+	// the generated meshes, in the same order as the mesh
+	// identifiers of the scene manager
+	enum MESH_KIND
+	{
+		MESH_KIND_PLANE = 0,
+		MESH_KIND_BOX,
+		MESH_KIND_CYLINDER,
+		MESH_KIND_CONE,
+		MESH_KIND_SPHERE,
+		MESH_KIND_HALF_SPHERE,
+		MESH_KIND_COUNT
+	};
+
+	// range of the shared buffers holding one mesh - the index
+	// count is 0 while the mesh is not loaded
+	struct MESH_RANGE
+	{
+		GLint baseVertex;
+		GLuint firstIndex;
+		GLuint indexCount;
+	};
+
+	// one command of an indirect draw, laid out as the driver
+	// reads it from the draw indirect buffer
+	struct DRAW_COMMAND
+	{
+		GLuint indexCount;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	// generate the mesh geometry into OpenGL buffers
+	void LoadPlaneMesh();
+	void LoadBoxMesh();
+	void LoadCylinderMesh();
+	void LoadConeMesh();
+	void LoadSphereMesh();
+	void LoadHalfSphereMesh();
+
+	// write the per-instance data used by the next draws
+	void SetInstanceData(const INSTANCE_DATA* pInstances, int instanceCount);
+
+	// bind the shared vertex array, which the draws below need
+	void BindGeometry();
+	// get the range of a mesh at a level of detail
+	const MESH_RANGE& GetMeshRange(MESH_KIND kind, int lodLevel = 0) const;
+
+	// draw the instances starting at firstInstance in the
+	// per-instance data with a single draw call
+	void DrawMeshInstanced(MESH_KIND kind, int lodLevel, int instanceCount, int firstInstance);
+
+	// true when the driver can draw a list of commands with
+	// one indirect call
+	bool IsIndirectSupported() const;
+	// write the commands used by the next indirect draws
+	void SetDrawCommands(const DRAW_COMMAND* pCommands, int commandCount);
+	// draw a range of the written commands with one call
+	void DrawIndirect(int firstCommand, int commandCount);
+	void DrawPlaneMeshInstanced(int instanceCount, int firstInstance = 0);
+	void DrawBoxMeshInstanced(int instanceCount, int firstInstance = 0);
+	void DrawCylinderMeshInstanced(int instanceCount, int firstInstance = 0, int lodLevel = 0);
+	void DrawConeMeshInstanced(int instanceCount, int firstInstance = 0, int lodLevel = 0);
+	void DrawSphereMeshInstanced(int instanceCount, int firstInstance = 0, int lodLevel = 0);
+	void DrawHalfSphereMeshInstanced(int instanceCount, int firstInstance = 0, int lodLevel = 0);
+
+private:
+	// range of every mesh at every level of detail - the
+	// meshes without levels use the same range for all of them
+	MESH_RANGE m_meshRanges[MESH_KIND_COUNT][LOD_LEVELS];
+	// geometry of all the loaded meshes, kept to upload the
+	// shared buffers again when a mesh is added
+	std::vector<GLfloat> m_vertices;
+	std::vector<GLuint> m_indices;
+	// shared vertex array and buffers of all the meshes
+	GLuint m_vertexArrayID;
+	GLuint m_vertexBufferID;
+	GLuint m_indexBufferID;
+
+	// counters of the draw calls, not owned and may be NULL
+	RenderStats* m_pRenderStats;
+	// tracker of the GPU memory of the buffers, not owned and
+	// may be NULL
+	GpuMemoryTracker* m_pMemoryTracker;
+	// ring buffer the per-instance attributes are streamed
+	// through, and the buffer the attributes point at
+	RingBuffer* m_pInstanceRing;
+	GLuint m_instancePointerBufferID;
+	// generation of the ring buffer the attributes point at
+	unsigned int m_instancePointerGeneration;
+	// first instance of the written data in the ring buffer,
+	// and the number of written instances
+	int m_instanceBase;
+	int m_instanceCount;
+	// true when a draw can start at any instance, so the
+	// per-instance attribute pointers never move
+	bool m_bBaseInstance;
+	// ring buffer the indirect draw commands are streamed
+	// through, the offset and number of the written commands,
+	// and the commands kept for counting the submitted work
+	RingBuffer* m_pCommandRing;
+	size_t m_commandOffset;
+	int m_commandCount;
+	std::vector<DRAW_COMMAND> m_drawCommands;
+
+	// create the shared vertex array and buffers
+	void CreateVertexArray();
+	// count the sizes of the shared buffers in the tracker, or
+	// stop counting them
+	void TrackBufferSizes(bool bAllocate);
+	// append the generated geometry of a mesh to the shared
+	// buffers and upload them
+	void AddMesh(
+		MESH_KIND kind,
+		int lodLevel,
+		const std::vector<GLfloat>& vertices,
+		const std::vector<GLuint>& indices);
+	// use the range of level 0 for all the levels of a mesh
+	void ShareFirstLevel(MESH_KIND kind);
+	// point the per-instance attributes at the passed in
+	// offset into the instance buffer
+	void SetInstancePointers(size_t offset);
+	// limit a level of detail to the generated levels
+	static int ClampLevel(int lodLevel);
+};
@@ -0,0 +1,436 @@
+///////////////////////////////////////////////////////////////////////////////
+// programcache.cpp
+// ============
+// keep the binaries of the linked shader programs on disk
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ProgramCache.h"
+
+#include "MappedFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of the global variables and defines
+namespace
+{
+	// changing the layout of the cache files must change this,
+	// so that the entries written before are not used
+	const unsigned long long g_CacheVersion = 1;
+	const unsigned int g_CacheMagic = 0x42504C47;	// "GLPB"
+
+	// layout of the start of a cache file, which is followed by
+	// the program binary
+	struct CACHE_FILE_HEADER
+	{
+		unsigned int magic;
+		unsigned int binaryFormat;
+		unsigned long long key;
+		unsigned long long binarySize;
+	};
+
+	/***********************************************************
+	 *  HashString()
+	 *
+	 *  This function is used for adding the passed in text to
+	 *  a 64 bit FNV-1a hash, followed by a zero byte so that
+	 *  the texts of a key cannot run into each other.
+	 ***********************************************************/
+	unsigned long long HashString(unsigned long long hash, const char* pText)
+	{
+		if (NULL != pText)
+		{
+			for (const char* pByte = pText; *pByte != '\0'; pByte++)
+			{
+				hash ^= (unsigned char)*pByte;
+				hash *= 1099511628211ULL;
+			}
+		}
+		hash *= 1099511628211ULL;
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  ReadSourceFile()
+	 *
+	 *  This function is used for reading the whole of the
+	 *  passed in shader file into the passed in string.
+	 ***********************************************************/
+	bool ReadSourceFile(const char* filename, std::string& source)
+	{
+		std::ifstream sourceFile(filename, std::ios::binary);
+		if (!sourceFile)
+		{
+			std::cout << "Could not open shader file:" << filename << std::endl;
+			return(false);
+		}
+		source.assign((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+		return(true);
+	}
+
+	/***********************************************************
+	 *  InsertDefines()
+	 *
+	 *  This function is used for adding the passed in #define
+	 *  lines to a shader source, after its #version line, which
+	 *  must come first.  A #line directive follows them, so the
+	 *  compile errors keep the line numbers of the file.
+	 ***********************************************************/
+	void InsertDefines(std::string& source, const std::string& defines)
+	{
+		if (defines.length() == 0)
+		{
+			return;
+		}
+
+		size_t insertAt = 0;
+		std::string lineDirective = "#line 1\n";
+		if (source.compare(0, 8, "#version") == 0)
+		{
+			insertAt = source.find('\n');
+			if (insertAt == std::string::npos)
+			{
+				source += '\n';
+				insertAt = source.length() - 1;
+			}
+			insertAt++;
+			lineDirective = "#line 2\n";
+		}
+		source.insert(insertAt, defines + lineDirective);
+	}
+
+	/***********************************************************
+	 *  CompileShader()
+	 *
+	 *  This function is used for compiling the passed in shader
+	 *  source, writing the compile log when it fails.
+	 ***********************************************************/
+	GLuint CompileShader(GLenum type, const std::string& source, const char* filename)
+	{
+		GLuint shaderID = glCreateShader(type);
+		const char* pSource = source.c_str();
+		GLint compileStatus = GL_FALSE;
+
+		glShaderSource(shaderID, 1, &pSource, NULL);
+		glCompileShader(shaderID);
+		glGetShaderiv(shaderID, GL_COMPILE_STATUS, &compileStatus);
+		if (compileStatus != GL_TRUE)
+		{
+			GLint logLength = 0;
+			glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &logLength);
+			std::vector<char> log(logLength + 1, '\0');
+			glGetShaderInfoLog(shaderID, logLength, NULL, log.data());
+			std::cout << "Could not compile shader file:" << filename << std::endl << log.data() << std::endl;
+			glDeleteShader(shaderID);
+			return(0);
+		}
+
+		return(shaderID);
+	}
+
+	/***********************************************************
+	 *  CreateCacheDirectory()
+	 *
+	 *  This function is used for creating the passed in
+	 *  directory if it does not exist yet.
+	 ***********************************************************/
+	void CreateCacheDirectory(const std::string& directory)
+	{
+#ifdef _WIN32
+		_mkdir(directory.c_str());
+#else
+		mkdir(directory.c_str(), 0755);
+#endif
+	}
+}
+
+/***********************************************************
+ *  ProgramCache()
+ *
+ *  The constructor for the class.  The driver is identified
+ *  here, so the OpenGL context must already exist.
+ ***********************************************************/
+ProgramCache::ProgramCache(const std::string& directory)
+{
+	GLint formatCount = 0;
+
+	m_directory = directory;
+	m_driverHash = 14695981039346656037ULL ^ g_CacheVersion;
+	m_driverHash = HashString(m_driverHash, (const char*)glGetString(GL_VENDOR));
+	m_driverHash = HashString(m_driverHash, (const char*)glGetString(GL_RENDERER));
+	m_driverHash = HashString(m_driverHash, (const char*)glGetString(GL_VERSION));
+
+	// a driver may support program binaries in no format at all
+	m_bSupported = false;
+	if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+	{
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+		m_bSupported = (formatCount > 0);
+	}
+	if (m_bSupported == true)
+	{
+		CreateCacheDirectory(m_directory);
+	}
+}
+
+/***********************************************************
+ *  ~ProgramCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ProgramCache::~ProgramCache()
+{
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for loading the linked program of the
+ *  passed in shader files, built with the passed in #define
+ *  lines.  The cache entry is found from the hash of both
+ *  shader sources with the defines and the driver, and is
+ *  written after compiling the sources when there is none or
+ *  the driver rejects it.  A small index file named after the
+ *  shader files and the defines holds the name of the latest
+ *  entry, so the entry it replaces is removed.  The returned
+ *  program must be deleted by the caller.
+ ***********************************************************/
+GLuint ProgramCache::Load(
+	const char* vertexShaderFilename,
+	const char* fragmentShaderFilename,
+	const std::string& defines)
+{
+	std::string vertexSource;
+	std::string fragmentSource;
+	GLuint programID = 0;
+
+	if ((ReadSourceFile(vertexShaderFilename, vertexSource) == false) ||
+		(ReadSourceFile(fragmentShaderFilename, fragmentSource) == false))
+	{
+		return(0);
+	}
+	InsertDefines(vertexSource, defines);
+	InsertDefines(fragmentSource, defines);
+
+	if (m_bSupported == false)
+	{
+		return(CompileProgram(vertexSource, fragmentSource, vertexShaderFilename, fragmentShaderFilename));
+	}
+
+	unsigned long long key = HashString(m_driverHash, vertexSource.c_str());
+	key = HashString(key, fragmentSource.c_str());
+
+	char hashName[32];
+	snprintf(hashName, sizeof(hashName), "%016llx", key);
+	std::string entryName = std::string(hashName) + ".bin";
+	std::string cacheFilename = m_directory + "/" + entryName;
+
+	// the program is identified by its files and defines only,
+	// which stay the same when the sources are edited
+	unsigned long long programHash = HashString(14695981039346656037ULL ^ g_CacheVersion, vertexShaderFilename);
+	programHash = HashString(programHash, fragmentShaderFilename);
+	programHash = HashString(programHash, defines.c_str());
+	snprintf(hashName, sizeof(hashName), "%016llx", programHash);
+	std::string indexFilename = m_directory + "/" + hashName + ".index";
+
+	programID = LoadCacheFile(cacheFilename, key);
+	if (0 != programID)
+	{
+		return(programID);
+	}
+
+	programID = CompileProgram(vertexSource, fragmentSource, vertexShaderFilename, fragmentShaderFilename);
+	if ((0 != programID) && (WriteCacheFile(cacheFilename, key, programID) == true))
+	{
+		ReplaceCacheEntry(indexFilename, entryName);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  LoadCacheFile()
+ *
+ *  This method is used for creating a program from the
+ *  binary in the passed in cache file.  A missing file, a
+ *  header that does not match the key, or a binary that does
+ *  not link with the current driver returns 0.
+ ***********************************************************/
+GLuint ProgramCache::LoadCacheFile(const std::string& filename, unsigned long long key)
+{
+	MappedFile cacheFile;
+	CACHE_FILE_HEADER header;
+	GLint linkStatus = GL_FALSE;
+
+	if ((cacheFile.Open(filename.c_str()) == false) || (cacheFile.GetSize() < sizeof(header)))
+	{
+		return(0);
+	}
+
+	memcpy(&header, cacheFile.GetData(), sizeof(header));
+	if ((header.magic != g_CacheMagic) || (header.key != key) ||
+		(header.binarySize != cacheFile.GetSize() - sizeof(header)))
+	{
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glProgramBinary(programID, header.binaryFormat, cacheFile.GetData() + sizeof(header), (GLsizei)header.binarySize);
+	glGetProgramiv(programID, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus != GL_TRUE)
+	{
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  WriteCacheFile()
+ *
+ *  This method is used for writing the binary of the passed
+ *  in linked program into the passed in cache file.  The
+ *  file is written under another name first, so a partly
+ *  written file is never read.  It returns false when no
+ *  file was written.
+ ***********************************************************/
+bool ProgramCache::WriteCacheFile(const std::string& filename, unsigned long long key, GLuint programID)
+{
+	GLint binarySize = 0;
+	GLenum binaryFormat = 0;
+
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+	if (binarySize <= 0)
+	{
+		return(false);
+	}
+
+	std::vector<unsigned char> binary(binarySize);
+	GLsizei writtenSize = 0;
+	glGetProgramBinary(programID, binarySize, &writtenSize, &binaryFormat, binary.data());
+	if (writtenSize <= 0)
+	{
+		return(false);
+	}
+
+	CACHE_FILE_HEADER header;
+	header.magic = g_CacheMagic;
+	header.binaryFormat = binaryFormat;
+	header.key = key;
+	header.binarySize = writtenSize;
+
+	std::string tempFilename = filename + ".tmp";
+	std::ofstream cacheFile(tempFilename.c_str(), std::ios::binary);
+	if (cacheFile)
+	{
+		cacheFile.write((const char*)&header, sizeof(header));
+		cacheFile.write((const char*)binary.data(), writtenSize);
+		cacheFile.close();
+		// an existing entry the driver rejected is replaced
+		std::remove(filename.c_str());
+		if (!cacheFile || (std::rename(tempFilename.c_str(), filename.c_str()) != 0))
+		{
+			std::remove(tempFilename.c_str());
+			return(false);
+		}
+		return(true);
+	}
+
+	std::cout << "Could not write program cache file:" << filename << std::endl;
+	return(false);
+}
+
+/***********************************************************
+ *  ReplaceCacheEntry()
+ *
+ *  This method is used for writing the name of the passed in
+ *  entry into the index file of its program, after removing
+ *  the entry the index named before.  Entries written by
+ *  other drivers are removed the same way.
+ ***********************************************************/
+void ProgramCache::ReplaceCacheEntry(const std::string& indexFilename, const std::string& entryName)
+{
+	std::string previousName;
+	{
+		std::ifstream indexFile(indexFilename.c_str());
+		std::getline(indexFile, previousName);
+	}
+
+	if (previousName == entryName)
+	{
+		return;
+	}
+	// only a name written by this class is removed
+	if ((previousName.length() > 0) && (previousName.find_first_of("/\\") == std::string::npos))
+	{
+		std::remove((m_directory + "/" + previousName).c_str());
+	}
+
+	std::ofstream indexFile(indexFilename.c_str());
+	indexFile << entryName << "\n";
+}
+
+/***********************************************************
+ *  CompileProgram()
+ *
+ *  This method is used for compiling the passed in shader
+ *  sources and linking them into a program, writing the
+ *  logs when either step fails.  When binaries are supported
+ *  the driver is told the binary will be read back.
+ ***********************************************************/
+GLuint ProgramCache::CompileProgram(
+	const std::string& vertexSource,
+	const std::string& fragmentSource,
+	const char* vertexShaderFilename,
+	const char* fragmentShaderFilename)
+{
+	GLint linkStatus = GL_FALSE;
+
+	GLuint vertexShaderID = CompileShader(GL_VERTEX_SHADER, vertexSource, vertexShaderFilename);
+	GLuint fragmentShaderID = CompileShader(GL_FRAGMENT_SHADER, fragmentSource, fragmentShaderFilename);
+	if ((0 == vertexShaderID) || (0 == fragmentShaderID))
+	{
+		glDeleteShader(vertexShaderID);
+		glDeleteShader(fragmentShaderID);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	if (m_bSupported == true)
+	{
+		glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glAttachShader(programID, vertexShaderID);
+	glAttachShader(programID, fragmentShaderID);
+	glLinkProgram(programID);
+	glDetachShader(programID, vertexShaderID);
+	glDetachShader(programID, fragmentShaderID);
+	glDeleteShader(vertexShaderID);
+	glDeleteShader(fragmentShaderID);
+
+	glGetProgramiv(programID, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus != GL_TRUE)
+	{
+		GLint logLength = 0;
+		glGetProgramiv(programID, GL_INFO_LOG_LENGTH, &logLength);
+		std::vector<char> log(logLength + 1, '\0');
+		glGetProgramInfoLog(programID, logLength, NULL, log.data());
+		std::cout << "Could not link shader files:" << vertexShaderFilename << ", " <<
+			fragmentShaderFilename << std::endl << log.data() << std::endl;
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	return(programID);
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+// programcache.h
+// ============
+// keep the binaries of the linked shader programs on disk
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+
+/***********************************************************
+ *  ProgramCache
+ *
+ *  This class compiles and links shader programs from their
+ *  source files, and keeps a copy of each linked program as
+ *  a driver binary on disk.  The files are named after a
+ *  hash of the shader sources and the vendor, renderer and
+ *  version of the driver, so a changed shader or driver gets
+ *  a new entry.  Variants of a program are built from the
+ *  same files with #define lines added after the #version
+ *  line of both shaders.  Each pair of shader files and set
+ *  of defines keeps only its latest entry, so editing the
+ *  shaders does not grow the cache.  A binary the driver no
+ *  longer accepts is replaced by compiling the sources again.
+ *  Without driver support for program binaries, every
+ *  program is compiled.
+ *  The OpenGL context must exist when the cache is created.
+ ***********************************************************/
+class ProgramCache
+{
+public:
+	// constructor
+	ProgramCache(const std::string& directory);
+	// destructor
+	~ProgramCache();
+
+	// load the linked program of the passed in shader files
+	// with the passed in #define lines, from its cache entry if
+	// there is one - it returns 0 when the shaders could not be
+	// read, compiled or linked
+	GLuint Load(
+		const char* vertexShaderFilename,
+		const char* fragmentShaderFilename,
+		const std::string& defines = std::string());
+
+	// check whether the driver can save and load program binaries
+	bool IsSupported() const { return(m_bSupported); }
+
+private:
+	// directory holding the cache files
+	std::string m_directory;
+	// hash of the driver that built the binaries
+	unsigned long long m_driverHash;
+	bool m_bSupported;
+
+	// create a program from the cache file with the passed in key
+	GLuint LoadCacheFile(const std::string& filename, unsigned long long key);
+	// write the binary of the passed in program into a cache file
+	bool WriteCacheFile(const std::string& filename, unsigned long long key, GLuint programID);
+	// record the passed in entry as the latest one of a program,
+	// removing the entry it replaces
+	void ReplaceCacheEntry(const std::string& indexFilename, const std::string& entryName);
+	// compile and link the passed in shader sources
+	GLuint CompileProgram(
+		const std::string& vertexSource,
+		const std::string& fragmentSource,
+		const char* vertexShaderFilename,
+		const char* fragmentShaderFilename);
+
+	// the cache cannot be shared between objects
+	ProgramCache(const ProgramCache&);
+	ProgramCache& operator=(const ProgramCache&);
+};
@@ -0,0 +1,31 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderstats.cpp
+// ============
+// count the rendering work submitted in every frame
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderStats.h"
+
+/***********************************************************
+ *  RenderStats()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderStats::RenderStats()
+{
+	m_frameStats = FRAME_STATS();
+	m_lastFrameStats = FRAME_STATS();
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for keeping the counters of the
+ *  finished frame and resetting the counters for the next.
+ ***********************************************************/
+void RenderStats::BeginFrame()
+{
+	m_lastFrameStats = m_frameStats;
+	m_frameStats = FRAME_STATS();
+}
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderstats.h
+// ============
+// count the rendering work submitted in every frame
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  RenderStats
+ *
+ *  This class holds plain counters of the draw calls,
+ *  triangles, texture binds, uniform writes and tag lookups
+ *  of the current and the previous frame.  Counting is a
+ *  single increment, so the counters stay on in release
+ *  builds.  They are only written from the main thread.
+ ***********************************************************/
+class RenderStats
+{
+public:
+	// constructor
+	RenderStats();
+
+	// counters of one frame
+	struct FRAME_STATS
+	{
+		int drawCalls;
+		// draws read from an indirect buffer, part of one call each
+		int indirectCommands;
+		int instancesDrawn;
+		long long trianglesSubmitted;
+		int textureBinds;
+		int uniformWrites;
+		int uniformWritesSkipped;
+		int materialLookups;
+		int textureLookups;
+	};
+
+	// keep the counters of the finished frame and start from zero
+	void BeginFrame();
+
+	// count one instanced draw call
+	void CountDraw(int triangles, int instances)
+	{
+		m_frameStats.drawCalls++;
+		m_frameStats.instancesDrawn += instances;
+		m_frameStats.trianglesSubmitted += (long long)triangles * instances;
+	}
+	// count one indirect call drawing several commands
+	void CountIndirectDraw(int commands, long long triangles, int instances)
+	{
+		m_frameStats.drawCalls++;
+		m_frameStats.indirectCommands += commands;
+		m_frameStats.instancesDrawn += instances;
+		m_frameStats.trianglesSubmitted += triangles;
+	}
+	void CountTextureBind() { m_frameStats.textureBinds++; }
+	void CountMaterialLookup() { m_frameStats.materialLookups++; }
+	void CountTextureLookup() { m_frameStats.textureLookups++; }
+	// add the uniform writes counted by the shader state cache
+	void AddUniformWrites(int issued, int skipped)
+	{
+		m_frameStats.uniformWrites += issued;
+		m_frameStats.uniformWritesSkipped += skipped;
+	}
+
+	// get the counters of the current and previous frame
+	const FRAME_STATS& GetFrameStats() const { return(m_frameStats); }
+	const FRAME_STATS& GetLastFrameStats() const { return(m_lastFrameStats); }
+
+private:
+	FRAME_STATS m_frameStats;
+	FRAME_STATS m_lastFrameStats;
+};
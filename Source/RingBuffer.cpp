@@ -0,0 +1,277 @@
+///////////////////////////////////////////////////////////////////////////////
+// ringbuffer.cpp
+// ============
+// stream per-frame data through a fenced, persistently mapped buffer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RingBuffer.h"
+
+#include "GpuMemoryTracker.h"
+
+#include <algorithm>
+#include <iostream>
+
+// declaration of the global variables and defines
+namespace
+{
+	// smallest region that is created, so small frames do not
+	// grow the buffer several times
+	const size_t g_MinimumRegionSize = 4096;
+	// time waited for a fence before checking it again, in
+	// nanoseconds
+	const GLuint64 g_FenceTimeout = 1000000;
+
+	/***********************************************************
+	 *  AlignUp()
+	 *
+	 *  This function is used for rounding the passed in value
+	 *  up to a multiple of the alignment, which does not have to
+	 *  be a power of two.
+	 ***********************************************************/
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		if (alignment <= 1)
+		{
+			return(value);
+		}
+		return(((value + alignment - 1) / alignment) * alignment);
+	}
+}
+
+/***********************************************************
+ *  RingBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RingBuffer::RingBuffer(GpuMemoryTracker* pMemoryTracker)
+{
+	m_pMemoryTracker = pMemoryTracker;
+	m_bufferID = 0;
+	m_regionSize = 0;
+	m_generation = 0;
+	m_region = 0;
+	m_regionUsed = 0;
+	m_pMapped = NULL;
+	m_bPersistent = false;
+	m_bRangeMapped = false;
+	for (int i = 0; i < REGION_COUNT; i++)
+	{
+		m_fences[i] = NULL;
+	}
+}
+
+/***********************************************************
+ *  ~RingBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RingBuffer::~RingBuffer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the buffer with three
+ *  regions of the passed in size.  When the driver supports
+ *  buffer storage, the buffer is mapped once for writing and
+ *  stays mapped until it is destroyed.
+ ***********************************************************/
+void RingBuffer::Create(size_t regionSize)
+{
+	Destroy();
+
+	m_regionSize = std::max(regionSize, g_MinimumRegionSize);
+	size_t bufferSize = m_regionSize * REGION_COUNT;
+
+	glGenBuffers(1, &m_bufferID);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_bufferID);
+	if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, bufferSize, NULL, flags);
+		m_pMapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, bufferSize, flags);
+		m_bPersistent = (NULL != m_pMapped);
+	}
+	if (m_bPersistent == false)
+	{
+		// a buffer made with buffer storage cannot be resized, so
+		// a failed mapping needs a new buffer
+		if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+		{
+			glDeleteBuffers(1, &m_bufferID);
+			glGenBuffers(1, &m_bufferID);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_bufferID);
+			std::cout << "Could not map the ring buffer persistently" << std::endl;
+		}
+		glBufferData(GL_COPY_WRITE_BUFFER, bufferSize, NULL, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (NULL != m_pMemoryTracker)
+	{
+		m_pMemoryTracker->Allocate(GpuMemoryTracker::MEMORY_STREAM_BUFFERS, bufferSize);
+	}
+
+	m_region = 0;
+	m_regionUsed = 0;
+	m_generation++;
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the buffer, once the GPU
+ *  has finished every command reading it.
+ ***********************************************************/
+void RingBuffer::Destroy()
+{
+	for (int i = 0; i < REGION_COUNT; i++)
+	{
+		WaitForRegion(i);
+	}
+
+	if (0 != m_bufferID)
+	{
+		if ((m_bPersistent == true) || (m_bRangeMapped == true))
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_bufferID);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &m_bufferID);
+		m_bufferID = 0;
+
+		if (NULL != m_pMemoryTracker)
+		{
+			m_pMemoryTracker->Release(GpuMemoryTracker::MEMORY_STREAM_BUFFERS, m_regionSize * REGION_COUNT);
+		}
+	}
+	m_pMapped = NULL;
+	m_bPersistent = false;
+	m_bRangeMapped = false;
+	m_regionSize = 0;
+	m_regionUsed = 0;
+}
+
+/***********************************************************
+ *  WaitForRegion()
+ *
+ *  This method is used for blocking until the fence of the
+ *  passed in region has been reached by the GPU.  The first
+ *  wait flushes the commands, so the fence is sure to be
+ *  reached.
+ ***********************************************************/
+void RingBuffer::WaitForRegion(int region)
+{
+	if (NULL == m_fences[region])
+	{
+		return;
+	}
+
+	while (true)
+	{
+		GLenum result = glClientWaitSync(m_fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceTimeout);
+		if ((result == GL_ALREADY_SIGNALED) || (result == GL_CONDITION_SATISFIED) || (result == GL_WAIT_FAILED))
+		{
+			break;
+		}
+	}
+
+	glDeleteSync(m_fences[region]);
+	m_fences[region] = NULL;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for moving on to the next region.  A
+ *  fence is placed after the commands issued so far, which
+ *  are the last ones reading the current region, and the
+ *  next region is only written once its own fence has been
+ *  reached.  Regions that are too small for the frame are
+ *  replaced by larger ones.
+ ***********************************************************/
+void RingBuffer::BeginFrame(size_t frameSize)
+{
+	Unmap();
+
+	if (0 != m_bufferID)
+	{
+		if (NULL != m_fences[m_region])
+		{
+			glDeleteSync(m_fences[m_region]);
+		}
+		m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	if (frameSize > m_regionSize)
+	{
+		Create(std::max(frameSize, m_regionSize * 2));
+	}
+
+	m_region = (m_region + 1) % REGION_COUNT;
+	WaitForRegion(m_region);
+	m_regionUsed = 0;
+}
+
+/***********************************************************
+ *  Map()
+ *
+ *  This method is used for reserving the next bytes of the
+ *  current region.  A persistently mapped buffer is written
+ *  in place, otherwise the reserved range is mapped without
+ *  waiting for the GPU until Unmap() is called.
+ ***********************************************************/
+void* RingBuffer::Map(size_t size, size_t alignment, size_t& offset)
+{
+	Unmap();
+	if (0 == m_bufferID)
+	{
+		return(NULL);
+	}
+
+	size_t regionStart = m_regionSize * m_region;
+	size_t start = AlignUp(regionStart + m_regionUsed, alignment);
+	if (start + size > regionStart + m_regionSize)
+	{
+		return(NULL);
+	}
+	m_regionUsed = start + size - regionStart;
+	offset = start;
+
+	if (m_bPersistent == true)
+	{
+		return(m_pMapped + start);
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_bufferID);
+	void* pData = glMapBufferRange(GL_COPY_WRITE_BUFFER, start, size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	m_bRangeMapped = (NULL != pData);
+
+	return(pData);
+}
+
+/***********************************************************
+ *  Unmap()
+ *
+ *  This method is used for finishing the writes into the
+ *  last reserved range.  A persistent mapping is coherent,
+ *  so it is left as it is.
+ ***********************************************************/
+void RingBuffer::Unmap()
+{
+	if (m_bRangeMapped == false)
+	{
+		return;
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_bufferID);
+	glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	m_bRangeMapped = false;
+}
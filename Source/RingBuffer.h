@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+// ringbuffer.h
+// ============
+// stream per-frame data through a fenced, persistently mapped buffer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+class GpuMemoryTracker;
+
+/***********************************************************
+ *  RingBuffer
+ *
+ *  This class owns one buffer object split into three
+ *  regions that are written in turn, one per frame, with a
+ *  bump allocator.  Before a region is written again, the
+ *  fence placed after the last commands reading it is
+ *  waited for, so the driver never has to stall or orphan
+ *  the buffer.  With OpenGL 4.4 the buffer is mapped once
+ *  with a persistent, coherent mapping and written in place.
+ *  Before that, each allocation maps its range without
+ *  synchronization, which the fences make safe as well.
+ ***********************************************************/
+class RingBuffer
+{
+public:
+	// constructor - the size of the buffer is counted as
+	// stream memory in the tracker, when there is one
+	RingBuffer(GpuMemoryTracker* pMemoryTracker = NULL);
+	// destructor
+	~RingBuffer();
+
+	// number of regions, so the CPU can write one frame while
+	// the GPU still reads the two before it
+	static const int REGION_COUNT = 3;
+
+	// start writing a frame of at most frameSize bytes,
+	// including the padding of the alignments, into the next
+	// region - the regions grow when they are too small
+	void BeginFrame(size_t frameSize);
+	// reserve size bytes of the frame at an offset that is a
+	// multiple of alignment, returning where to write them and
+	// their offset into the buffer, or NULL when the frame is
+	// full
+	void* Map(size_t size, size_t alignment, size_t& offset);
+	// finish writing the last reserved bytes
+	void Unmap();
+
+	// get the buffer object, which is replaced when it grows
+	GLuint GetBufferID() const { return(m_bufferID); }
+	// get the number of times the buffer was created - OpenGL
+	// can give a replaced buffer its old name again, so users
+	// holding on to the buffer compare this instead of the name
+	unsigned int GetGeneration() const { return(m_generation); }
+	// check whether the buffer is persistently mapped
+	bool IsPersistent() const { return(m_bPersistent); }
+
+private:
+	// OpenGL buffer object and the size of each region
+	GLuint m_bufferID;
+	size_t m_regionSize;
+	// bumped every time the buffer is created
+	unsigned int m_generation;
+	// region of the current frame and the bytes used in it
+	int m_region;
+	size_t m_regionUsed;
+	// persistent mapping of the whole buffer, or NULL
+	unsigned char* m_pMapped;
+	bool m_bPersistent;
+	// true while an allocation is mapped without persistence
+	bool m_bRangeMapped;
+	// fence after the last commands reading each region
+	GLsync m_fences[REGION_COUNT];
+	// tracker of the GPU memory, or NULL
+	GpuMemoryTracker* m_pMemoryTracker;
+
+	// create the buffer with regions of the passed in size
+	void Create(size_t regionSize);
+	// free the buffer after the GPU is done with it
+	void Destroy();
+	// block until the GPU is done reading the passed in region
+	void WaitForRegion(int region);
+
+	// the buffer cannot be shared between objects
+	RingBuffer(const RingBuffer&);
+	RingBuffer& operator=(const RingBuffer&);
+};
@@ -0,0 +1,558 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// load scene descriptions from text files and their compiled binary form
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+// declaration of the global variables and defines
+namespace
+{
+	// changing the layout of the records must change this, so
+	// that the binary files written before are compiled again
+	const unsigned int g_SceneVersion = 2;
+	const unsigned int g_SceneMagic = 0x4E435353;	// "SSCN"
+	const char* g_CompiledExtension = ".bin";
+
+	// names of the meshes in the text file, by mesh identifier
+	const char* g_MeshNames[SceneFile::SCENE_MESH_COUNT] =
+	{
+		"plane",
+		"box",
+		"cylinder",
+		"cone",
+		"sphere",
+		"half_sphere"
+	};
+
+	/***********************************************************
+	 *  HashBytes()
+	 *
+	 *  This function is used for computing the 64 bit FNV-1a
+	 *  hash of the passed in bytes.
+	 ***********************************************************/
+	unsigned long long HashBytes(const std::vector<unsigned char>& bytes)
+	{
+		unsigned long long hash = 14695981039346656037ULL ^ g_SceneVersion;
+		for (unsigned char byte : bytes)
+		{
+			hash ^= byte;
+			hash *= 1099511628211ULL;
+		}
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  ReadVec2() / ReadVec3()
+	 *
+	 *  These functions are used for reading two or three
+	 *  numbers from a line of the text file.
+	 ***********************************************************/
+	bool ReadVec2(std::istringstream& line, glm::vec2& value)
+	{
+		line >> value.x >> value.y;
+		return(!line.fail());
+	}
+
+	bool ReadVec3(std::istringstream& line, glm::vec3& value)
+	{
+		line >> value.x >> value.y >> value.z;
+		return(!line.fail());
+	}
+
+	/***********************************************************
+	 *  CopyName()
+	 *
+	 *  This function is used for copying a tag or filename into
+	 *  its fixed size record field, failing when it is too long.
+	 ***********************************************************/
+	bool CopyName(const std::string& name, char* pField, int fieldLength)
+	{
+		if ((name.length() == 0) || ((int)name.length() >= fieldLength))
+		{
+			return(false);
+		}
+
+		memset(pField, 0, fieldLength);
+		memcpy(pField, name.c_str(), name.length());
+		return(true);
+	}
+
+	/***********************************************************
+	 *  AppendRecords()
+	 *
+	 *  This function is used for appending an array of records
+	 *  to the binary scene, returning the offset it starts at.
+	 ***********************************************************/
+	template <typename T>
+	unsigned int AppendRecords(std::vector<unsigned char>& binary, const std::vector<T>& records)
+	{
+		unsigned int offset = (unsigned int)binary.size();
+		if (records.size() > 0)
+		{
+			binary.resize(binary.size() + records.size() * sizeof(T));
+			memcpy(binary.data() + offset, records.data(), records.size() * sizeof(T));
+		}
+		return(offset);
+	}
+
+	/***********************************************************
+	 *  IsRangeInside()
+	 *
+	 *  This function is used for checking that an array of
+	 *  records lies inside a binary scene of the passed in size.
+	 ***********************************************************/
+	bool IsRangeInside(unsigned int offset, unsigned int count, size_t recordSize, size_t size)
+	{
+		if ((offset > size) || ((offset % 4) != 0))
+		{
+			return(false);
+		}
+		return(count <= (size - offset) / recordSize);
+	}
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+	m_pTextures = NULL;
+	m_pMaterials = NULL;
+	m_pLights = NULL;
+	m_pObjects = NULL;
+	m_textureCount = 0;
+	m_materialCount = 0;
+	m_lightCount = 0;
+	m_objectCount = 0;
+}
+
+/***********************************************************
+ *  ~SceneFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneFile::~SceneFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for loading the scene text file at
+ *  the passed in path.  When the compiled binary file next
+ *  to it was built from the same text, it is mapped and used
+ *  in place.  Otherwise the text is compiled and the binary
+ *  file is written for the next time.
+ ***********************************************************/
+bool SceneFile::Load(const char* filename)
+{
+	Close();
+
+	std::string compiledFilename = std::string(filename) + g_CompiledExtension;
+	std::ifstream sourceFile(filename, std::ios::binary);
+	if (!sourceFile)
+	{
+		// a compiled scene can be used without its text file
+		if ((m_file.Open(compiledFilename.c_str()) == true) &&
+			(Attach(m_file.GetData(), m_file.GetSize(), 0) == true))
+		{
+			return(true);
+		}
+
+		Close();
+		std::cout << "Could not open scene file:" << filename << std::endl;
+		return(false);
+	}
+	std::vector<unsigned char> source((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+	sourceFile.close();
+	unsigned long long sourceHash = HashBytes(source);
+
+	// use the compiled scene in place when it is up to date
+	if ((m_file.Open(compiledFilename.c_str()) == true) &&
+		(Attach(m_file.GetData(), m_file.GetSize(), sourceHash) == true))
+	{
+		std::cout << "Successfully loaded compiled scene:" << compiledFilename << ", objects:" << m_objectCount << std::endl;
+		return(true);
+	}
+	m_file.Close();
+
+	if (Compile(filename, source, sourceHash, m_buffer) == false)
+	{
+		Close();
+		return(false);
+	}
+
+	// write the compiled scene under a temporary name first, so
+	// a partly written file is never mapped
+	std::string tempFilename = compiledFilename + ".tmp";
+	std::ofstream compiledFile(tempFilename.c_str(), std::ios::binary);
+	if (compiledFile)
+	{
+		compiledFile.write((const char*)m_buffer.data(), m_buffer.size());
+		compiledFile.close();
+		std::remove(compiledFilename.c_str());
+		if (!compiledFile || (std::rename(tempFilename.c_str(), compiledFilename.c_str()) != 0))
+		{
+			std::remove(tempFilename.c_str());
+		}
+	}
+	else
+	{
+		std::cout << "Could not write compiled scene file:" << compiledFilename << std::endl;
+	}
+
+	Attach(m_buffer.data(), m_buffer.size(), sourceHash);
+	std::cout << "Successfully compiled scene:" << filename << ", objects:" << m_objectCount << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for releasing the loaded scene.
+ ***********************************************************/
+void SceneFile::Close()
+{
+	m_file.Close();
+	m_buffer.clear();
+	m_buffer.shrink_to_fit();
+
+	m_pTextures = NULL;
+	m_pMaterials = NULL;
+	m_pLights = NULL;
+	m_pObjects = NULL;
+	m_textureCount = 0;
+	m_materialCount = 0;
+	m_lightCount = 0;
+	m_objectCount = 0;
+}
+
+/***********************************************************
+ *  Attach()
+ *
+ *  This method is used for checking the header of the passed
+ *  in binary scene and pointing the record arrays into it.
+ *  Nothing is copied, so the data must stay valid while the
+ *  scene is loaded.
+ ***********************************************************/
+bool SceneFile::Attach(const unsigned char* pData, size_t size, unsigned long long sourceHash)
+{
+	if ((NULL == pData) || (size < sizeof(SCENE_HEADER)))
+	{
+		return(false);
+	}
+
+	const SCENE_HEADER* pHeader = (const SCENE_HEADER*)pData;
+	if ((pHeader->magic != g_SceneMagic) ||
+		(pHeader->version != g_SceneVersion) ||
+		((sourceHash != 0) && (pHeader->sourceHash != sourceHash)))
+	{
+		return(false);
+	}
+
+	if ((IsRangeInside(pHeader->textureOffset, pHeader->textureCount, sizeof(SCENE_TEXTURE), size) == false) ||
+		(IsRangeInside(pHeader->materialOffset, pHeader->materialCount, sizeof(SCENE_MATERIAL), size) == false) ||
+		(IsRangeInside(pHeader->lightOffset, pHeader->lightCount, sizeof(SCENE_LIGHT), size) == false) ||
+		(IsRangeInside(pHeader->objectOffset, pHeader->objectCount, sizeof(SCENE_OBJECT), size) == false))
+	{
+		return(false);
+	}
+
+	const SCENE_TEXTURE* pTextures = (const SCENE_TEXTURE*)(pData + pHeader->textureOffset);
+	const SCENE_MATERIAL* pMaterials = (const SCENE_MATERIAL*)(pData + pHeader->materialOffset);
+
+	// the names are used as strings, so they must be terminated
+	for (unsigned int i = 0; i < pHeader->textureCount; i++)
+	{
+		if ((pTextures[i].tag[MAX_TAG_LENGTH - 1] != 0) ||
+			(pTextures[i].filename[MAX_FILENAME_LENGTH - 1] != 0))
+		{
+			return(false);
+		}
+	}
+	for (unsigned int i = 0; i < pHeader->materialCount; i++)
+	{
+		if (pMaterials[i].tag[MAX_TAG_LENGTH - 1] != 0)
+		{
+			return(false);
+		}
+	}
+
+	m_pTextures = pTextures;
+	m_pMaterials = pMaterials;
+	m_pLights = (const SCENE_LIGHT*)(pData + pHeader->lightOffset);
+	m_pObjects = (const SCENE_OBJECT*)(pData + pHeader->objectOffset);
+	m_textureCount = (int)pHeader->textureCount;
+	m_materialCount = (int)pHeader->materialCount;
+	m_lightCount = (int)pHeader->lightCount;
+	m_objectCount = (int)pHeader->objectCount;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Compile()
+ *
+ *  This method is used for parsing the passed in scene text
+ *  into a binary scene.  Each line holds one entry, and text
+ *  after a # is ignored:
+ *
+ *    texture <tag> <filename>
+ *    material <tag> ambient r g b strength s diffuse r g b
+ *        specular r g b shininess s
+ *    light position x y z ambient r g b diffuse r g b
+ *        specular r g b focal f intensity i [range r]
+ *    object <mesh> scale x y z rotation x y z position x y z
+ *        texture <tag> uv u v material <tag> [transparent]
+ *
+ *  The values after the first word can be given in any order
+ *  and left out.  Textures and materials must be defined
+ *  before the objects using them.  An object without a
+ *  material, or with the material -, is stored with an index
+ *  of -1.
+ ***********************************************************/
+bool SceneFile::Compile(
+	const char* filename,
+	const std::vector<unsigned char>& source,
+	unsigned long long sourceHash,
+	std::vector<unsigned char>& binary)
+{
+	std::vector<SCENE_TEXTURE> textures;
+	std::vector<SCENE_MATERIAL> materials;
+	std::vector<SCENE_LIGHT> lights;
+	std::vector<SCENE_OBJECT> objects;
+	std::unordered_map<std::string, int> textureIndices;
+	std::unordered_map<std::string, int> materialIndices;
+
+	std::string text(source.begin(), source.end());
+	std::istringstream lines(text);
+	std::string lineText;
+	int lineNumber = 0;
+	std::string error;
+
+	while ((error.length() == 0) && std::getline(lines, lineText))
+	{
+		lineNumber++;
+		size_t comment = lineText.find('#');
+		if (comment != std::string::npos)
+		{
+			lineText.erase(comment);
+		}
+
+		std::istringstream line(lineText);
+		std::string entry;
+		std::string word;
+		if (!(line >> entry))
+		{
+			continue;
+		}
+
+		if (entry == "texture")
+		{
+			SCENE_TEXTURE texture;
+			std::string tag;
+			std::string textureFilename;
+			memset(&texture, 0, sizeof(texture));
+			line >> tag >> textureFilename;
+			if ((CopyName(tag, texture.tag, MAX_TAG_LENGTH) == false) ||
+				(CopyName(textureFilename, texture.filename, MAX_FILENAME_LENGTH) == false))
+			{
+				error = "missing or too long texture tag or filename";
+			}
+			else if (textureIndices.emplace(tag, (int)textures.size()).second == false)
+			{
+				error = "texture " + tag + " is defined twice";
+			}
+			else
+			{
+				textures.push_back(texture);
+			}
+		}
+		else if (entry == "material")
+		{
+			SCENE_MATERIAL material;
+			std::string tag;
+			memset((void*)&material, 0, sizeof(material));
+			line >> tag;
+			if (CopyName(tag, material.tag, MAX_TAG_LENGTH) == false)
+			{
+				error = "missing or too long material tag";
+			}
+			while ((error.length() == 0) && (line >> word))
+			{
+				bool bRead = false;
+				if (word == "ambient")
+					bRead = ReadVec3(line, material.ambientColor);
+				else if (word == "strength")
+					bRead = !(line >> material.ambientStrength).fail();
+				else if (word == "diffuse")
+					bRead = ReadVec3(line, material.diffuseColor);
+				else if (word == "specular")
+					bRead = ReadVec3(line, material.specularColor);
+				else if (word == "shininess")
+					bRead = !(line >> material.shininess).fail();
+				if (bRead == false)
+				{
+					error = "bad material value " + word;
+				}
+			}
+			if ((error.length() == 0) && (materialIndices.emplace(tag, (int)materials.size()).second == false))
+			{
+				error = "material " + tag + " is defined twice";
+			}
+			if (error.length() == 0)
+			{
+				materials.push_back(material);
+			}
+		}
+		else if (entry == "light")
+		{
+			SCENE_LIGHT light;
+			memset((void*)&light, 0, sizeof(light));
+			while ((error.length() == 0) && (line >> word))
+			{
+				bool bRead = false;
+				if (word == "position")
+					bRead = ReadVec3(line, light.position);
+				else if (word == "ambient")
+					bRead = ReadVec3(line, light.ambientColor);
+				else if (word == "diffuse")
+					bRead = ReadVec3(line, light.diffuseColor);
+				else if (word == "specular")
+					bRead = ReadVec3(line, light.specularColor);
+				else if (word == "focal")
+					bRead = !(line >> light.focalStrength).fail();
+				else if (word == "intensity")
+					bRead = !(line >> light.specularIntensity).fail();
+				else if (word == "range")
+					bRead = !(line >> light.range).fail();
+				if (bRead == false)
+				{
+					error = "bad light value " + word;
+				}
+			}
+			if (error.length() == 0)
+			{
+				lights.push_back(light);
+			}
+		}
+		else if (entry == "object")
+		{
+			SCENE_OBJECT object;
+			std::string meshName;
+			memset((void*)&object, 0, sizeof(object));
+			object.meshID = -1;
+			object.textureIndex = -1;
+			object.materialIndex = -1;
+			object.UVscale = glm::vec2(1.0f);
+			object.scaleXYZ = glm::vec3(1.0f);
+
+			line >> meshName;
+			for (int i = 0; i < SCENE_MESH_COUNT; i++)
+			{
+				if (meshName == g_MeshNames[i])
+				{
+					object.meshID = i;
+				}
+			}
+			if (object.meshID < 0)
+			{
+				error = "unknown mesh " + meshName;
+			}
+			while ((error.length() == 0) && (line >> word))
+			{
+				bool bRead = false;
+				if (word == "scale")
+					bRead = ReadVec3(line, object.scaleXYZ);
+				else if (word == "rotation")
+					bRead = ReadVec3(line, object.rotationDegrees);
+				else if (word == "position")
+					bRead = ReadVec3(line, object.positionXYZ);
+				else if (word == "uv")
+					bRead = ReadVec2(line, object.UVscale);
+				else if (word == "transparent")
+				{
+					object.flags |= OBJECT_TRANSPARENT;
+					bRead = true;
+				}
+				else if (word == "texture")
+				{
+					std::string tag;
+					line >> tag;
+					std::unordered_map<std::string, int>::const_iterator found = textureIndices.find(tag);
+					if (found != textureIndices.end())
+					{
+						object.textureIndex = found->second;
+						bRead = true;
+					}
+				}
+				else if (word == "material")
+				{
+					std::string tag;
+					line >> tag;
+					std::unordered_map<std::string, int>::const_iterator found = materialIndices.find(tag);
+					if (found != materialIndices.end())
+					{
+						object.materialIndex = found->second;
+						bRead = true;
+					}
+					else if (tag == "-")
+					{
+						bRead = true;
+					}
+				}
+				if (bRead == false)
+				{
+					error = "bad or unknown object value " + word;
+				}
+			}
+			if (error.length() == 0)
+			{
+				objects.push_back(object);
+			}
+		}
+		else
+		{
+			error = "unknown entry " + entry;
+		}
+	}
+
+	if (error.length() > 0)
+	{
+		std::cout << filename << ":" << lineNumber << ": " << error << std::endl;
+		return(false);
+	}
+
+	SCENE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	header.magic = g_SceneMagic;
+	header.version = g_SceneVersion;
+	header.sourceHash = sourceHash;
+	header.textureCount = (unsigned int)textures.size();
+	header.materialCount = (unsigned int)materials.size();
+	header.lightCount = (unsigned int)lights.size();
+	header.objectCount = (unsigned int)objects.size();
+
+	binary.assign(sizeof(header), 0);
+	header.textureOffset = AppendRecords(binary, textures);
+	header.materialOffset = AppendRecords(binary, materials);
+	header.lightOffset = AppendRecords(binary, lights);
+	header.objectOffset = AppendRecords(binary, objects);
+	memcpy(binary.data(), &header, sizeof(header));
+
+	return(true);
+}
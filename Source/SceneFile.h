@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// load scene descriptions from text files and their compiled binary form
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class reads a scene description - its textures,
+ *  materials, light sources and objects.  Scenes are written
+ *  as text files with one entry per line, and compiled into
+ *  a binary file next to the text file the first time they
+ *  are loaded.  The binary file holds fixed size records
+ *  that are memory mapped and used in place, so loading a
+ *  compiled scene does no parsing and no allocation per
+ *  entry.  The binary file stores a hash of the text it was
+ *  compiled from, and is compiled again when the text file
+ *  changes.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	// constructor
+	SceneFile();
+	// destructor
+	~SceneFile();
+
+	// longest texture or material tag and texture filename,
+	// including the terminating zero
+	static const int MAX_TAG_LENGTH = 32;
+	static const int MAX_FILENAME_LENGTH = 128;
+
+	// meshes an object can be drawn with, in the same order as
+	// the mesh identifiers of the scene manager
+	enum SCENE_MESH
+	{
+		SCENE_MESH_PLANE = 0,
+		SCENE_MESH_BOX,
+		SCENE_MESH_CYLINDER,
+		SCENE_MESH_CONE,
+		SCENE_MESH_SPHERE,
+		SCENE_MESH_HALF_SPHERE,
+		SCENE_MESH_COUNT
+	};
+
+	// flags of a scene object
+	static const unsigned int OBJECT_TRANSPARENT = 1;
+
+	// the records below are stored in the binary file as they
+	// are laid out here, so they only hold 4 byte values
+
+	struct SCENE_TEXTURE
+	{
+		char tag[MAX_TAG_LENGTH];
+		char filename[MAX_FILENAME_LENGTH];
+	};
+
+	struct SCENE_MATERIAL
+	{
+		char tag[MAX_TAG_LENGTH];
+		glm::vec3 ambientColor;
+		float ambientStrength;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+	};
+
+	struct SCENE_LIGHT
+	{
+		glm::vec3 position;
+		glm::vec3 ambientColor;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float focalStrength;
+		float specularIntensity;
+		// distance at which the light has faded out, or 0 for a
+		// light that reaches everything
+		float range;
+	};
+
+	struct SCENE_OBJECT
+	{
+		int meshID;
+		// index into the textures and materials of the scene,
+		// or -1 for none
+		int textureIndex;
+		int materialIndex;
+		unsigned int flags;
+		glm::vec2 UVscale;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+	};
+
+	// load the scene text file at the passed in path, using its
+	// compiled binary file when it is up to date - a compiled
+	// file without its text file is loaded as well
+	bool Load(const char* filename);
+	// release the loaded scene
+	void Close();
+
+	int GetTextureCount() const { return(m_textureCount); }
+	int GetMaterialCount() const { return(m_materialCount); }
+	int GetLightCount() const { return(m_lightCount); }
+	int GetObjectCount() const { return(m_objectCount); }
+	const SCENE_TEXTURE* GetTextures() const { return(m_pTextures); }
+	const SCENE_MATERIAL* GetMaterials() const { return(m_pMaterials); }
+	const SCENE_LIGHT* GetLights() const { return(m_pLights); }
+	const SCENE_OBJECT* GetObjects() const { return(m_pObjects); }
+
+private:
+	// header at the start of the binary file, followed by the
+	// record arrays at the stored offsets
+	struct SCENE_HEADER
+	{
+		unsigned int magic;
+		unsigned int version;
+		unsigned long long sourceHash;
+		unsigned int textureCount;
+		unsigned int materialCount;
+		unsigned int lightCount;
+		unsigned int objectCount;
+		unsigned int textureOffset;
+		unsigned int materialOffset;
+		unsigned int lightOffset;
+		unsigned int objectOffset;
+	};
+
+	// mapped binary file, or the buffer holding the compiled
+	// scene when the binary file could not be written
+	MappedFile m_file;
+	std::vector<unsigned char> m_buffer;
+
+	// record arrays pointing into the file or the buffer
+	const SCENE_TEXTURE* m_pTextures;
+	const SCENE_MATERIAL* m_pMaterials;
+	const SCENE_LIGHT* m_pLights;
+	const SCENE_OBJECT* m_pObjects;
+	int m_textureCount;
+	int m_materialCount;
+	int m_lightCount;
+	int m_objectCount;
+
+	// point the record arrays into the passed in binary scene,
+	// checking the header and the passed in source hash - a
+	// hash of 0 accepts any source
+	bool Attach(const unsigned char* pData, size_t size, unsigned long long sourceHash);
+	// parse the passed in scene text into a binary scene
+	bool Compile(
+		const char* filename,
+		const std::vector<unsigned char>& source,
+		unsigned long long sourceHash,
+		std::vector<unsigned char>& binary);
+
+	// the loaded scene cannot be shared between objects
+	SceneFile(const SceneFile&);
+	SceneFile& operator=(const SceneFile&);
+};
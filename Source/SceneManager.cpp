@@ -8,22 +8,46 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "TransformBuilder.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #endif
 
-#include <glm/gtx/transform.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 
 // declaration of global variables
 namespace
 {
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
 	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
+	const char* g_LightBlockName = "LightBlock";
+	const char* g_MaterialBlockName = "MaterialBlock";
+	const char* g_CameraBlockName = "CameraBlock";
+	const char* g_ClusterBlockName = "ClusterBlock";
+	const char* g_LightListsName = "clusterLightLists";
+	const char* g_TextureCacheDirectory = "texturecache";
+
+	// screen radius in pixels below which a round mesh switches
+	// to the next coarser level of detail
+	const float g_LodPixelRadius[PrimitiveMeshes::LOD_LEVELS - 1] = { 80.0f, 30.0f };
+	// fraction a size has to move past a boundary before the
+	// level changes, so objects near a boundary do not flicker
+	const float g_LodHysteresis = 0.2f;
+	// distance the camera moves before the render queue is
+	// sorted again by the distance from the camera
+	const float g_ResortDistance = 0.5f;
+	// draw records per chunk of the loops run on the job pool,
+	// so a small scene stays on the render thread
+	const int g_RecordsPerJob = 1024;
+	// #define lines of the shader variant bits, in bit order
+	const char* g_VariantDefines[] =
+	{
+		"#define USE_TEXTURE\n",
+		"#define USE_LIGHTING\n"
+	};
 }
 
 /***********************************************************
@@ -31,18 +55,97 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager* pShaderManager)
+SceneManager::SceneManager(
+	ShaderManager* pShaderManager,
+	ShaderStateCache* pShaderState,
+	ProgramCache* pProgramCache,
+	JobPool* pJobPool,
+	FrameProfiler* pProfiler,
+	RenderStats* pRenderStats,
+	GpuMemoryTracker* pMemoryTracker)
 {
 	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
+	m_pShaderState = pShaderState;
+	m_pProgramCache = pProgramCache;
+	m_pJobPool = pJobPool;
+	m_pRenderStats = pRenderStats;
+	m_pMemoryTracker = pMemoryTracker;
+	m_basicMeshes = new PrimitiveMeshes(m_pRenderStats, m_pMemoryTracker);
+
+	// register the uniforms that are written for every draw
+	m_textureValueHandle = m_pShaderState->RegisterUniform(g_TextureValueName, ShaderStateCache::UNIFORM_SAMPLER2D);
+	m_pShaderState->RegisterUniformBlock(g_LightBlockName, LIGHT_BLOCK_BINDING);
+	m_pShaderState->RegisterUniformBlock(g_MaterialBlockName, MATERIAL_BLOCK_BINDING);
+	m_pShaderState->RegisterUniformBlock(g_ClusterBlockName, CLUSTER_BLOCK_BINDING);
+	m_lightListsHandle = m_pShaderState->RegisterUniform(g_LightListsName, ShaderStateCache::UNIFORM_INT);
+	m_pLightBuffer = NULL;
+	m_pMaterialBuffer = NULL;
+	m_pLightClusters = new LightClusters();
+	// the shader variants are loaded once the scene is prepared
+	for (int i = 0; i < VARIANT_COUNT; i++)
+	{
+		m_variantProgramIDs[i] = 0;
+	}
+	m_bSceneLighting = false;
 
 	// initialize the texture collection
-	for (int i = 0; i < 16; i++)
+	m_pTextureRegistry = new TextureRegistry(m_pRenderStats, m_pMemoryTracker);
+	m_pTextureCache = NULL;
+	if (GLEW_EXT_texture_compression_s3tc)
+	{
+		m_pTextureCache = new TextureCache(g_TextureCacheDirectory);
+	}
+	m_pendingTextures = 0;
+
+	// indicate to always flip images vertically when loaded - this
+	// is set once here since the worker threads read it while decoding
+	stbi_set_flip_vertically_on_load(true);
+	m_bRenderQueueDirty = true;
+	m_bSceneChanged = true;
+	m_bInstanceDataDirty = true;
+	m_bIndirectDrawing = false;
+	m_firstTransparentBatch = 0;
+	m_depthProgramID = 0;
+	m_bDepthPrepass = false;
+	m_sortViewPosition = glm::vec3(0.0f);
+	m_pFrustumCuller = new FrustumCuller();
+	m_visibleCount = 0;
+	m_lodPixelScale = 0.0f;
+	m_view = glm::mat4(1.0f);
+	m_projection = glm::mat4(1.0f);
+	m_viewportWidth = 0;
+	m_viewportHeight = 0;
+
+	// register the profiler zones of the render steps, with one
+	// zone per mesh for the draw groups
+	m_pProfiler = pProfiler;
+	m_textureUploadZone = FrameProfiler::INVALID_ZONE;
+	m_cullingZone = FrameProfiler::INVALID_ZONE;
+	m_lightBinningZone = FrameProfiler::INVALID_ZONE;
+	m_instanceUploadZone = FrameProfiler::INVALID_ZONE;
+	m_textureBindingZone = FrameProfiler::INVALID_ZONE;
+	m_indirectDrawZone = FrameProfiler::INVALID_ZONE;
+	m_depthPrepassZone = FrameProfiler::INVALID_ZONE;
+	for (int i = 0; i <= MESH_HALF_SPHERE; i++)
 	{
-		m_textureIDs[i].tag = "/0";
-		m_textureIDs[i].ID = -1;
+		m_drawZones[i] = FrameProfiler::INVALID_ZONE;
+	}
+	if (NULL != m_pProfiler)
+	{
+		m_textureUploadZone = m_pProfiler->RegisterZone("texture upload");
+		m_cullingZone = m_pProfiler->RegisterZone("culling and lod");
+		m_lightBinningZone = m_pProfiler->RegisterZone("light binning");
+		m_instanceUploadZone = m_pProfiler->RegisterZone("instance upload");
+		m_textureBindingZone = m_pProfiler->RegisterZone("texture binding");
+		m_drawZones[MESH_PLANE] = m_pProfiler->RegisterZone("draw planes");
+		m_drawZones[MESH_BOX] = m_pProfiler->RegisterZone("draw boxes");
+		m_drawZones[MESH_CYLINDER] = m_pProfiler->RegisterZone("draw cylinders");
+		m_drawZones[MESH_CONE] = m_pProfiler->RegisterZone("draw cones");
+		m_drawZones[MESH_SPHERE] = m_pProfiler->RegisterZone("draw spheres");
+		m_drawZones[MESH_HALF_SPHERE] = m_pProfiler->RegisterZone("draw half spheres");
+		m_indirectDrawZone = m_pProfiler->RegisterZone("draw indirect");
+		m_depthPrepassZone = m_pProfiler->RegisterZone("depth pre-pass");
 	}
-	m_loadedTextures = 0;
 }
 
 /***********************************************************
@@ -52,105 +155,276 @@ SceneManager::SceneManager(ShaderManager* pShaderManager)
  ***********************************************************/
 SceneManager::~SceneManager()
 {
+	// the decode jobs write into this object, so wait for them
+	// and free the images that were never uploaded
+	if (NULL != m_pJobPool)
+	{
+		m_pJobPool->WaitIdle();
+		m_pJobPool = NULL;
+	}
+	for (DECODED_IMAGE& decoded : m_decodedImages)
+	{
+		if (NULL != decoded.pImage)
+		{
+			stbi_image_free(decoded.pImage);
+		}
+		if (NULL != decoded.pCompressed)
+		{
+			delete decoded.pCompressed;
+		}
+	}
+	m_decodedImages.clear();
+	if (NULL != m_pTextureCache)
+	{
+		delete m_pTextureCache;
+		m_pTextureCache = NULL;
+	}
+
 	// free the allocated objects
+	if (0 != m_depthProgramID)
+	{
+		m_pShaderState->ForgetProgram(m_depthProgramID);
+		glDeleteProgram(m_depthProgramID);
+		m_depthProgramID = 0;
+	}
+	for (int i = 0; i < VARIANT_COUNT; i++)
+	{
+		if (0 != m_variantProgramIDs[i])
+		{
+			m_pShaderState->ForgetProgram(m_variantProgramIDs[i]);
+			glDeleteProgram(m_variantProgramIDs[i]);
+			m_variantProgramIDs[i] = 0;
+		}
+	}
 	m_pShaderManager = NULL;
+	m_pShaderState = NULL;
+	m_pProgramCache = NULL;
+	m_pProfiler = NULL;
+	m_pRenderStats = NULL;
+	if (NULL != m_pLightBuffer)
+	{
+		delete m_pLightBuffer;
+		m_pLightBuffer = NULL;
+	}
+	if (NULL != m_pMaterialBuffer)
+	{
+		delete m_pMaterialBuffer;
+		m_pMaterialBuffer = NULL;
+	}
 	if (NULL != m_basicMeshes)
 	{
 		delete m_basicMeshes;
 		m_basicMeshes = NULL;
 	}
+	if (NULL != m_pFrustumCuller)
+	{
+		delete m_pFrustumCuller;
+		m_pFrustumCuller = NULL;
+	}
+	if (NULL != m_pLightClusters)
+	{
+		delete m_pLightClusters;
+		m_pLightClusters = NULL;
+	}
 
 	// free the allocated OpenGL textures
 	DestroyGLTextures();
+	if (NULL != m_pTextureRegistry)
+	{
+		delete m_pTextureRegistry;
+		m_pTextureRegistry = NULL;
+	}
+	m_pMemoryTracker = NULL;
 }
 
 /***********************************************************
  *  CreateGLTexture()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  This method is used for registering a texture that shows
+ *  a placeholder, and loading it on a worker thread - from
+ *  the compressed texture cache when possible, otherwise by
+ *  decoding the image file.  The decoded image is copied into the next
+ *  available layer of the texture registry by
+ *  UploadDecodedTextures() on the main thread, so there is
+ *  no limit on the number of textures from the texture units.
  ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+bool SceneManager::CreateGLTexture(const char* filename, const std::string& tag)
 {
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
+	TEXTURE_HANDLE textureHandle = m_pTextureRegistry->ReserveTexture(tag);
+	if (textureHandle == INVALID_HANDLE)
+	{
+		return(false);
+	}
 
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
+	m_textureFilenames[tag] = filename;
+	DecodeTextureImage(textureHandle, filename);
+
+	return(true);
+}
+
+/***********************************************************
+ *  DecodeTextureImage()
+ *
+ *  This method is used for loading the image of the passed
+ *  in texture on a worker thread.  The texture keeps what it
+ *  shows now until UploadDecodedTextures() copies the new
+ *  image into it, which is also how a changed image file is
+ *  reloaded.
+ ***********************************************************/
+void SceneManager::DecodeTextureImage(TEXTURE_HANDLE textureHandle, const std::string& filename)
+{
+	DECODED_IMAGE decoded;
+	decoded.textureHandle = textureHandle;
+	decoded.filename = filename;
+	decoded.pCompressed = NULL;
+	decoded.pImage = NULL;
+	decoded.width = 0;
+	decoded.height = 0;
+	decoded.colorChannels = 0;
+	m_pendingTextures++;
 
 	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
+	std::function<void()> decodeJob = [this, decoded]() mutable
+	{
+		if (NULL != m_pTextureCache)
+		{
+			decoded.pCompressed = m_pTextureCache->Load(decoded.filename.c_str());
+		}
+		if (NULL == decoded.pCompressed)
 		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
+			decoded.pImage = stbi_load(
+				decoded.filename.c_str(),
+				&decoded.width,
+				&decoded.height,
+				&decoded.colorChannels,
+				0);
 		}
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+		std::lock_guard<std::mutex> lock(m_decodedImagesMutex);
+		m_decodedImages.push_back(decoded);
+	};
 
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+	if (NULL != m_pJobPool)
+	{
+		m_pJobPool->Submit(decodeJob);
+	}
+	else
+	{
+		decodeJob();
+	}
+}
+
+/***********************************************************
+ *  UploadDecodedTextures()
+ *
+ *  This method is used for copying the images that finished
+ *  decoding into the texture registry, replacing their
+ *  placeholders.  The render queue is rebuilt since the
+ *  textures move to the page of their size, and the unused
+ *  textures are evicted when the new ones go over budget.
+ ***********************************************************/
+void SceneManager::UploadDecodedTextures()
+{
+	std::vector<DECODED_IMAGE> decodedImages;
 
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+	if (m_pendingTextures <= 0)
+	{
+		return;
+	}
 
-		return true;
+	{
+		std::lock_guard<std::mutex> lock(m_decodedImagesMutex);
+		decodedImages.swap(m_decodedImages);
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	for (DECODED_IMAGE& decoded : decodedImages)
+	{
+		// if the image was read from the texture cache
+		if (NULL != decoded.pCompressed)
+		{
+			const TextureCache::COMPRESSED_TEXTURE& compressed = *decoded.pCompressed;
+			std::cout << "Successfully loaded cached image:" << decoded.filename << ", width:" << compressed.width << ", height:" << compressed.height << ", mip levels:" << compressed.mipLevels << std::endl;
+
+			m_pTextureRegistry->SetCompressedTextureImage(
+				decoded.textureHandle,
+				compressed.internalFormat,
+				compressed.width,
+				compressed.height,
+				compressed.mipLevels,
+				compressed.pLevels,
+				compressed.levelSizes);
+
+			// unmap the cache file
+			delete decoded.pCompressed;
+		}
+		// if the image was successfully read from the image file
+		else if (NULL != decoded.pImage)
+		{
+			std::cout << "Successfully loaded image:" << decoded.filename << ", width:" << decoded.width << ", height:" << decoded.height << ", channels:" << decoded.colorChannels << std::endl;
+
+			m_pTextureRegistry->SetTextureImage(
+				decoded.textureHandle,
+				decoded.pImage,
+				decoded.width,
+				decoded.height,
+				decoded.colorChannels);
+
+			// free the image data from local memory
+			stbi_image_free(decoded.pImage);
+		}
+		else
+		{
+			// the texture keeps showing the placeholder
+			std::cout << "Could not load image:" << decoded.filename << std::endl;
+		}
+		m_pendingTextures--;
+	}
 
-	// Error loading the image
-	return false;
+	if (decodedImages.size() > 0)
+	{
+		EnforceTextureBudget();
+		BindGLTextures();
+		m_bRenderQueueDirty = true;
+		m_bSceneChanged = true;
+	}
 }
 
 /***********************************************************
  *  BindGLTextures()
  *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  This method is used for generating the mipmaps of the
+ *  loaded textures.  The texture pages are bound to texture
+ *  unit 0 while rendering, as they are needed.
  ***********************************************************/
 void SceneManager::BindGLTextures()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	m_pTextureRegistry->GenerateMipmaps();
+}
+
+/***********************************************************
+ *  EnforceTextureBudget()
+ *
+ *  This method is used for evicting the loaded textures that
+ *  no draw record uses, when the textures or their mip chains
+ *  are over the budget of the memory tracker.  The freed
+ *  layers are used by the next textures before any page
+ *  grows, and a page without textures is freed.
+ ***********************************************************/
+void SceneManager::EnforceTextureBudget()
+{
+	if ((NULL == m_pMemoryTracker) ||
+		((m_pMemoryTracker->IsOverBudget(GpuMemoryTracker::MEMORY_TEXTURES) == false) &&
+		(m_pMemoryTracker->IsOverBudget(GpuMemoryTracker::MEMORY_MIP_CHAINS) == false)))
+	{
+		return;
+	}
+
+	int evictedCount = m_pTextureRegistry->EvictUnusedTextures();
+	if (evictedCount > 0)
 	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		std::cout << "Evicted " << evictedCount << " unused textures over the texture memory budget" << std::endl;
+		m_bRenderQueueDirty = true;
+		m_bSceneChanged = true;
 	}
 }
 
@@ -162,221 +436,810 @@ void SceneManager::BindGLTextures()
  ***********************************************************/
 void SceneManager::DestroyGLTextures()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	if (NULL != m_pTextureRegistry)
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		m_pTextureRegistry->Destroy();
 	}
 }
 
 /***********************************************************
- *  FindTextureID()
+ *  FindTextureSlot()
  *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.  The
+ *  slot is the handle the texture registry interned the tag as.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+SceneManager::TEXTURE_HANDLE SceneManager::FindTextureSlot(const std::string& tag)
 {
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
+	TEXTURE_HANDLE textureSlot = m_pTextureRegistry->FindTexture(tag);
+	if (NULL != m_pRenderStats)
+	{
+		m_pRenderStats->CountTextureLookup();
+	}
 
-	while ((index < m_loadedTextures) && (bFound == false))
+#ifdef _DEBUG
+	if (textureSlot == INVALID_HANDLE)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
+		std::cout << "Could not find texture:" << tag << std::endl;
 	}
+#endif
 
-	return(textureID);
+	return(textureSlot);
 }
 
 /***********************************************************
- *  FindTextureSlot()
+ *  FindMaterialIndex()
  *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for getting the index of the previously
+ *  defined material that is associated with the passed in tag.  The
+ *  index is the interned handle registered in CompileMaterialTable(),
+ *  or the default material when the tag is unknown.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+SceneManager::MATERIAL_HANDLE SceneManager::FindMaterialIndex(const std::string& tag)
 {
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
+	MATERIAL_HANDLE materialIndex = DEFAULT_MATERIAL;
+	if (NULL != m_pRenderStats)
+	{
+		m_pRenderStats->CountMaterialLookup();
+	}
 
-	while ((index < m_loadedTextures) && (bFound == false))
+	std::unordered_map<std::string, MATERIAL_HANDLE>::const_iterator found = m_materialHandles.find(tag);
+	if (found != m_materialHandles.end())
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
+		materialIndex = found->second;
+	}
+	else
+	{
+		std::cout << "Could not find material:" << tag << std::endl;
 	}
 
-	return(textureSlot);
+	return(materialIndex);
 }
 
 /***********************************************************
- *  FindMaterial()
+ *  SetShaderTexturePage()
  *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
+ *  This method is used for binding the passed in texture page
+ *  to texture unit 0 and setting it into the shader.  The
+ *  layer of each texture in the page is read per instance.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+void SceneManager::SetShaderTexturePage(
+	int texturePage)
 {
-	if (m_objectMaterials.size() == 0)
+	if (NULL != m_pShaderManager)
 	{
-		return(false);
+		m_pTextureRegistry->BindPage(texturePage, 0);
+		m_pShaderState->setSampler2DValue(m_textureValueHandle, 0);
 	}
+}
 
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
+/***********************************************************
+ *  GetShaderVariant()
+ *
+ *  This method is used for getting the shader variant bits
+ *  of the passed in draw record - textured when it has a
+ *  texture, and lit when the scene has light sources.
+ ***********************************************************/
+int SceneManager::GetShaderVariant(const DRAW_RECORD& record) const
+{
+	int shaderVariant = 0;
+
+	if (record.textureSlot != INVALID_HANDLE)
 	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
+		shaderVariant |= VARIANT_TEXTURED;
+	}
+	if (m_bSceneLighting == true)
+	{
+		shaderVariant |= VARIANT_LIT;
 	}
 
-	return(true);
+	return(shaderVariant);
+}
+
+/***********************************************************
+ *  UseShaderVariant()
+ *
+ *  This method is used for making the program of the passed
+ *  in shader variant current.  Switching to the program that
+ *  is already current does nothing.
+ ***********************************************************/
+void SceneManager::UseShaderVariant(int shaderVariant)
+{
+	m_pShaderState->UseProgram(m_variantProgramIDs[shaderVariant]);
+}
+
+/***********************************************************
+ *  AddSceneObject()
+ *
+ *  This method is used for adding an object to the retained
+ *  draw records.  The texture and material tags are resolved
+ *  once here so that no lookups are needed while rendering,
+ *  and the record holds a reference to its texture, which is
+ *  loaded again if it was evicted.  The index of the new
+ *  draw record is returned.
+ ***********************************************************/
+int SceneManager::AddSceneObject(
+	MESH_ID meshID,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	const std::string& textureTag,
+	float u, float v,
+	const std::string& materialTag,
+	bool bTransparent)
+{
+	DRAW_RECORD record;
+
+	record.meshID = meshID;
+	record.textureSlot = FindTextureSlot(textureTag);
+	m_pTextureRegistry->AddReference(record.textureSlot);
+	if (m_pTextureRegistry->RestoreTexture(record.textureSlot) == true)
+	{
+		DecodeTextureImage(record.textureSlot, m_textureFilenames[textureTag]);
+	}
+	// every instance carries its own material, so an object
+	// without one keeps the material of the object added before
+	// it, as it did when the objects were drawn one by one, and
+	// the first object is shaded with the default material
+	record.materialIndex = DEFAULT_MATERIAL;
+	if (materialTag.length() > 0)
+	{
+		record.materialIndex = FindMaterialIndex(materialTag);
+	}
+	else if (m_drawRecords.size() > 0)
+	{
+		record.materialIndex = m_drawRecords.back().materialIndex;
+	}
+	record.UVscale = glm::vec2(u, v);
+	record.scaleXYZ = scaleXYZ;
+	record.rotationDegrees = glm::vec3(XrotationDegrees, YrotationDegrees, ZrotationDegrees);
+	record.positionXYZ = positionXYZ;
+	record.lodLevel = 0;
+	record.shaderVariant = 0;
+	record.bDirty = true;
+	record.bTransparent = bTransparent;
+
+	m_drawRecords.push_back(record);
+	m_pFrustumCuller->Resize((int)m_drawRecords.size());
+	m_bRenderQueueDirty = true;
+	m_bSceneChanged = true;
+
+	return(m_drawRecords.size() - 1);
 }
 
 /***********************************************************
- *  SetTransformations()
+ *  SetObjectTransform()
  *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
+ *  This method is used for changing the transformation values
+ *  of a previously added object.  The model matrix is rebuilt
+ *  on the next rendered frame.
  ***********************************************************/
-void SceneManager::SetTransformations(
+void SceneManager::SetObjectTransform(
+	int objectIndex,
 	glm::vec3 scaleXYZ,
 	float XrotationDegrees,
 	float YrotationDegrees,
 	float ZrotationDegrees,
 	glm::vec3 positionXYZ)
 {
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
+	if ((objectIndex < 0) || (objectIndex >= m_drawRecords.size()))
+	{
+		return;
+	}
+
+	DRAW_RECORD& record = m_drawRecords[objectIndex];
+	record.scaleXYZ = scaleXYZ;
+	record.rotationDegrees = glm::vec3(XrotationDegrees, YrotationDegrees, ZrotationDegrees);
+	record.positionXYZ = positionXYZ;
+	record.bDirty = true;
+	m_bSceneChanged = true;
+}
+
+/***********************************************************
+ *  ReplicateScene()
+ *
+ *  This method is used for adding copies of all the draw
+ *  records on a square grid of the passed in spacing, which
+ *  is used to measure how rendering scales with the number
+ *  of objects.  The original scene stays in the first cell.
+ ***********************************************************/
+void SceneManager::ReplicateScene(int copies, float spacing)
+{
+	int originalCount = (int)m_drawRecords.size();
+	int columns = (int)ceilf(sqrtf((float)copies));
 
-	if (NULL != m_pShaderManager)
+	m_drawRecords.reserve(originalCount * std::max(copies, 1));
+	for (int copy = 1; copy < copies; copy++)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+		glm::vec3 offset(
+			(copy % columns) * spacing,
+			0.0f,
+			-(copy / columns) * spacing);
+
+		for (int i = 0; i < originalCount; i++)
+		{
+			DRAW_RECORD record = m_drawRecords[i];
+			record.positionXYZ += offset;
+			record.bDirty = true;
+			m_pTextureRegistry->AddReference(record.textureSlot);
+			m_drawRecords.push_back(record);
+		}
 	}
+
+	m_pFrustumCuller->Resize((int)m_drawRecords.size());
+	m_bRenderQueueDirty = true;
+	m_bSceneChanged = true;
 }
 
 /***********************************************************
- *  SetShaderColor()
+ *  SetViewFrustum()
  *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
+ *  This method is used for setting the view and projection
+ *  of the current frame, which the draw records are culled
+ *  against, which decide their levels of detail, and which
+ *  the light sources are binned for.
  ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
+void SceneManager::SetViewFrustum(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	int viewportWidth,
+	int viewportHeight)
 {
-	// variables for this method
-	glm::vec4 currentColor;
+	m_pFrustumCuller->SetFrustum(projection * view);
+	m_view = view;
+	m_projection = projection;
+	m_viewportWidth = viewportWidth;
+	m_viewportHeight = viewportHeight;
+	// the second diagonal element scales view space y into the
+	// -1 to 1 range for both kinds of projection
+	m_lodPixelScale = projection[1][1] * viewportHeight * 0.5f;
+}
 
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
+/***********************************************************
+ *  GetMeshBounds()
+ *
+ *  This method is used for getting the bounding sphere that
+ *  encloses the basic mesh with the passed in identifier,
+ *  before any transformation is applied.
+ ***********************************************************/
+void SceneManager::GetMeshBounds(
+	MESH_ID meshID,
+	glm::vec3& center,
+	float& radius)
+{
+	center = glm::vec3(0.0f);
+	radius = 1.0f;
 
-	if (NULL != m_pShaderManager)
+	switch (meshID)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+	case MESH_PLANE:
+		// -1 to 1 in x and z
+		radius = sqrtf(2.0f);
+		break;
+	case MESH_BOX:
+		// unit box around the origin
+		radius = sqrtf(0.75f);
+		break;
+	case MESH_CYLINDER:
+	case MESH_CONE:
+		// radius 1 from y = 0 up to y = 1
+		center = glm::vec3(0.0f, 0.5f, 0.0f);
+		radius = sqrtf(1.25f);
+		break;
+	case MESH_SPHERE:
+	case MESH_HALF_SPHERE:
+		break;
 	}
 }
 
 /***********************************************************
- *  SetShaderTexture()
+ *  RunParallel()
  *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
+ *  This method is used for running a loop over the draw
+ *  records on the job pool, in chunks that each cover their
+ *  own range of records.  The jobs make no OpenGL calls, so
+ *  the render thread only uploads and draws afterwards.
  ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
+void SceneManager::RunParallel(int count, const std::function<void(int, int)>& job)
 {
-	if (NULL != m_pShaderManager)
+	if (NULL == m_pJobPool)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+		job(0, count);
+		return;
+	}
+
+	m_pJobPool->ParallelFor(count, g_RecordsPerJob, job);
+}
 
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+/***********************************************************
+ *  UpdateDirtyTransforms()
+ *
+ *  This method is used for rebuilding the cached model matrix
+ *  and the world-space bounding sphere of every draw record
+ *  that has been flagged as dirty.  Every job builds the
+ *  matrices of the dirty records in its range as one batch,
+ *  and only writes the records and bounding spheres of its
+ *  own range.
+ ***********************************************************/
+void SceneManager::UpdateDirtyTransforms()
+{
+	std::atomic<bool> bChanged(false);
+
+	RunParallel((int)m_drawRecords.size(), [this, &bChanged](int first, int end)
+		{
+			TransformBuilder builder;
+			std::vector<int> dirtyRecords;
+			for (int i = first; i < end; i++)
+			{
+				const DRAW_RECORD& record = m_drawRecords[i];
+				if (record.bDirty == true)
+				{
+					builder.Add(record.scaleXYZ, record.rotationDegrees, record.positionXYZ);
+					dirtyRecords.push_back(i);
+				}
+			}
+			if (dirtyRecords.size() == 0)
+			{
+				return;
+			}
+
+			std::vector<glm::mat4> matrices(dirtyRecords.size());
+			builder.Build(matrices.data());
+			for (int j = 0; j < dirtyRecords.size(); j++)
+			{
+				DRAW_RECORD& record = m_drawRecords[dirtyRecords[j]];
+				record.modelMatrix = matrices[j];
+				record.bDirty = false;
+
+				glm::vec3 localCenter;
+				float localRadius;
+				glm::vec3 center;
+				float radius;
+				GetMeshBounds(record.meshID, localCenter, localRadius);
+				FrustumCuller::TransformSphere(record.modelMatrix, localCenter, localRadius, center, radius);
+				m_pFrustumCuller->SetBounds(dirtyRecords[j], center, radius);
+			}
+			bChanged = true;
+		});
+
+	if (bChanged == true)
+	{
+		m_bInstanceDataDirty = true;
 	}
 }
 
 /***********************************************************
- *  SetTextureUVScale()
+ *  CullDrawRecords()
  *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
+ *  This method is used for testing the bounding spheres of
+ *  all the draw records against the view frustum.  The
+ *  per-instance data only has to be written again when the
+ *  set of visible records has changed since the last frame.
  ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
+void SceneManager::CullDrawRecords()
 {
-	if (NULL != m_pShaderManager)
+	std::atomic<int> visibleCount(0);
+
+	m_cullResults.resize(m_pFrustumCuller->GetCount());
+	RunParallel(m_pFrustumCuller->GetCount(), [this, &visibleCount](int first, int end)
+		{
+			visibleCount += m_pFrustumCuller->Cull(first, end, m_cullResults.data());
+		});
+
+	m_visibleCount = visibleCount;
+	if (m_cullResults != m_visibleRecords)
 	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+		m_visibleRecords.swap(m_cullResults);
+		m_bInstanceDataDirty = true;
 	}
 }
 
 /***********************************************************
- *  SetShaderMaterial()
+ *  SelectLevelsOfDetail()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for choosing the level of detail of
+ *  every round mesh from its radius on the screen.  A record
+ *  only moves to a coarser level when it is clearly below
+ *  the boundary, and back to a finer level when it is clearly
+ *  above it.  The render queue is sorted again when a level
+ *  changes, so records at the same level stay in one batch.
  ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+void SceneManager::SelectLevelsOfDetail()
 {
-	if (m_objectMaterials.size() > 0)
+	if (m_lodPixelScale <= 0.0f)
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
+		return;
+	}
+
+	std::atomic<bool> bChanged(false);
+
+	m_projectedRadii.resize(m_drawRecords.size());
+	RunParallel((int)m_drawRecords.size(), [this, &bChanged](int first, int end)
+		{
+			m_pFrustumCuller->GetProjectedRadii(first, end, m_lodPixelScale, m_projectedRadii.data());
+			for (int i = first; i < end; i++)
+			{
+				DRAW_RECORD& record = m_drawRecords[i];
+				if ((record.meshID == MESH_PLANE) || (record.meshID == MESH_BOX))
+				{
+					continue;
+				}
+
+				float radius = m_projectedRadii[i];
+				int lodLevel = record.lodLevel;
+				while ((lodLevel > 0) &&
+					(radius > g_LodPixelRadius[lodLevel - 1] * (1.0f + g_LodHysteresis)))
+				{
+					lodLevel--;
+				}
+				while ((lodLevel < PrimitiveMeshes::LOD_LEVELS - 1) &&
+					(radius < g_LodPixelRadius[lodLevel] * (1.0f - g_LodHysteresis)))
+				{
+					lodLevel++;
+				}
+
+				if (lodLevel != record.lodLevel)
+				{
+					record.lodLevel = lodLevel;
+					bChanged = true;
+				}
+			}
+		});
+
+	if (bChanged == true)
+	{
+		m_bRenderQueueDirty = true;
+	}
+}
+
+/***********************************************************
+ *  BuildRenderQueue()
+ *
+ *  This method is used for sorting the draw records by shader
+ *  variant, texture page, mesh and level of detail, so that
+ *  consecutive draws share as much state as possible, and
+ *  the instances of each draw front to back from the camera.
+ *  Transparent records are kept at the end back to front,
+ *  since they must be blended over the opaque ones and each
+ *  other.
+ ***********************************************************/
+void SceneManager::BuildRenderQueue()
+{
+	m_renderQueue.resize(m_drawRecords.size());
+	m_sortDistances.resize(m_drawRecords.size());
+	for (int i = 0; i < m_drawRecords.size(); i++)
+	{
+		m_renderQueue[i] = i;
+		m_drawRecords[i].shaderVariant = GetShaderVariant(m_drawRecords[i]);
+		glm::vec3 offset = glm::vec3(m_drawRecords[i].modelMatrix[3]) - m_sortViewPosition;
+		m_sortDistances[i] = glm::dot(offset, offset);
+	}
+
+	std::stable_sort(m_renderQueue.begin(), m_renderQueue.end(),
+		[this](int left, int right)
+		{
+			const DRAW_RECORD& a = m_drawRecords[left];
+			const DRAW_RECORD& b = m_drawRecords[right];
+
+			if (a.bTransparent != b.bTransparent)
+				return(b.bTransparent);
+			// transparent records are blended back to front
+			if (a.bTransparent)
+				return(m_sortDistances[left] > m_sortDistances[right]);
+			// switching the shader program is the most expensive
+			// state change, followed by the texture page
+			if (a.shaderVariant != b.shaderVariant)
+				return(a.shaderVariant < b.shaderVariant);
+			int pageA = m_pTextureRegistry->GetTexturePage(a.textureSlot);
+			int pageB = m_pTextureRegistry->GetTexturePage(b.textureSlot);
+			if (pageA != pageB)
+				return(pageA < pageB);
+			if (a.meshID != b.meshID)
+				return(a.meshID < b.meshID);
+			if (a.lodLevel != b.lodLevel)
+				return(a.lodLevel < b.lodLevel);
+			// the instances of a draw go front to back, so the
+			// depth test rejects the hidden pixels early
+			return(m_sortDistances[left] < m_sortDistances[right]);
+		});
+
+	m_bRenderQueueDirty = false;
+	m_bInstanceDataDirty = true;
+}
+
+/***********************************************************
+ *  UpdateInstanceData()
+ *
+ *  This method is used for writing the model matrix, UV scale,
+ *  material and texture layer of every visible draw record
+ *  into the per-instance data, in render queue order, and
+ *  grouping each run of records with the same shader variant,
+ *  texture page and mesh into one instanced draw that reads a
+ *  contiguous range of instances.  The batches are grouped on
+ *  the render thread, and the instances are then written by
+ *  parallel jobs straight into their slots of the instance
+ *  array, which is uploaded with one call.
+ ***********************************************************/
+void SceneManager::UpdateInstanceData()
+{
+	m_instanceRecords.clear();
+	m_drawBatches.clear();
+	for (int i = 0; i < m_renderQueue.size(); i++)
+	{
+		int recordIndex = m_renderQueue[i];
+		if ((recordIndex < m_visibleRecords.size()) && (m_visibleRecords[recordIndex] == 0))
+		{
+			continue;
+		}
+
+		const DRAW_RECORD& record = m_drawRecords[recordIndex];
+		m_instanceRecords.push_back(recordIndex);
+
+		// the material and texture layer are read per instance,
+		// so only the shader variant, the texture page and the
+		// mesh split the queue into separate draws
+		int texturePage = m_pTextureRegistry->GetTexturePage(record.textureSlot);
+		if ((m_drawBatches.size() > 0) &&
+			(m_drawBatches.back().shaderVariant == record.shaderVariant) &&
+			(m_drawBatches.back().meshID == record.meshID) &&
+			(m_drawBatches.back().lodLevel == record.lodLevel) &&
+			(m_drawBatches.back().texturePage == texturePage) &&
+			(m_drawBatches.back().bTransparent == record.bTransparent))
+		{
+			m_drawBatches.back().instanceCount++;
+		}
+		else
+		{
+			DRAW_BATCH batch;
+			batch.meshID = record.meshID;
+			batch.lodLevel = record.lodLevel;
+			batch.shaderVariant = record.shaderVariant;
+			batch.texturePage = texturePage;
+			batch.firstInstance = (int)m_instanceRecords.size() - 1;
+			batch.instanceCount = 1;
+			batch.bTransparent = record.bTransparent;
+			m_drawBatches.push_back(batch);
+		}
+	}
+
+	// the transparent batches are at the end of the queue
+	m_firstTransparentBatch = (int)m_drawBatches.size();
+	while ((m_firstTransparentBatch > 0) && (m_drawBatches[m_firstTransparentBatch - 1].bTransparent == true))
+	{
+		m_firstTransparentBatch--;
+	}
+
+	// every job writes the instances of its own slots
+	m_instanceData.resize(m_instanceRecords.size());
+	RunParallel((int)m_instanceRecords.size(), [this](int first, int end)
+		{
+			for (int i = first; i < end; i++)
+			{
+				const DRAW_RECORD& record = m_drawRecords[m_instanceRecords[i]];
+				PrimitiveMeshes::INSTANCE_DATA& instance = m_instanceData[i];
+				instance.modelMatrix = record.modelMatrix;
+				instance.UVscale = record.UVscale;
+				instance.materialIndex = record.materialIndex;
+				instance.textureIndex = m_pTextureRegistry->GetTextureLayer(record.textureSlot);
+			}
+		});
+
+	m_basicMeshes->SetInstanceData(m_instanceData.data(), (int)m_instanceData.size());
+
+	// every batch is one command of the indirect draws
+	if (IsIndirectDrawing() == true)
+	{
+		m_drawCommands.resize(m_drawBatches.size());
+		for (int i = 0; i < m_drawBatches.size(); i++)
+		{
+			const DRAW_BATCH& batch = m_drawBatches[i];
+			const PrimitiveMeshes::MESH_RANGE& range = m_basicMeshes->GetMeshRange(
+				(PrimitiveMeshes::MESH_KIND)batch.meshID, batch.lodLevel);
+
+			PrimitiveMeshes::DRAW_COMMAND& command = m_drawCommands[i];
+			command.indexCount = range.indexCount;
+			command.instanceCount = batch.instanceCount;
+			command.firstIndex = range.firstIndex;
+			command.baseVertex = range.baseVertex;
+			command.baseInstance = batch.firstInstance;
+		}
+		m_basicMeshes->SetDrawCommands(m_drawCommands.data(), (int)m_drawCommands.size());
+	}
+
+	m_bInstanceDataDirty = false;
+}
+
+/***********************************************************
+ *  SetIndirectDrawing()
+ *
+ *  This method is used for switching between one instanced
+ *  draw call per draw batch and one indirect draw call per
+ *  texture page.  The commands are written with the next
+ *  per-instance data.
+ ***********************************************************/
+void SceneManager::SetIndirectDrawing(bool bEnabled)
+{
+	if (m_bIndirectDrawing != bEnabled)
+	{
+		m_bIndirectDrawing = bEnabled;
+		m_bInstanceDataDirty = true;
+		m_bSceneChanged = true;
+	}
+}
+
+/***********************************************************
+ *  SetDepthPrepass()
+ *
+ *  This method is used for switching the depth pre-pass of
+ *  the opaque objects on or off.
+ ***********************************************************/
+void SceneManager::SetDepthPrepass(bool bEnabled)
+{
+	if (m_bDepthPrepass != bEnabled)
+	{
+		m_bDepthPrepass = bEnabled;
+		m_bSceneChanged = true;
+	}
+}
+
+/***********************************************************
+ *  IsSceneChanged()
+ *
+ *  This method is used for checking whether the next frame
+ *  would differ from the last rendered one for the same
+ *  view.  Decoded textures only change the frame once they
+ *  are uploaded, which is done while rendering.
+ ***********************************************************/
+bool SceneManager::IsSceneChanged() const
+{
+	if (m_bSceneChanged == true)
+	{
+		return(true);
+	}
+
+	std::lock_guard<std::mutex> lock(m_decodedImagesMutex);
+	return(m_decodedImages.size() > 0);
+}
+
+/***********************************************************
+ *  IsIndirectDrawing()
+ *
+ *  This method is used for checking whether the draw batches
+ *  are submitted from the indirect command buffer, which
+ *  needs indirect drawing to be on and supported.
+ ***********************************************************/
+bool SceneManager::IsIndirectDrawing() const
+{
+	return((m_bIndirectDrawing == true) && (m_basicMeshes->IsIndirectSupported() == true));
+}
+
+/***********************************************************
+ *  LoadShaderVariants()
+ *
+ *  This method is used for building every variant of the
+ *  shader program of the scene from the same shader files,
+ *  each with the #define lines of its variant bits, so no
+ *  fragment branches on whether it is textured or lit.  When
+ *  any variant does not link, the new ones are dropped and
+ *  the previous variants stay in use.
+ ***********************************************************/
+bool SceneManager::LoadShaderVariants(const char* vertexShaderFilename, const char* fragmentShaderFilename)
+{
+	GLuint programIDs[VARIANT_COUNT];
+
+	for (int i = 0; i < VARIANT_COUNT; i++)
+	{
+		std::string defines;
+		for (int bit = 0; (1 << bit) < VARIANT_COUNT; bit++)
+		{
+			if ((i & (1 << bit)) != 0)
+			{
+				defines += g_VariantDefines[bit];
+			}
+		}
+
+		programIDs[i] = m_pProgramCache->Load(vertexShaderFilename, fragmentShaderFilename, defines);
+		if (0 == programIDs[i])
+		{
+			for (int j = 0; j < i; j++)
+			{
+				glDeleteProgram(programIDs[j]);
+			}
+			std::cout << "Could not load the shader variants" << std::endl;
+			return(false);
+		}
+	}
 
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
+	for (int i = 0; i < VARIANT_COUNT; i++)
+	{
+		if (0 != m_variantProgramIDs[i])
 		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			m_pShaderState->ForgetProgram(m_variantProgramIDs[i]);
+			glDeleteProgram(m_variantProgramIDs[i]);
 		}
+		m_variantProgramIDs[i] = programIDs[i];
+	}
+	// the uniforms set before rendering are written into the
+	// new programs as they are used
+	UseShaderVariant(VARIANT_COUNT - 1);
+	m_bSceneChanged = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  LoadDepthProgram()
+ *
+ *  This method is used for loading the shader program of the
+ *  depth pre-pass, which uses the vertex shader of the scene
+ *  with a fragment shader that writes nothing.  A program
+ *  that does not link is dropped, and the previous program
+ *  stays in use.
+ ***********************************************************/
+bool SceneManager::LoadDepthProgram(const char* vertexShaderFilename, const char* fragmentShaderFilename)
+{
+	GLuint programID = m_pProgramCache->Load(vertexShaderFilename, fragmentShaderFilename);
+	if (0 == programID)
+	{
+		std::cout << "Could not load the depth pre-pass shaders" << std::endl;
+		return(false);
+	}
+
+	// the vertex shader reads the shared camera block
+	GLuint blockIndex = glGetUniformBlockIndex(programID, g_CameraBlockName);
+	if (GL_INVALID_INDEX != blockIndex)
+	{
+		glUniformBlockBinding(programID, blockIndex, CAMERA_BLOCK_BINDING);
+	}
+
+	if ((0 != m_depthProgramID) && (m_depthProgramID != programID))
+	{
+		m_pShaderState->ForgetProgram(m_depthProgramID);
+		glDeleteProgram(m_depthProgramID);
 	}
+	m_depthProgramID = programID;
+	m_bSceneChanged = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetViewPosition()
+ *
+ *  This method is used for getting the camera position from
+ *  the view matrix of the current frame, which is the
+ *  inverse rotation of its negated translation.
+ ***********************************************************/
+glm::vec3 SceneManager::GetViewPosition() const
+{
+	glm::vec3 translation = glm::vec3(m_view[3]);
+	return(glm::vec3(
+		-glm::dot(glm::vec3(m_view[0]), translation),
+		-glm::dot(glm::vec3(m_view[1]), translation),
+		-glm::dot(glm::vec3(m_view[2]), translation)));
+}
+
+/***********************************************************
+ *  DrawMeshInstanced()
+ *
+ *  This method is used for drawing instances of the basic
+ *  mesh that is associated with the passed in identifier, at
+ *  the passed in level of detail.
+ ***********************************************************/
+void SceneManager::DrawMeshInstanced(
+	MESH_ID meshID,
+	int lodLevel,
+	int instanceCount,
+	int firstInstance)
+{
+	// the mesh kinds are in the same order as the identifiers
+	m_basicMeshes->DrawMeshInstanced(
+		(PrimitiveMeshes::MESH_KIND)meshID,
+		lodLevel,
+		instanceCount,
+		firstInstance);
 }
 
 
@@ -399,7 +1262,8 @@ void SceneManager::LoadSceneTextures()
 
 
 	bool bReturn = false;
-	// load the textures from the image files and bind them to texture slots
+	// decode the textures from the image files in parallel - they
+	// show a placeholder until they are in the texture registry
 
 	bReturn = CreateGLTexture(
 		"textures/ground.jpg", "ground");
@@ -618,51 +1482,146 @@ void SceneManager::DefineObjectMaterials()
 
 }
 
+/***********************************************************
+ *  CompileMaterialTable()
+ *
+ *  This method is used for converting the defined object
+ *  materials into the std140 material table and uploading it
+ *  once into the material uniform buffer.  The material tags
+ *  are interned here, and draws only select a material by its
+ *  index into this table.  The first entry of the table is the
+ *  default material, so the defined materials follow it.
+ ***********************************************************/
+void SceneManager::CompileMaterialTable()
+{
+	std::vector<GPU_MATERIAL> materialTable(MAX_MATERIALS);
+
+	if (m_objectMaterials.size() > MAX_MATERIALS - 1)
+	{
+		std::cout << "Only the first " << MAX_MATERIALS - 1 << " of " << m_objectMaterials.size()
+			<< " materials fit into the material table" << std::endl;
+	}
+
+	// a plain grey matte material for the objects whose material
+	// is missing or unknown
+	materialTable[DEFAULT_MATERIAL].ambientColor = glm::vec3(0.05f, 0.05f, 0.05f);
+	materialTable[DEFAULT_MATERIAL].ambientStrength = 0.2f;
+	materialTable[DEFAULT_MATERIAL].diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
+	materialTable[DEFAULT_MATERIAL].shininess = 1.0f;
+	materialTable[DEFAULT_MATERIAL].specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
+
+	m_materialHandles.clear();
+	for (int i = 0; (i < m_objectMaterials.size()) && (i < MAX_MATERIALS - 1); i++)
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[i];
+		const MATERIAL_HANDLE materialIndex = DEFAULT_MATERIAL + 1 + i;
+		// intern the tag so the material is found without scanning
+		m_materialHandles.emplace(material.tag, materialIndex);
+		materialTable[materialIndex].ambientColor = material.ambientColor;
+		materialTable[materialIndex].ambientStrength = material.ambientStrength;
+		materialTable[materialIndex].diffuseColor = material.diffuseColor;
+		materialTable[materialIndex].shininess = material.shininess;
+		materialTable[materialIndex].specularColor = material.specularColor;
+	}
+
+	if (NULL == m_pMaterialBuffer)
+	{
+		m_pMaterialBuffer = new UniformBuffer();
+		m_pMaterialBuffer->Create(MATERIAL_BLOCK_BINDING, sizeof(GPU_MATERIAL) * MAX_MATERIALS);
+	}
+	m_pMaterialBuffer->Update(materialTable.data(), sizeof(GPU_MATERIAL) * MAX_MATERIALS);
+	m_bSceneChanged = true;
+}
+
 /***********************************************************
  *  SetupSceneLights()
  *
  *  This method is called to add and configure the light
- *  sources for the 3D scene.  There are up to 4 light sources.
+ *  sources for the 3D scene.  The built-in scene has 4 light
+ *  sources without a range, which light every object.
  ***********************************************************/
 void SceneManager::SetupSceneLights()
 {
-	// this line of code is NEEDED for telling the shaders to render 
-	// the 3D scene with custom lighting - to use the default rendered 
+	// this line of code is NEEDED for rendering the 3D scene with
+	// the lit shader variants - to use the default rendered
 	// lighting then comment out the following line
-	m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	m_bSceneLighting = true;
+	m_bRenderQueueDirty = true;
+	m_lightSources.assign(4, LIGHT_SOURCE());
 
 	// located at the bottom of the scene
-	m_pShaderManager->setVec3Value("lightSources[0].position", 0.0f, -6.0f, -12.0f);
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 0.5f, 0.5f, 0.5f);
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 0.0001f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 0.4f);
-	
+	m_lightSources[0].position = glm::vec3(0.0f, -6.0f, -12.0f);
+	m_lightSources[0].ambientColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	m_lightSources[0].diffuseColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	m_lightSources[0].specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
+	m_lightSources[0].focalStrength = 0.0001f;
+	m_lightSources[0].specularIntensity = 0.4f;
+
 	// located above the scene
-	m_pShaderManager->setVec3Value("lightSources[1].position", 0.0f, 8.0f, -500.0f);
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.5f, 0.5f, 0.5f);
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 0.0001f);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 0.2f);
+	m_lightSources[1].position = glm::vec3(0.0f, 8.0f, -500.0f);
+	m_lightSources[1].ambientColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	m_lightSources[1].diffuseColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	m_lightSources[1].specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
+	m_lightSources[1].focalStrength = 0.0001f;
+	m_lightSources[1].specularIntensity = 0.2f;
 
 	// located to the left of the scene
-	m_pShaderManager->setVec3Value("lightSources[2].position", -50000.0f, 10.5f, -45.0f);
-	m_pShaderManager->setVec3Value("lightSources[2].ambientColor", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.001f, 0.001f, 0.001f);
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 0.0001f);
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.01f);
-
-	//located to the right of the scene
-	m_pShaderManager->setVec3Value("lightSources[3].position", 900.0f, 8.0f, -2.0f);
-	m_pShaderManager->setVec3Value("lightSources[3].ambientColor", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setVec3Value("lightSources[3].diffuseColor", 0.001f, 0.001f, 0.001f);
-	m_pShaderManager->setVec3Value("lightSources[3].specularColor", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setFloatValue("lightSources[3].focalStrength", 0.0001f);
-	m_pShaderManager->setFloatValue("lightSources[3].specularIntensity", 0.1f);
+	m_lightSources[2].position = glm::vec3(-50000.0f, 10.5f, -45.0f);
+	m_lightSources[2].ambientColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	m_lightSources[2].diffuseColor = glm::vec3(0.001f, 0.001f, 0.001f);
+	m_lightSources[2].specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	m_lightSources[2].focalStrength = 0.0001f;
+	m_lightSources[2].specularIntensity = 0.01f;
+
+	// located to the right of the scene
+	m_lightSources[3].position = glm::vec3(900.0f, 8.0f, -2.0f);
+	m_lightSources[3].ambientColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	m_lightSources[3].diffuseColor = glm::vec3(0.001f, 0.001f, 0.001f);
+	m_lightSources[3].specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	m_lightSources[3].focalStrength = 0.0001f;
+	m_lightSources[3].specularIntensity = 0.1f;
+
+	UploadSceneLights();
+}
+
+/***********************************************************
+ *  UploadSceneLights()
+ *
+ *  This method is used for writing the whole light table
+ *  into the shared uniform buffer with a single update, and
+ *  passing the light sources on to the light clusters.  The
+ *  light sources without a range are moved to the start of
+ *  the table, where the shader loops over all of them.
+ ***********************************************************/
+void SceneManager::UploadSceneLights()
+{
+	if (m_lightSources.size() > MAX_LIGHTS)
+	{
+		std::cout << "Only the first " << MAX_LIGHTS << " of " << m_lightSources.size()
+			<< " light sources are used" << std::endl;
+		m_lightSources.resize(MAX_LIGHTS);
+	}
+	std::stable_partition(m_lightSources.begin(), m_lightSources.end(),
+		[](const LIGHT_SOURCE& light) { return(light.range <= 0.0f); });
 
+	if (NULL == m_pLightBuffer)
+	{
+		m_pLightBuffer = new UniformBuffer();
+		m_pLightBuffer->Create(LIGHT_BLOCK_BINDING, sizeof(LIGHT_SOURCE) * MAX_LIGHTS);
+	}
+	if (m_lightSources.size() > 0)
+	{
+		m_pLightBuffer->Update(m_lightSources.data(), sizeof(LIGHT_SOURCE) * m_lightSources.size());
+	}
+
+	std::vector<glm::vec4> lightBounds(m_lightSources.size());
+	for (int i = 0; i < m_lightSources.size(); i++)
+	{
+		lightBounds[i] = glm::vec4(m_lightSources[i].position, m_lightSources[i].range);
+	}
+	m_pLightClusters->SetLights(lightBounds);
+	m_pShaderState->setIntValue(m_lightListsHandle, LightClusters::LIGHT_LIST_TEXTURE_UNIT);
+	m_bSceneChanged = true;
 }
 
 
@@ -673,16 +1632,26 @@ void SceneManager::SetupSceneLights()
  *  the shapes, textures in memory to support the 3D scene
  *  rendering
  ***********************************************************/
-void SceneManager::PrepareScene()
+void SceneManager::PrepareScene(const char* sceneFilename)
 {
-	
-	// load the textures for the 3D scene
-	LoadSceneTextures();
-	// define the materials that will be used for the objects
-	// in the 3D scene
-	DefineObjectMaterials();
-	// add and defile the light sources for the 3D scene
-	SetupSceneLights();
+	bool bSceneFileLoaded = false;
+
+	if (NULL != sceneFilename)
+	{
+		bSceneFileLoaded = LoadSceneFile(sceneFilename);
+	}
+
+	if (bSceneFileLoaded == false)
+	{
+		// load the textures for the 3D scene
+		LoadSceneTextures();
+		// define the materials that will be used for the objects
+		// in the 3D scene and upload them into the material table
+		DefineObjectMaterials();
+		CompileMaterialTable();
+		// add and defile the light sources for the 3D scene
+		SetupSceneLights();
+	}
 
 	// only one instance of a particular mesh needs to be
 	// loaded in memory no matter how many times it is drawn
@@ -692,743 +1661,719 @@ void SceneManager::PrepareScene()
 	m_basicMeshes->LoadCylinderMesh();  // Added: Load cylinder mesh for table legs
 	m_basicMeshes->LoadConeMesh();
 	m_basicMeshes->LoadSphereMesh();
+
+	// add all the objects to the retained draw records and
+	// build their model matrices once
+	if (bSceneFileLoaded == false)
+	{
+		BuildSceneObjects();
+	}
+	UpdateDirtyTransforms();
 }
 
 /***********************************************************
- *  RenderScene()
+ *  LoadSceneFile()
  *
- *  This method is used for rendering the 3D scene by
- *  transforming and drawing the basic 3D shapes
+ *  This method is used for loading the textures, materials,
+ *  light sources and objects of the 3D scene from the scene
+ *  file at the passed in path.  The texture and material
+ *  tags are resolved once per entry of the file, and the
+ *  draw records of all the objects are allocated at once and
+ *  filled in a single pass over the compiled object records.
+ *  Loading the file again replaces the materials, lights and
+ *  objects, while only the textures that are new, use a
+ *  different image file or were evicted are decoded, and the
+ *  textures the new scene does not use are evicted when the
+ *  textures are over budget.  The loaded scene is kept when
+ *  the file cannot be read.
  ***********************************************************/
-void SceneManager::RenderScene()
-
+bool SceneManager::LoadSceneFile(const char* filename)
 {
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
+	SceneFile sceneFile;
 
-	//******************** Ground Plane *******************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(45.0f, 1.0f, 45.0f);
+	if (sceneFile.Load(filename) == false)
+	{
+		return(false);
+	}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+	m_sceneFilename = filename;
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, -7.1f, 0.0f);
+	// decode the new textures from the image files in parallel,
+	// and find the slot of every texture of the file
+	const SceneFile::SCENE_TEXTURE* pTextures = sceneFile.GetTextures();
+	std::vector<TEXTURE_HANDLE> textureSlots(sceneFile.GetTextureCount(), INVALID_HANDLE);
+	for (int i = 0; i < sceneFile.GetTextureCount(); i++)
+	{
+		TEXTURE_HANDLE textureSlot = m_pTextureRegistry->FindTexture(pTextures[i].tag);
+		if (textureSlot == INVALID_HANDLE)
+		{
+			CreateGLTexture(pTextures[i].filename, pTextures[i].tag);
+		}
+		else if (m_textureFilenames[pTextures[i].tag] != pTextures[i].filename)
+		{
+			m_textureFilenames[pTextures[i].tag] = pTextures[i].filename;
+			m_pTextureRegistry->RestoreTexture(textureSlot);
+			DecodeTextureImage(textureSlot, pTextures[i].filename);
+		}
+		else if (m_pTextureRegistry->RestoreTexture(textureSlot) == true)
+		{
+			DecodeTextureImage(textureSlot, pTextures[i].filename);
+		}
+		textureSlots[i] = FindTextureSlot(pTextures[i].tag);
+	}
+	BindGLTextures();
+
+	// define the materials and upload them into the material table
+	const SceneFile::SCENE_MATERIAL* pMaterials = sceneFile.GetMaterials();
+	m_objectMaterials.clear();
+	m_objectMaterials.reserve(sceneFile.GetMaterialCount());
+	for (int i = 0; i < sceneFile.GetMaterialCount(); i++)
+	{
+		OBJECT_MATERIAL material;
+		material.ambientColor = pMaterials[i].ambientColor;
+		material.ambientStrength = pMaterials[i].ambientStrength;
+		material.diffuseColor = pMaterials[i].diffuseColor;
+		material.specularColor = pMaterials[i].specularColor;
+		material.shininess = pMaterials[i].shininess;
+		material.tag = pMaterials[i].tag;
+		m_objectMaterials.push_back(material);
+	}
+	CompileMaterialTable();
+	std::vector<MATERIAL_HANDLE> materialHandles(sceneFile.GetMaterialCount(), DEFAULT_MATERIAL);
+	for (int i = 0; i < sceneFile.GetMaterialCount(); i++)
+	{
+		materialHandles[i] = FindMaterialIndex(pMaterials[i].tag);
+	}
+
+	// a scene with light sources is rendered with the lit
+	// shader variants
+	const SceneFile::SCENE_LIGHT* pLights = sceneFile.GetLights();
+	m_lightSources.assign(sceneFile.GetLightCount(), LIGHT_SOURCE());
+	for (int i = 0; i < sceneFile.GetLightCount(); i++)
+	{
+		m_lightSources[i].position = pLights[i].position;
+		m_lightSources[i].ambientColor = pLights[i].ambientColor;
+		m_lightSources[i].diffuseColor = pLights[i].diffuseColor;
+		m_lightSources[i].specularColor = pLights[i].specularColor;
+		m_lightSources[i].focalStrength = pLights[i].focalStrength;
+		m_lightSources[i].specularIntensity = pLights[i].specularIntensity;
+		m_lightSources[i].range = pLights[i].range;
+	}
+	m_bSceneLighting = (sceneFile.GetLightCount() > 0);
+	UploadSceneLights();
+
+	// replace the retained draw records with the objects, which
+	// hold references to their textures instead of the old ones
+	const SceneFile::SCENE_OBJECT* pObjects = sceneFile.GetObjects();
+	for (const DRAW_RECORD& record : m_drawRecords)
+	{
+		m_pTextureRegistry->ReleaseReference(record.textureSlot);
+	}
+	m_drawRecords.clear();
+	m_drawRecords.resize(sceneFile.GetObjectCount());
+	for (int i = 0; i < sceneFile.GetObjectCount(); i++)
+	{
+		const SceneFile::SCENE_OBJECT& object = pObjects[i];
+		DRAW_RECORD& record = m_drawRecords[i];
+
+		// the mesh identifiers of the file are in the same order
+		record.meshID = MESH_BOX;
+		if ((object.meshID >= 0) && (object.meshID <= MESH_HALF_SPHERE))
+		{
+			record.meshID = (MESH_ID)object.meshID;
+		}
+		record.textureSlot = INVALID_HANDLE;
+		if ((object.textureIndex >= 0) && (object.textureIndex < sceneFile.GetTextureCount()))
+		{
+			record.textureSlot = textureSlots[object.textureIndex];
+		}
+		m_pTextureRegistry->AddReference(record.textureSlot);
+		// an object without a material keeps the material of the
+		// object before it, as in AddSceneObject()
+		record.materialIndex = DEFAULT_MATERIAL;
+		if ((object.materialIndex >= 0) && (object.materialIndex < sceneFile.GetMaterialCount()))
+		{
+			record.materialIndex = materialHandles[object.materialIndex];
+		}
+		else if (i > 0)
+		{
+			record.materialIndex = m_drawRecords[i - 1].materialIndex;
+		}
+		record.UVscale = object.UVscale;
+		record.scaleXYZ = object.scaleXYZ;
+		record.rotationDegrees = object.rotationDegrees;
+		record.positionXYZ = object.positionXYZ;
+		record.lodLevel = 0;
+		record.shaderVariant = 0;
+		record.bDirty = true;
+		record.bTransparent = ((object.flags & SceneFile::OBJECT_TRANSPARENT) != 0);
+	}
+
+	m_pFrustumCuller->Resize((int)m_drawRecords.size());
+	m_bRenderQueueDirty = true;
+	EnforceTextureBudget();
+
+	return(true);
+}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ,XrotationDegrees,YrotationDegrees,ZrotationDegrees,positionXYZ);
+/***********************************************************
+ *  GetTextureFilenames()
+ *
+ *  This method is used for getting the image files of all
+ *  the textures, for watching them for changes.
+ ***********************************************************/
+void SceneManager::GetTextureFilenames(std::vector<std::string>& filenames) const
+{
+	filenames.clear();
+	for (const std::pair<const std::string, std::string>& texture : m_textureFilenames)
+	{
+		filenames.push_back(texture.second);
+	}
+}
 
-	//SetShaderColor(1, 1, 1, 1);
+/***********************************************************
+ *  ReloadTexture()
+ *
+ *  This method is used for decoding the image file at the
+ *  passed in path again for every texture using it, after
+ *  the file has changed.  The other textures, and evicted
+ *  textures that are loaded again once they are used, are
+ *  not decoded.
+ ***********************************************************/
+bool SceneManager::ReloadTexture(const std::string& filename)
+{
+	bool bFound = false;
+
+	for (const std::pair<const std::string, std::string>& texture : m_textureFilenames)
+	{
+		if (texture.second == filename)
+		{
+			TEXTURE_HANDLE textureSlot = m_pTextureRegistry->FindTexture(texture.first);
+			if ((textureSlot != INVALID_HANDLE) && (m_pTextureRegistry->IsTextureEvicted(textureSlot) == false))
+			{
+				DecodeTextureImage(textureSlot, filename);
+				bFound = true;
+			}
+		}
+	}
 
-	SetShaderTexture("ground");
-	SetTextureUVScale(5.0f, 5.0f);
-	SetShaderMaterial("ground1");
+	return(bFound);
+}
 
-	// draw the mesh with transformation values - this plane is used for the base
-	m_basicMeshes->DrawPlaneMesh();
+/***********************************************************
+ *  BuildSceneObjects()
+ *
+ *  This method is used for adding all the objects of the 3D
+ *  scene to the retained draw records.  It is called once
+ *  after the textures and materials have been defined.
+ ***********************************************************/
+void SceneManager::BuildSceneObjects()
+{
+	/****************** Ground Plane *******************/
+	AddSceneObject(MESH_PLANE,
+		glm::vec3(45.0f, 1.0f, 45.0f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, -7.1f, 0.0f),
+		"ground", 5.0f, 5.0f,
+		"ground1");
 
 	/****************** Kitchen Table *******************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(39.8f, 0.9f, 19.8f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 60.0f;  // Rotateed for angled view
-	ZrotationDegrees = 0.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, -0.1f, -20.0f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ,XrotationDegrees,YrotationDegrees,ZrotationDegrees,positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table
-
-	SetShaderTexture("wood"); // Using fabric02 texture for table cloth; I took a photo of my table cloth then uploaded it to the textures folder
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("wood1");
-
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	AddSceneObject(MESH_BOX,
+		glm::vec3(39.8f, 0.9f, 19.8f),
+		0.0f, 60.0f, 0.0f,	// Rotated for angled view
+		glm::vec3(0.0f, -0.1f, -20.0f),
+		"wood", 1.0f, 1.0f,
+		"wood1");
 
 	/****************** Kitchen Table Cloth Plane (Top) *******************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 60.0f;  // Rotateed for angled view
-	ZrotationDegrees = 0.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 1.0f, -20.0f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ,XrotationDegrees,YrotationDegrees,ZrotationDegrees,positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table
-	
-	SetShaderTexture("fabric02"); // Using fabric02 texture for table cloth; I took a photo of my table cloth then uploaded it to the textures folder
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("fabric03");
-	
-	
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	AddSceneObject(MESH_PLANE,
+		glm::vec3(20.0f, 1.0f, 10.0f),
+		0.0f, 60.0f, 0.0f,	// Rotated for angled view
+		glm::vec3(0.0f, 1.0f, -20.0f),
+		"fabric02", 1.0f, 1.0f,	// Using fabric02 texture for table cloth; I took a photo of my table cloth then uploaded it to the textures folder
+		"fabric03");
 
 	/****************** Kitchen Table Cloth Plane (Front) *******************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(1.0f, 1.0f, 10.0f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 60.0f;  // Rotateed for angled view
-	ZrotationDegrees = 90.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-9.98f, -0.020f, -2.73f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ,XrotationDegrees,YrotationDegrees,ZrotationDegrees,positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table
-
-	SetShaderTexture("fabric02"); // Using fabric02 texture for a side table cloth; I took a photo of my side table cloth then uploaded it to the textures folder but it did not look good
-	SetTextureUVScale(1.0f, 1.0f); // This was the best looking scale for the texture
-	SetShaderMaterial("fabric03");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	AddSceneObject(MESH_PLANE,
+		glm::vec3(1.0f, 1.0f, 10.0f),
+		0.0f, 60.0f, 90.0f,	// Rotated for angled view
+		glm::vec3(-9.98f, -0.020f, -2.73f),
+		"fabric02", 1.0f, 1.0f,	// Using fabric02 texture for a side table cloth; I took a photo of my side table cloth then uploaded it to the textures folder but it did not look good
+		"fabric03");
 
 	/****************** Kitchen Table Cloth Plane (Back) *******************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(1.0f, 1.0f, 10.0f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 60.0f;  // Rotateed for angled view
-	ZrotationDegrees = 90.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(10.0f, -0.02f, -37.33f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ,XrotationDegrees,YrotationDegrees,ZrotationDegrees,positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown; Different color to set position
-
-	SetShaderTexture("fabric02"); //Using fabric02 texture for a side table cloth; I took a photo of my side table cloth then uploaded it to the textures folder but it did not look good
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("fabric03");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-
+	AddSceneObject(MESH_PLANE,
+		glm::vec3(1.0f, 1.0f, 10.0f),
+		0.0f, 60.0f, 90.0f,	// Rotated for angled view
+		glm::vec3(10.0f, -0.02f, -37.33f),
+		"fabric02", 1.0f, 1.0f,	// Using fabric02 texture for a side table cloth; I took a photo of my side table cloth then uploaded it to the textures folder but it did not look good
+		"fabric03");
 
 	/****************** Kitchen Table Cloth Plane (Left Side) *******************/
-// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(1.0f, 1.0f, 20.0f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 330.0f;  // Rotateed for angled view
-	ZrotationDegrees = 90.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-8.61f, -0.02f, -25.0f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ,XrotationDegrees,YrotationDegrees,ZrotationDegrees,positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table; Different color to set position
-
-	SetShaderTexture("fabric02"); // Using fabric02 texture for a side table cloth; I took a photo of my side table cloth then uploaded it to the textures folder but it did not look good
-	SetTextureUVScale(1.0f, 1.0f); // This was the best looking scale for the texture
-	SetShaderMaterial("fabric03");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-
+	AddSceneObject(MESH_PLANE,
+		glm::vec3(1.0f, 1.0f, 20.0f),
+		0.0f, 330.0f, 90.0f,	// Rotated for angled view
+		glm::vec3(-8.61f, -0.02f, -25.0f),
+		"fabric02", 1.0f, 1.0f,	// Using fabric02 texture for a side table cloth; I took a photo of my side table cloth then uploaded it to the textures folder but it did not look good
+		"fabric03");
 
 	/****************** Kitchen Table Cloth Plane (Right Side) *******************/
-	scaleXYZ = glm::vec3(1.0f, 1.0f, 20.0f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 329.9f;  // Rotateed for angled view
-	ZrotationDegrees = 90.0f;
-	positionXYZ = glm::vec3(8.69f, 0.0f, -15.03f);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table; Different color to set position
-	SetTransformations(scaleXYZ,XrotationDegrees,YrotationDegrees,ZrotationDegrees,positionXYZ);
-
-	SetShaderTexture("fabric02"); // Using fabric02 texture for a side table cloth; I took a photo of my side table cloth then uploaded it to the textures folder but it did not look good
-	SetTextureUVScale(1.0f, 1.0f); // This was the best looking scale for the texture
-	SetShaderMaterial("fabric03");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	AddSceneObject(MESH_PLANE,
+		glm::vec3(1.0f, 1.0f, 20.0f),
+		0.0f, 329.9f, 90.0f,	// Rotated for angled view
+		glm::vec3(8.69f, 0.0f, -15.03f),
+		"fabric02", 1.0f, 1.0f,	// Using fabric02 texture for a side table cloth; I took a photo of my side table cloth then uploaded it to the textures folder but it did not look good
+		"fabric03");
 
 	/****************** Table Leg 1 (Front Left) *******************/
-	scaleXYZ = glm::vec3(0.5f, 8.0f, 0.5f); 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-16.0f, -7.01f, -8.5f); // front left corner
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Same brown as table
-	
-	SetShaderTexture("wood"); // Using wood texture for table legs
-	SetTextureUVScale(1.0f, 1.0f); 
-	SetShaderMaterial("wood1");
-	
-	m_basicMeshes->DrawCylinderMesh();
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.5f, 8.0f, 0.5f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-16.0f, -7.01f, -8.5f),	// front left corner
+		"wood", 1.0f, 1.0f,	// Using wood texture for table legs
+		"wood1");
 
 	/****************** Table Leg 2 (Front Right) *******************/
-	scaleXYZ = glm::vec3(0.5f, 8.0f, 0.5f); 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-1.84f, -7.01f, 0.85f); // front right corner
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Same brown as table
-	SetShaderTexture("wood"); // Using wood texture for table legs
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("wood1");
-	
-	m_basicMeshes->DrawCylinderMesh();
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.5f, 8.0f, 0.5f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-1.84f, -7.01f, 0.85f),	// front right corner
+		"wood", 1.0f, 1.0f,	// Using wood texture for table legs
+		"wood1");
 
 	/****************** Table Leg 3 (Back Right) *******************/
-	scaleXYZ = glm::vec3(0.5f, 8.0f, 0.5f); 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(16.3f, -7.01f, -31.0f); // back right corner
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Same brown as table
-	SetShaderTexture("wood"); // Using wood texture for table legs
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("wood1");
-	
-	m_basicMeshes->DrawCylinderMesh();
-
-	/****************** Table Leg 4 (Back Left) ********************/
-	scaleXYZ = glm::vec3(0.5f, 8.0f, 0.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(1.5f, -7.01f, -40.0f); // back left corner
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Same brown as table
-	SetShaderTexture("wood"); // Using wood texture for table legs
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("wood1");
-	
-	m_basicMeshes->DrawCylinderMesh();
-
-	/****************** Chair Seat *********************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(6.4f, 0.3f, 5.5f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 30.0f;  // Rotateed for angled view
-	ZrotationDegrees = 0.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-9.98f, -2.010f, 2.73f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table
-
-	SetShaderTexture("wood"); //Same material as table
-	SetTextureUVScale(1.0f, 1.0f); 
-	SetShaderMaterial("wood1");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-
-	/****************** Chair Seat Cushion ****************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(3.0f, 0.4f, 2.6f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 30.0f;  // Rotateed for angled view
-	ZrotationDegrees = 0.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-9.98f, -1.86f, 2.73f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table
-
-	SetShaderTexture("fabric02"); //Same material as tablecloth
-	SetTextureUVScale(1.0f, 100.0f); // The texture is repeated to give it an artistic look and keeping the number of texture down 
-	SetShaderMaterial("fabric03");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawHalfSphereMesh();
-
-	/****************** Chair Back *********************************/ 
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(6.5f, 0.3f, 5.5f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 30.0f;  // Rotateed for angled view
-	ZrotationDegrees = 90.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-12.7f, 1.092f, 4.3f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table
-
-	SetShaderTexture("wood");// Same material as table
-	SetTextureUVScale(1.0f, 1.0f); 
-	SetShaderMaterial("wood1");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
-
-	//******************** Chair Leg 1 (Back Left) *******************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.25f, 5.0f, 0.25f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 30.0f;  // Rotateed for angled view
-	ZrotationDegrees = 0.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-13.5f, -7.092f, 2.38f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table
-
-	SetShaderTexture("wood"); // Same material as table
-	SetTextureUVScale(1.0f, 1.0f); 
-	SetShaderMaterial("wood1");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	//******************** Chair Leg 2 (Front Right) *******************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.25f, 5.0f, 0.25f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 30.0f;  // Rotateed for angled view
-	ZrotationDegrees = 0.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-6.6f, -7.092f, 3.5f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table
-
-	SetShaderTexture("wood"); // Same material as table
-	SetTextureUVScale(1.0f, 1.0f); 
-	SetShaderMaterial("wood1");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	//******************** Chair Leg 3 (Front Left) *******************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.25f, 5.0f, 0.25f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 30.0f;  // Rotateed for angled view
-	ZrotationDegrees = 0.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-8.7f, -7.092f, -0.47f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table
-
-	SetShaderTexture("wood"); // Same material as table
-	SetTextureUVScale(1.0f, 1.0f); 
-	SetShaderMaterial("wood1");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	/******************** Chair Leg 4 (Back Right) *******************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.25f, 5.0f, 0.25f);
-	// set the XYZ rotation for the mesh 
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 30.0f;  // Rotateed for angled view
-	ZrotationDegrees = 0.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-11.2f, -7.092f, 6.1f);
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Brown table
-
-	SetShaderTexture("wood"); // Same material as table
-	SetTextureUVScale(1.0f, 1.0f); 
-	SetShaderMaterial("wood1");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	/****************** Laptop Base *********************************/
-	scaleXYZ = glm::vec3(8.0f, 0.2f, 4.0f); // flat and wide
-	XrotationDegrees = 0.0f; //adjusted to match the photo
-	YrotationDegrees = -0.78f; 
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-13.05f, 1.13f, -9.0f); // slightly above table
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);  // Dark grey for laptop base
-	
-	SetShaderTexture("Onyx1"); // Using Onyx1 texture for laptop base; It was the closest texture I could find to match the photo
-	SetTextureUVScale(5.0f, 5.0f); // I up the scale to 5.0f to make the texture look more like the photo
-	SetShaderMaterial("Onyx2");
-
-	m_basicMeshes->DrawBoxMesh();
-
-	/****************** Laptop Base (Keyboard) **********************/
-	scaleXYZ = glm::vec3(6.0f, 0.2f, 2.75f); // flat and wide
-	XrotationDegrees = 0.0f; //adjusted to match the photo
-	YrotationDegrees = -0.78f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-13.05f, 1.2f, -9.0f); // slightly above table
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);  // Dark grey for laptop base
-
-	SetShaderTexture("keyboard"); // Texture for the laptop keyboard
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("keyboard1");
-
-	m_basicMeshes->DrawBoxMesh();
-
-	/****************** Laptop Top ********************************/
-	scaleXYZ = glm::vec3(8.0f, 0.1f, 4.0f); // thin
-	XrotationDegrees = 81.46f; //adjusted to match the photo
-	YrotationDegrees = 0.0f; 
-	ZrotationDegrees = 0.0; 
-	positionXYZ = glm::vec3(-13.05f, 3.0f, -11.3f); // lifted behind the base
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f);  // Even darker grey
-	SetShaderTexture("laptop"); // Using laptop texture for top; It was the closest texture I could find to match the photo
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("laptop1");
-	
-	m_basicMeshes->DrawBoxMesh();
-
-	/****************** Laptop Screen *****************************/
-	scaleXYZ = glm::vec3(7.0f, 0.01f, 3.0f); // thin, like a screen
-	XrotationDegrees = 81.5f; //adjusted to match the photo
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-13.03f, 2.96f, -11.2f); // lifted behind the base and in front of Laptop Top
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.1f, 0.1f, 1.0f, 1.0f);  // Blue for screen
-	SetShaderTexture("matrix"); // I used the matrix texture for the screen because it is how I feel when I am coding
-	SetTextureUVScale(1.0f, 1.0f);
-	//SetShaderMaterial("matrix1"); // I did not use a material for the screen because the texture alone looks better.
-	
-	m_basicMeshes->DrawBoxMesh();
-
-	/****************** Mousepad ***********************************/
-	scaleXYZ = glm::vec3(3.8f, 0.03f, 3.8f); // flat and wide
-	XrotationDegrees = 0.0f; //adjusted to match the photo
-	YrotationDegrees = 320.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-4.05f, 1.1f, -4.75f); // slightly above table
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);  // Dark grey for positioning 
-
-	SetShaderTexture("mousepad"); // I tried to use a photo of my mousepad but it did not look good so I used the mousepad texture
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("mousepad1");
-
-	m_basicMeshes->DrawBoxMesh();
-
-	/****************** Mouse ************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.35f, 0.17f, 0.55f);
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 140.0f;
-	ZrotationDegrees = 0.0f;
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-4.05f, 1.18f, -4.55f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);
-	SetShaderTexture("mouse1"); 
-	SetTextureUVScale(1.0f, 0.6f);
-	SetShaderMaterial("mouse2");
-
-	m_basicMeshes->DrawSphereMesh();
-
-	/****************** Water Bottle Base ************************/
-	scaleXYZ = glm::vec3(0.6f, 2.75f, 0.6f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-1.0f, 1.05f, -9.75f); // front left corner
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  //Different color to set position
-	SetShaderTexture("black_metal"); // Using black metal texture for water bottle base
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("black_metal1");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	/****************** Water Bottle Steel Ring ***************************/
-	scaleXYZ = glm::vec3(0.46f, 0.05f, 0.46f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-1.0f, 3.80f, -9.75f); // front left corner
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Different color to set position
-
-	SetShaderTexture("stainless"); // Using black metal texture for water bottle cap
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("stainless1");
-
-	m_basicMeshes->DrawCylinderMesh();
-
-	/****************** Water Bottle Cap ***************************/
-	scaleXYZ = glm::vec3(0.45f, 0.3f, 0.45f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-1.0f, 3.80f, -9.75f); // front left corner
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Different color to set position
-
-	SetShaderTexture("black_metal"); // Using black metal texture for water bottle cap
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("black_metal1");
-
-	m_basicMeshes->DrawCylinderMesh();
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.5f, 8.0f, 0.5f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(16.3f, -7.01f, -31.0f),	// back right corner
+		"wood", 1.0f, 1.0f,	// Using wood texture for table legs
+		"wood1");
+
+	/****************** Table Leg 4 (Back Left) *******************/
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.5f, 8.0f, 0.5f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(1.5f, -7.01f, -40.0f),	// back left corner
+		"wood", 1.0f, 1.0f,	// Using wood texture for table legs
+		"wood1");
+
+	/****************** Chair Seat *******************/
+	AddSceneObject(MESH_BOX,
+		glm::vec3(6.4f, 0.3f, 5.5f),
+		0.0f, 30.0f, 0.0f,	// Rotated for angled view
+		glm::vec3(-9.98f, -2.010f, 2.73f),
+		"wood", 1.0f, 1.0f,	// Same material as table
+		"wood1");
+
+	/****************** Chair Seat Cushion *******************/
+	AddSceneObject(MESH_HALF_SPHERE,
+		glm::vec3(3.0f, 0.4f, 2.6f),
+		0.0f, 30.0f, 0.0f,	// Rotated for angled view
+		glm::vec3(-9.98f, -1.86f, 2.73f),
+		"fabric02", 1.0f, 100.0f,	// Same material as tablecloth
+		"fabric03");
+
+	/****************** Chair Back *******************/
+	AddSceneObject(MESH_BOX,
+		glm::vec3(6.5f, 0.3f, 5.5f),
+		0.0f, 30.0f, 90.0f,	// Rotated for angled view
+		glm::vec3(-12.7f, 1.092f, 4.3f),
+		"wood", 1.0f, 1.0f,	// Same material as table
+		"wood1");
+
+	/****************** Chair Leg 1 (Back Left) *******************/
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.25f, 5.0f, 0.25f),
+		0.0f, 30.0f, 0.0f,	// Rotated for angled view
+		glm::vec3(-13.5f, -7.092f, 2.38f),
+		"wood", 1.0f, 1.0f,	// Same material as table
+		"wood1");
+
+	/****************** Chair Leg 2 (Front Right) *******************/
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.25f, 5.0f, 0.25f),
+		0.0f, 30.0f, 0.0f,	// Rotated for angled view
+		glm::vec3(-6.6f, -7.092f, 3.5f),
+		"wood", 1.0f, 1.0f,	// Same material as table
+		"wood1");
+
+	/****************** Chair Leg 3 (Front Left) *******************/
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.25f, 5.0f, 0.25f),
+		0.0f, 30.0f, 0.0f,	// Rotated for angled view
+		glm::vec3(-8.7f, -7.092f, -0.47f),
+		"wood", 1.0f, 1.0f,	// Same material as table
+		"wood1");
+
+	/****************** Chair Leg 4 (Back Right) *******************/
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.25f, 5.0f, 0.25f),
+		0.0f, 30.0f, 0.0f,	// Rotated for angled view
+		glm::vec3(-11.2f, -7.092f, 6.1f),
+		"wood", 1.0f, 1.0f,	// Same material as table
+		"wood1");
+
+	/****************** Laptop Base *******************/
+	AddSceneObject(MESH_BOX,
+		glm::vec3(8.0f, 0.2f, 4.0f),	// flat and wide
+		0.0f, -0.78f, 0.0f,
+		glm::vec3(-13.05f, 1.13f, -9.0f),	// slightly above table
+		"Onyx1", 5.0f, 5.0f,	// Using Onyx1 texture for laptop base; It was the closest texture I could find to match the photo
+		"Onyx2");
+
+	/****************** Laptop Base (Keyboard) *******************/
+	AddSceneObject(MESH_BOX,
+		glm::vec3(6.0f, 0.2f, 2.75f),	// flat and wide
+		0.0f, -0.78f, 0.0f,
+		glm::vec3(-13.05f, 1.2f, -9.0f),	// slightly above table
+		"keyboard", 1.0f, 1.0f,	// Texture for the laptop keyboard
+		"keyboard1");
+
+	/****************** Laptop Top *******************/
+	AddSceneObject(MESH_BOX,
+		glm::vec3(8.0f, 0.1f, 4.0f),	// thin
+		81.46f, 0.0f, 0.0f,
+		glm::vec3(-13.05f, 3.0f, -11.3f),	// lifted behind the base
+		"laptop", 1.0f, 1.0f,	// Using laptop texture for top; It was the closest texture I could find to match the photo
+		"laptop1");
+
+	/****************** Laptop Screen *******************/
+	AddSceneObject(MESH_BOX,
+		glm::vec3(7.0f, 0.01f, 3.0f),	// thin, like a screen
+		81.5f, 0.0f, 0.0f,
+		glm::vec3(-13.03f, 2.96f, -11.2f),	// lifted behind the base and in front of Laptop Top
+		"matrix", 1.0f, 1.0f,	// I used the matrix texture for the screen because it is how I feel when I am coding
+		"");	// I did not use a material for the screen because the texture alone looks better.
+
+	/****************** Mousepad *******************/
+	AddSceneObject(MESH_BOX,
+		glm::vec3(3.8f, 0.03f, 3.8f),	// flat and wide
+		0.0f, 320.0f, 0.0f,
+		glm::vec3(-4.05f, 1.1f, -4.75f),	// slightly above table
+		"mousepad", 1.0f, 1.0f,	// I tried to use a photo of my mousepad but it did not look good so I used the mousepad texture
+		"mousepad1");
+
+	/****************** Mouse *******************/
+	AddSceneObject(MESH_SPHERE,
+		glm::vec3(0.35f, 0.17f, 0.55f),
+		0.0f, 140.0f, 0.0f,
+		glm::vec3(-4.05f, 1.18f, -4.55f),
+		"mouse1", 1.0f, 0.6f,
+		"mouse2");
+
+	/****************** Water Bottle Base *******************/
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.6f, 2.75f, 0.6f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-1.0f, 1.05f, -9.75f),	// front left corner
+		"black_metal", 1.0f, 1.0f,	// Using black metal texture for water bottle base
+		"black_metal1");
+
+	/****************** Water Bottle Steel Ring *******************/
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.46f, 0.05f, 0.46f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-1.0f, 3.80f, -9.75f),	// front left corner
+		"stainless", 1.0f, 1.0f,	// Using black metal texture for water bottle cap
+		"stainless_end1");
+
+	/****************** Water Bottle Cap *******************/
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.45f, 0.3f, 0.45f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-1.0f, 3.80f, -9.75f),	// front left corner
+		"black_metal", 1.0f, 1.0f,	// Using black metal texture for water bottle cap
+		"black_metal1");
 
 	/****************** Water Bottle Mouthpiece *******************/
-	scaleXYZ = glm::vec3(0.06f, 0.45f, 0.03f);
-	XrotationDegrees = 10.0f;
-	YrotationDegrees = -40.0f;
-	ZrotationDegrees = 15.0f;
-	positionXYZ = glm::vec3(-1.3f, 3.93f, -9.7f); // front left corner
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  // Different color to set position
-
-	SetShaderTexture("laptop"); // Using laptop texture for mouthpiece because they are similar
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("laptop1");
-
-
-	m_basicMeshes->DrawCylinderMesh();
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.06f, 0.45f, 0.03f),
+		10.0f, -40.0f, 15.0f,
+		glm::vec3(-1.3f, 3.93f, -9.7f),	// front left corner
+		"laptop", 1.0f, 1.0f,	// Using laptop texture for mouthpiece because they are similar
+		"laptop1");
 
 	/****************** Wax candle 1 *******************/
-	scaleXYZ = glm::vec3(0.1f, 3.5f, 0.1f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-2.0f, 1.18, -20.0f); // Candle closer to the Laptop
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  //Different color to set position
-	SetShaderTexture("wax"); // Using wax texture for candle
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("wax1");
-
-	m_basicMeshes->DrawCylinderMesh();
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.1f, 3.5f, 0.1f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-2.0f, 1.18, -20.0f),	// Candle closer to the Laptop
+		"wax", 1.0f, 1.0f,	// Using wax texture for candle
+		"wax1");
 
 	/****************** Glass Candle Holder Base 1 *******************/
-	scaleXYZ = glm::vec3(0.5f, 0.5f, 0.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 95.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-2.0f, 1.05, -20.0f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);  //Different color to set position
-	SetShaderTexture("glass"); // Using glass texture for candle holder base
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("glass1");
-
-	m_basicMeshes->DrawConeMesh();
+	AddSceneObject(MESH_CONE,
+		glm::vec3(0.5f, 0.5f, 0.5f),
+		0.0f, 95.0f, 0.0f,
+		glm::vec3(-2.0f, 1.05, -20.0f),
+		"glass", 1.0f, 1.0f,	// Using glass texture for candle holder base
+		"glass1",
+		true);
 
 	/****************** Glass Candle Holder Stem 1 *******************/
-	scaleXYZ = glm::vec3(0.13f, 0.4f, 0.13f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 95.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-2.0f, 1.2, -20.0f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);  //Different color to set position
-	SetShaderTexture("glass"); // Using glass texture for candle holder base
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("glass1");
-
-	m_basicMeshes->DrawCylinderMesh();
-
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.13f, 0.4f, 0.13f),
+		0.0f, 95.0f, 0.0f,
+		glm::vec3(-2.0f, 1.2, -20.0f),
+		"glass", 1.0f, 1.0f,	// Using glass texture for candle holder base
+		"glass1",
+		true);
 
 	/****************** Wax candle 2 *******************/
-	scaleXYZ = glm::vec3(0.1f, 3.5f, 0.1f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(4.4f, 1.18, -30.0f); // Candle 2 positioned at the far side of the table
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  //Different color to set position
-	SetShaderTexture("wax"); // Using wax texture for candle
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("wax1");
-
-	m_basicMeshes->DrawCylinderMesh();
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.1f, 3.5f, 0.1f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(4.4f, 1.18, -30.0f),	// Candle 2 positioned at the far side of the table
+		"wax", 1.0f, 1.0f,	// Using wax texture for candle
+		"wax1");
 
 	/****************** Glass Candle Holder Base 2 *******************/
-	scaleXYZ = glm::vec3(0.5f, 0.5f, 0.5f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 95.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(4.4f, 1.05, -30.0f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);  //Different color to set position
-	SetShaderTexture("glass"); // Using glass texture for candle holder base
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("glass1");
-
-	m_basicMeshes->DrawConeMesh();
+	AddSceneObject(MESH_CONE,
+		glm::vec3(0.5f, 0.5f, 0.5f),
+		0.0f, 95.0f, 0.0f,
+		glm::vec3(4.4f, 1.05, -30.0f),
+		"glass", 1.0f, 1.0f,	// Using glass texture for candle holder base
+		"glass1",
+		true);
 
 	/****************** Glass Candle Holder Stem 2 *******************/
-	scaleXYZ = glm::vec3(0.13f, 0.4f, 0.13f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 95.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(4.4f, 1.2, -30.0f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);  //Different color to set position
-	SetShaderTexture("glass"); // Using glass texture for candle holder base
-	SetTextureUVScale(1.0f, 1.0f);
-	SetShaderMaterial("glass1");
-
-	m_basicMeshes->DrawCylinderMesh();
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.13f, 0.4f, 0.13f),
+		0.0f, 95.0f, 0.0f,
+		glm::vec3(4.4f, 1.2, -30.0f),
+		"glass", 1.0f, 1.0f,	// Using glass texture for candle holder base
+		"glass1",
+		true);
 
 	/****************** Flame - Wax candle 1 *******************/
-	scaleXYZ = glm::vec3(0.1f, 0.37f, 0.1f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(-2.0f, 5.0f, -20.0f); // On top of the first candle
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  //Different color to set position
-	SetShaderTexture("flame"); // Using flame texture for candle flame
-	SetTextureUVScale(3.0f, 3.0f);
-	SetShaderMaterial("flame1");
-
-	m_basicMeshes->DrawSphereMesh();
+	AddSceneObject(MESH_SPHERE,
+		glm::vec3(0.1f, 0.37f, 0.1f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(-2.0f, 5.0f, -20.0f),	// On top of the first candle
+		"flame", 3.0f, 3.0f,	// Using flame texture for candle flame
+		"flame1",
+		true);
 
 	/****************** Flame - Wax candle 2 *******************/
-	scaleXYZ = glm::vec3(0.1f, 0.37f, 0.1f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(4.4f, 5.0f, -30.0f); // On top of the second candle
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.6f, 0.4f, 0.2f, 1.0f);  //Different color to set position
-	SetShaderTexture("flame"); // Using flame texture for candle flame
-	SetTextureUVScale(3.0f, 3.0f);
-	SetShaderMaterial("flame1");
-
-	m_basicMeshes->DrawSphereMesh();
+	AddSceneObject(MESH_SPHERE,
+		glm::vec3(0.1f, 0.37f, 0.1f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(4.4f, 5.0f, -30.0f),	// On top of the second candle
+		"flame", 3.0f, 3.0f,	// Using flame texture for candle flame
+		"flame1",
+		true);
 
 	/****************** Salt base 1 *******************/
-	scaleXYZ = glm::vec3(0.4f, 0.2f, 0.4f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 1.03, -23.0f); // Positioned in the middle of the table between the candles
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(1.0f, 0.1f, 0.1f, 1.0f);  //Different color to set position
-	SetShaderTexture("salt1"); // Using salt texture 
-	SetTextureUVScale(1.0f, 0.5f);
-	SetShaderMaterial("salt2");
-
-	m_basicMeshes->DrawCylinderMesh();
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.4f, 0.2f, 0.4f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 1.03, -23.0f),	// Positioned in the middle of the table between the candles
+		"salt1", 1.0f, 0.5f,	// Using salt texture
+		"salt2");
 
 	/****************** Salt base 2 *******************/
-	scaleXYZ = glm::vec3(0.45f, 0.36f, 0.45f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 1.37, -23.0f); // Positioned in the middle of the table between the candles slightly above the first base
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);  //Different color to set position
-	SetShaderTexture("salt1"); // Using salt texture
-	SetTextureUVScale(1.0f, 3.0f);
-	SetShaderMaterial("salt2");
-
-	m_basicMeshes->DrawSphereMesh();
+	AddSceneObject(MESH_SPHERE,
+		glm::vec3(0.45f, 0.36f, 0.45f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 1.37, -23.0f),	// Positioned in the middle of the table between the candles slightly above the first base
+		"salt1", 1.0f, 3.0f,	// Using salt texture
+		"salt2");
 
 	/****************** Salt base 3 *******************/
-	scaleXYZ = glm::vec3(0.4f, 0.2f, 0.4f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 1.46, -23.0f); // Positioned in the middle of the table between the candles sightly above the second base
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);  //Different color to set position
-	SetShaderTexture("salt1"); // Using salt texture
-	SetTextureUVScale(1.0f, 0.5f);
-	SetShaderMaterial("salt2");
-
-	m_basicMeshes->DrawCylinderMesh();
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.4f, 0.2f, 0.4f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 1.46, -23.0f),	// Positioned in the middle of the table between the candles sightly above the second base
+		"salt1", 1.0f, 0.5f,	// Using salt texture
+		"salt2");
 
 	/****************** Salt Cap *******************/
-	scaleXYZ = glm::vec3(0.32f, 0.2f, 0.32f);
-	XrotationDegrees = 360.0f;
-	YrotationDegrees = 90.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(0.0f, 1.67, -23.0f); // Positioned in the middle of the table between the candles on top of the third base
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);  //Different color to set position
-	SetShaderTexture("cap2"); // Using cap2 texture for salt cap (The texture comes from a photo of a salt shaker cover)
-	SetTextureUVScale(1.0, 3.5f);
-	SetShaderMaterial("cap3");
-
-	m_basicMeshes->DrawHalfSphereMesh();
+	AddSceneObject(MESH_HALF_SPHERE,
+		glm::vec3(0.32f, 0.2f, 0.32f),
+		360.0f, 90.0f, 0.0f,
+		glm::vec3(0.0f, 1.67, -23.0f),	// Positioned in the middle of the table between the candles on top of the third base
+		"cap2", 1.0f, 3.5f,	// Using cap2 texture for salt cap (The texture comes from a photo of a salt shaker cover)
+		"cap3");
 
 	/****************** Pepper base 1 *******************/
-	scaleXYZ = glm::vec3(0.4f, 0.2f, 0.4f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(2.4f, 1.03, -26.5f); // Positioned closer to candle 2 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.0f, 0.0f, 0.0f, 1.0f);  //Different color to set position
-	SetShaderTexture("pepper"); // Using pepper texture for pepper base
-	SetTextureUVScale(1.0f, 0.5f);
-	SetShaderMaterial("pepper1");
-
-	m_basicMeshes->DrawCylinderMesh();
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.4f, 0.2f, 0.4f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(2.4f, 1.03, -26.5f),	// Positioned closer to candle 2
+		"pepper", 1.0f, 0.5f,	// Using pepper texture for pepper base
+		"pepper1");
 
 	/****************** Pepper base 2 *******************/
-	scaleXYZ = glm::vec3(0.45f, 0.36f, 0.45f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(2.4f, 1.37, -26.5f); // Positioned closer to candle 2 slightly above the first base
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.0f, 0.0f, 0.0f, 1.0f);  //Different color to set position
-	SetShaderTexture("pepper"); // Using pepper texture for pepper base
-	SetTextureUVScale(1.0f, 3.0f);
-	SetShaderMaterial("pepper1");
-
-	m_basicMeshes->DrawSphereMesh();
+	AddSceneObject(MESH_SPHERE,
+		glm::vec3(0.45f, 0.36f, 0.45f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(2.4f, 1.37, -26.5f),	// Positioned closer to candle 2 slightly above the first base
+		"pepper", 1.0f, 3.0f,	// Using pepper texture for pepper base
+		"pepper1");
 
 	/****************** Pepper base 3 *******************/
-	scaleXYZ = glm::vec3(0.4f, 0.2f, 0.4f);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(2.4f, 1.46, -26.5f); // Positioned closer to candle 2 slightly above the second base
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.0f, 0.0f, 0.0f, 1.0f);  //Different color to set position
-	SetShaderTexture("pepper"); // Using a pepper texture for pepper base
-	SetTextureUVScale(1.0f, 0.5f);
-	SetShaderMaterial("pepper1");
-
-	m_basicMeshes->DrawCylinderMesh();
+	AddSceneObject(MESH_CYLINDER,
+		glm::vec3(0.4f, 0.2f, 0.4f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(2.4f, 1.46, -26.5f),	// Positioned closer to candle 2 slightly above the second base
+		"pepper", 1.0f, 0.5f,	// Using a pepper texture for pepper base
+		"pepper1");
 
 	/****************** Peper Cap *******************/
-	scaleXYZ = glm::vec3(0.32f, 0.2f, 0.32f);
-	XrotationDegrees = 360.0f;
-	YrotationDegrees = 90.0f;
-	ZrotationDegrees = 0.0f;
-	positionXYZ = glm::vec3(2.4f, 1.67, -26.5f); // Positioned closer to candle 2 on top of the third base
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);  //Different color to set position
-	SetShaderTexture("cap2"); // Using a cap2 texture for pepper cap (The texture comes from a photo of a salt shaker cover)
-	SetTextureUVScale(1.0, 3.5f);
-	SetShaderMaterial("cap3");
+	AddSceneObject(MESH_HALF_SPHERE,
+		glm::vec3(0.32f, 0.2f, 0.32f),
+		360.0f, 90.0f, 0.0f,
+		glm::vec3(2.4f, 1.67, -26.5f),	// Positioned closer to candle 2 on top of the third base
+		"cap2", 1.0f, 3.5f,	// Using a cap2 texture for pepper cap (The texture comes from a photo of a salt shaker cover)
+		"cap3");
+}
 
-	m_basicMeshes->DrawHalfSphereMesh();
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by
+ *  drawing the retained draw records as instanced batches
+ *  with their cached model matrices - the opaque batches
+ *  first, after an optional depth pre-pass, and then the
+ *  transparent batches with blending
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	// replace the placeholders of the textures decoded so far
+	{
+		ProfileZone zone(m_pProfiler, m_textureUploadZone);
+		UploadDecodedTextures();
+	}
 
+	{
+		ProfileZone zone(m_pProfiler, m_cullingZone);
+
+		// only rebuild the matrices of objects that have changed
+		UpdateDirtyTransforms();
+		// skip the objects outside of the view frustum and draw
+		// small round objects with fewer triangles
+		CullDrawRecords();
+		SelectLevelsOfDetail();
+
+		// the queue is sorted by the distance from the camera, so
+		// it is sorted again once the camera has moved far enough
+		glm::vec3 viewPosition = GetViewPosition();
+		glm::vec3 moved = viewPosition - m_sortViewPosition;
+		if (glm::dot(moved, moved) > g_ResortDistance * g_ResortDistance)
+		{
+			m_sortViewPosition = viewPosition;
+			m_bRenderQueueDirty = true;
+		}
+		if (m_bRenderQueueDirty == true)
+		{
+			BuildRenderQueue();
+		}
+	}
 
-}
\ No newline at end of file
+	{
+		ProfileZone zone(m_pProfiler, m_lightBinningZone);
+		m_pLightClusters->Update(m_view, m_projection, m_viewportWidth, m_viewportHeight);
+	}
+
+	if (m_bInstanceDataDirty == true)
+	{
+		ProfileZone zone(m_pProfiler, m_instanceUploadZone);
+		UpdateInstanceData();
+	}
+
+	// every mesh is drawn from the same vertex array
+	m_basicMeshes->BindGeometry();
+
+	// the opaque objects write the depth in a pre-pass without
+	// shading, and are then only shaded where they are in front
+	if (IsDepthPrepass() == true)
+	{
+		ProfileZone zone(m_pProfiler, m_depthPrepassZone);
+		m_pShaderState->UseProgram(m_depthProgramID);
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		DrawBatches(0, m_firstTransparentBatch, false);
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+		glDepthFunc(GL_LEQUAL);
+		glDepthMask(GL_FALSE);
+	}
+	DrawBatches(0, m_firstTransparentBatch, true);
+	glDepthFunc(GL_LESS);
+
+	// only the transparent objects are blended, without writing
+	// the depth so the ones behind them still show
+	if (m_firstTransparentBatch < m_drawBatches.size())
+	{
+		glEnable(GL_BLEND);
+		glDepthMask(GL_FALSE);
+		DrawBatches(m_firstTransparentBatch, (int)m_drawBatches.size(), true);
+		glDisable(GL_BLEND);
+	}
+	glDepthMask(GL_TRUE);
+
+	m_bSceneChanged = false;
+}
+
+/***********************************************************
+ *  DrawBatches()
+ *
+ *  This method is used for drawing the passed in range of
+ *  the draw batches, each with the program of its shader
+ *  variant unless only depth is drawn.  With indirect
+ *  drawing, each run of batches with the same variant and
+ *  texture page is drawn with one call, and a depth only
+ *  range is drawn with a single call.
+ ***********************************************************/
+void SceneManager::DrawBatches(int firstBatch, int endBatch, bool bBindTextures)
+{
+	if (IsIndirectDrawing() == true)
+	{
+		while (firstBatch < endBatch)
+		{
+			int shaderVariant = m_drawBatches[firstBatch].shaderVariant;
+			int texturePage = m_drawBatches[firstBatch].texturePage;
+			int runEnd = firstBatch + 1;
+			while ((runEnd < endBatch) &&
+				((bBindTextures == false) ||
+				((m_drawBatches[runEnd].shaderVariant == shaderVariant) &&
+				(m_drawBatches[runEnd].texturePage == texturePage))))
+			{
+				runEnd++;
+			}
+
+			if (bBindTextures == true)
+			{
+				ProfileZone zone(m_pProfiler, m_textureBindingZone);
+				UseShaderVariant(shaderVariant);
+				if ((shaderVariant & VARIANT_TEXTURED) != 0)
+				{
+					SetShaderTexturePage(texturePage);
+				}
+			}
+			{
+				ProfileZone zone(m_pProfiler, m_indirectDrawZone);
+				m_basicMeshes->DrawIndirect(firstBatch, runEnd - firstBatch);
+			}
+			firstBatch = runEnd;
+		}
+		return;
+	}
+
+	for (int i = firstBatch; i < endBatch; i++)
+	{
+		const DRAW_BATCH& batch = m_drawBatches[i];
+		if (bBindTextures == true)
+		{
+			ProfileZone zone(m_pProfiler, m_textureBindingZone);
+			UseShaderVariant(batch.shaderVariant);
+			if ((batch.shaderVariant & VARIANT_TEXTURED) != 0)
+			{
+				SetShaderTexturePage(batch.texturePage);
+			}
+		}
+		{
+			ProfileZone zone(m_pProfiler, m_drawZones[batch.meshID]);
+			DrawMeshInstanced(batch.meshID, batch.lodLevel, batch.instanceCount, batch.firstInstance);
+		}
+	}
+}
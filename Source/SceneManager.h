@@ -10,9 +10,23 @@
 #pragma once
 
 #include "ShaderManager.h"
-#include "ShapeMeshes.h"
+#include "ShaderStateCache.h"
+#include "ProgramCache.h"
+#include "UniformBuffer.h"
+#include "PrimitiveMeshes.h"
+#include "TextureRegistry.h"
+#include "TextureCache.h"
+#include "FrustumCuller.h"
+#include "LightClusters.h"
+#include "FrameProfiler.h"
+#include "RenderStats.h"
+#include "GpuMemoryTracker.h"
+#include "SceneFile.h"
+#include "JobPool.h"
 
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 /***********************************************************
@@ -25,15 +39,21 @@ class SceneManager
 {
 public:
 	// constructor
-	SceneManager(ShaderManager *pShaderManager);
+	SceneManager(
+		ShaderManager *pShaderManager,
+		ShaderStateCache* pShaderState,
+		ProgramCache* pProgramCache,
+		JobPool* pJobPool,
+		FrameProfiler* pProfiler = NULL,
+		RenderStats* pRenderStats = NULL,
+		GpuMemoryTracker* pMemoryTracker = NULL);
 	// destructor
 	~SceneManager();
 
-	struct TEXTURE_INFO
-	{
-		std::string tag;
-		uint32_t ID;
-	};
+	// interned handles of the registered texture and material tags
+	typedef int TEXTURE_HANDLE;
+	typedef int MATERIAL_HANDLE;
+	static const int INVALID_HANDLE = -1;
 
 	struct OBJECT_MATERIAL
 	{
@@ -45,72 +65,371 @@ public:
 		std::string tag;
 	};
 
+	// std140 layout of one light source in the LightBlock uniform block
+	struct LIGHT_SOURCE
+	{
+		glm::vec3 position;
+		float focalStrength;
+		glm::vec3 ambientColor;
+		float specularIntensity;
+		glm::vec3 diffuseColor;
+		// distance at which the light has faded out, or 0 for a
+		// light that reaches everything
+		float range;
+		glm::vec3 specularColor;
+		float padding;
+	};
+
+	// most light sources in the LightBlock uniform block
+	static const int MAX_LIGHTS = 256;
+
+	// std140 layout of one material in the MaterialBlock uniform block
+	struct GPU_MATERIAL
+	{
+		glm::vec3 ambientColor;
+		float ambientStrength;
+		glm::vec3 diffuseColor;
+		float shininess;
+		glm::vec3 specularColor;
+		float padding;
+	};
+
+	// number of materials in the MaterialBlock uniform block, the
+	// first of which is the default material of the objects whose
+	// material is missing or unknown
+	static const int MAX_MATERIALS = 256;
+	static const int DEFAULT_MATERIAL = 0;
+
+	// identifiers for the basic meshes that can be drawn
+	enum MESH_ID
+	{
+		MESH_PLANE = 0,
+		MESH_BOX,
+		MESH_CYLINDER,
+		MESH_CONE,
+		MESH_SPHERE,
+		MESH_HALF_SPHERE
+	};
+
+	// bits selecting the shader program variant a draw record
+	// is shaded with, each one a #define of the shader sources
+	enum SHADER_VARIANT
+	{
+		VARIANT_TEXTURED = 1,
+		VARIANT_LIT = 2,
+		VARIANT_COUNT = 4
+	};
+
+	// retained draw record for one object in the 3D scene
+	struct DRAW_RECORD
+	{
+		MESH_ID meshID;
+		TEXTURE_HANDLE textureSlot;
+		MATERIAL_HANDLE materialIndex;
+		glm::vec2 UVscale;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+		glm::mat4 modelMatrix;
+		int lodLevel;
+		int shaderVariant;
+		bool bDirty;
+		bool bTransparent;
+	};
+
+	// consecutive render queue entries drawn with one instanced call
+	struct DRAW_BATCH
+	{
+		MESH_ID meshID;
+		int lodLevel;
+		int shaderVariant;
+		int texturePage;
+		int firstInstance;
+		int instanceCount;
+		bool bTransparent;
+	};
+
 private:
+	// image decoded on a worker thread, waiting to be uploaded
+	struct DECODED_IMAGE
+	{
+		TEXTURE_HANDLE textureHandle;
+		std::string filename;
+		// compressed texture from the texture cache, or the
+		// decoded image when the cache is not used
+		TextureCache::COMPRESSED_TEXTURE* pCompressed;
+		unsigned char* pImage;
+		int width;
+		int height;
+		int colorChannels;
+	};
+
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
+	// cached uniform locations and values of the shader program
+	ShaderStateCache* m_pShaderState;
+	// compiles the shader programs, or loads their binaries
+	ProgramCache* m_pProgramCache;
+	// handles of the uniforms that are written while rendering
+	ShaderStateCache::UNIFORM_HANDLE m_textureValueHandle;
+	// linked program of every shader variant, and true when the
+	// scene is shaded with its light sources
+	GLuint m_variantProgramIDs[VARIANT_COUNT];
+	bool m_bSceneLighting;
 	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[18];
+	PrimitiveMeshes* m_basicMeshes;
+	// GPU memory of the textures and meshes by category, not
+	// owned and may be NULL
+	GpuMemoryTracker* m_pMemoryTracker;
+	// loaded textures, stored as layers of array textures
+	TextureRegistry* m_pTextureRegistry;
+	// compressed copies of the texture images, NULL when the
+	// driver has no S3TC support
+	TextureCache* m_pTextureCache;
+	// worker threads decoding the texture images, not owned
+	JobPool* m_pJobPool;
+	// decoded images waiting for the main thread to upload them
+	std::vector<DECODED_IMAGE> m_decodedImages;
+	mutable std::mutex m_decodedImagesMutex;
+	// number of textures that are still showing the placeholder
+	int m_pendingTextures;
+	// image file of every texture, by tag
+	std::unordered_map<std::string, std::string> m_textureFilenames;
+	// scene file the scene was loaded from, empty for the
+	// built-in scene
+	std::string m_sceneFilename;
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// interned material handles by tag
+	std::unordered_map<std::string, MATERIAL_HANDLE> m_materialHandles;
+	// retained draw records for all the objects in the scene
+	std::vector<DRAW_RECORD> m_drawRecords;
+	// light sources of the scene and the uniform buffer holding
+	// them, with the light sources without a range first
+	std::vector<LIGHT_SOURCE> m_lightSources;
+	UniformBuffer* m_pLightBuffer;
+	// light lists of the view space clusters
+	LightClusters* m_pLightClusters;
+	ShaderStateCache::UNIFORM_HANDLE m_lightListsHandle;
+	// uniform buffer holding the compiled material table
+	UniformBuffer* m_pMaterialBuffer;
+	// draw record indices sorted by render state
+	std::vector<int> m_renderQueue;
+	// true when the render queue needs to be sorted again
+	bool m_bRenderQueueDirty;
+	// true when the objects, materials, lights, textures or the
+	// way they are drawn changed since the last rendered frame
+	bool m_bSceneChanged;
+	// squared distance of every draw record from the camera
+	// position the render queue was sorted for
+	std::vector<float> m_sortDistances;
+	glm::vec3 m_sortViewPosition;
+	// instanced draw calls and their per-instance data, in
+	// render queue order
+	std::vector<DRAW_BATCH> m_drawBatches;
+	std::vector<PrimitiveMeshes::INSTANCE_DATA> m_instanceData;
+	// draw record of every instance
+	std::vector<int> m_instanceRecords;
+	// true when the per-instance data needs to be written again
+	bool m_bInstanceDataDirty;
+	// indirect draw command of every draw batch, and true when
+	// the batches are submitted from them
+	std::vector<PrimitiveMeshes::DRAW_COMMAND> m_drawCommands;
+	bool m_bIndirectDrawing;
+	// index of the first transparent draw batch, which is the
+	// batch count when there are none
+	int m_firstTransparentBatch;
+	// depth only shader program of the depth pre-pass, and
+	// true when the pre-pass is drawn
+	GLuint m_depthProgramID;
+	bool m_bDepthPrepass;
+	// world-space bounding spheres of the draw records, tested
+	// against the view frustum every frame
+	FrustumCuller* m_pFrustumCuller;
+	// per draw record flags that are non-zero when the record
+	// was inside the view frustum in the last and this frame
+	std::vector<unsigned char> m_visibleRecords;
+	std::vector<unsigned char> m_cullResults;
+	int m_visibleCount;
+	// radius of the draw records on the screen in pixels, and
+	// the pixel size of one unit at distance 1
+	std::vector<float> m_projectedRadii;
+	float m_lodPixelScale;
+	// view the light sources are binned for
+	glm::mat4 m_view;
+	glm::mat4 m_projection;
+	int m_viewportWidth;
+	int m_viewportHeight;
+	// profiler measuring the render steps, not owned and NULL
+	// when profiling is off
+	FrameProfiler* m_pProfiler;
+	FrameProfiler::ZONE_HANDLE m_textureUploadZone;
+	FrameProfiler::ZONE_HANDLE m_cullingZone;
+	FrameProfiler::ZONE_HANDLE m_lightBinningZone;
+	FrameProfiler::ZONE_HANDLE m_instanceUploadZone;
+	FrameProfiler::ZONE_HANDLE m_textureBindingZone;
+	FrameProfiler::ZONE_HANDLE m_drawZones[MESH_HALF_SPHERE + 1];
+	FrameProfiler::ZONE_HANDLE m_indirectDrawZone;
+	FrameProfiler::ZONE_HANDLE m_depthPrepassZone;
+	// counters of the rendering work, not owned and may be NULL
+	RenderStats* m_pRenderStats;
 
 	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
+	bool CreateGLTexture(const char* filename, const std::string& tag);
+	// decode the image file of a texture on a worker thread
+	void DecodeTextureImage(TEXTURE_HANDLE textureHandle, const std::string& filename);
+	// upload the images decoded since the last frame
+	void UploadDecodedTextures();
+	// finish the loaded OpenGL textures for rendering
 	void BindGLTextures();
+	// evict the textures no object uses while the textures are
+	// over their memory budget
+	void EnforceTextureBudget();
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
 	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
+	TEXTURE_HANDLE FindTextureSlot(const std::string& tag);
 	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	MATERIAL_HANDLE FindMaterialIndex(const std::string& tag);
+
+	// set the texture page into the shader
+	void SetShaderTexturePage(
+		int texturePage);
+	// get the shader variant the passed in record is shaded with
+	int GetShaderVariant(const DRAW_RECORD& record) const;
+	// make the program of the passed in shader variant current
+	void UseShaderVariant(int shaderVariant);
 
-	// set the transformation values 
-	// into the transform buffer
-	void SetTransformations(
+	// add an object to the retained draw records
+	int AddSceneObject(
+		MESH_ID meshID,
 		glm::vec3 scaleXYZ,
 		float XrotationDegrees,
 		float YrotationDegrees,
 		float ZrotationDegrees,
-		glm::vec3 positionXYZ);
+		glm::vec3 positionXYZ,
+		const std::string& textureTag,
+		float u, float v,
+		const std::string& materialTag,
+		bool bTransparent = false);
 
-	// set the color values into the shader
-	void SetShaderColor(
-		float redColorValue,
-		float greenColorValue,
-		float blueColorValue,
-		float alphaValue);
+	// get the bounding sphere of a basic mesh in object space
+	void GetMeshBounds(
+		MESH_ID meshID,
+		glm::vec3& center,
+		float& radius);
 
-	// set the texture data into the shader
-	void SetShaderTexture(
-		std::string textureTag);
+	// run a loop over the draw records in parallel chunks
+	void RunParallel(int count, const std::function<void(int, int)>& job);
+	// rebuild the model matrices of the dirty draw records
+	void UpdateDirtyTransforms();
+	// flag the draw records that are inside the view frustum
+	void CullDrawRecords();
+	// pick the level of detail of the round meshes from their
+	// size on the screen
+	void SelectLevelsOfDetail();
+	// sort the draw records by render state
+	void BuildRenderQueue();
+	// write the per-instance data of the visible records in the
+	// render queue and group them into instanced draw batches
+	void UpdateInstanceData();
 
-	// set the UV scale for the texture mapping
-	void SetTextureUVScale(
-		float u, float v);
-
-	// set the object material into the shader
-	void SetShaderMaterial(
-		std::string materialTag);
+	// draw instances of the basic mesh with the passed in identifier
+	void DrawMeshInstanced(
+		MESH_ID meshID,
+		int lodLevel,
+		int instanceCount,
+		int firstInstance);
+	// draw a range of the draw batches, binding their texture
+	// pages unless only depth is drawn
+	void DrawBatches(int firstBatch, int endBatch, bool bBindTextures);
+	// get the world-space camera position of the current view
+	glm::vec3 GetViewPosition() const;
 
 
 public:
 
 	// The following methods are for the students to 
-	// customize for their own 3D scene
-	void PrepareScene();
+	// customize for their own 3D scene - the scene is loaded
+	// from the passed in scene file, or built by the methods
+	// below when there is none
+	void PrepareScene(const char* sceneFilename = NULL);
+	// load the textures, materials, lights and objects of the
+	// scene from a scene file, replacing the loaded scene
+	bool LoadSceneFile(const char* filename);
+	// get the scene file the scene was loaded from, empty for
+	// the built-in scene
+	const std::string& GetSceneFilename() const { return(m_sceneFilename); }
+	// get the image files of all the textures
+	void GetTextureFilenames(std::vector<std::string>& filenames) const;
+	// decode the textures using the passed in image file again,
+	// returning false when no texture uses it
+	bool ReloadTexture(const std::string& filename);
 	void RenderScene();
 	
 	// Loads textures from image files
 	void LoadSceneTextures();
+	// check whether texture images are still being decoded
+	bool IsLoadingTextures() const { return(m_pendingTextures > 0); }
+	// get the tracker of the GPU memory of the scene, or NULL
+	GpuMemoryTracker* GetMemoryTracker() const { return(m_pMemoryTracker); }
 	// define all the object materials before rendering
 	void DefineObjectMaterials();
+	// upload the defined materials into the material table
+	void CompileMaterialTable();
 	// add and define the light sources before rendering
 	void SetupSceneLights();
+	// upload the light sources into the light uniform buffer
+	void UploadSceneLights();
+	// add all the objects of the 3D scene to the draw records
+	void BuildSceneObjects();
+
+	// set the view and projection used for culling, for
+	// choosing the levels of detail and for binning the lights
+	void SetViewFrustum(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		int viewportWidth,
+		int viewportHeight);
+	// get the number of objects drawn in the last frame
+	int GetVisibleObjectCount() const { return(m_visibleCount); }
+	int GetObjectCount() const { return((int)m_drawRecords.size()); }
+	// get the number of draw batches of the last frame, which
+	// are one draw call each unless drawn indirectly
+	int GetDrawCallCount() const { return((int)m_drawBatches.size()); }
+
+	// submit the draw batches from an indirect command buffer,
+	// with one call per texture page, when the driver supports it
+	void SetIndirectDrawing(bool bEnabled);
+	bool IsIndirectDrawing() const;
+
+	// load every variant of the shader program of the scene,
+	// keeping the previous variants when one of them fails
+	bool LoadShaderVariants(const char* vertexShaderFilename, const char* fragmentShaderFilename);
+	// load the depth only shader program of the depth pre-pass,
+	// keeping the previous program when the new one fails
+	bool LoadDepthProgram(const char* vertexShaderFilename, const char* fragmentShaderFilename);
+	// draw the depth of the opaque objects before shading them,
+	// so every visible pixel is only shaded once
+	void SetDepthPrepass(bool bEnabled);
+	bool IsDepthPrepass() const { return((m_bDepthPrepass == true) && (0 != m_depthProgramID)); }
+
+	// check whether the scene changed since the last rendered
+	// frame, or decoded textures are waiting to be uploaded
+	bool IsSceneChanged() const;
+
+	// lay out copies of the whole scene side by side, so the
+	// scene holds the passed in number of copies
+	void ReplicateScene(int copies, float spacing);
+
+	// change the transformation of a previously added object
+	void SetObjectTransform(
+		int objectIndex,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
 
 
 
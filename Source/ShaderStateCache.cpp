@@ -0,0 +1,613 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderstatecache.cpp
+// ============
+// cached uniform locations and values for the active shader program
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderStateCache.h"
+
+#include <cstring>
+#include <iostream>
+
+/***********************************************************
+ *  ShaderStateCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderStateCache::ShaderStateCache()
+{
+	m_programID = 0;
+	m_pProgramState = NULL;
+	m_frameStats.uploadsIssued = 0;
+	m_frameStats.uploadsSkipped = 0;
+	m_lastFrameStats = m_frameStats;
+}
+
+/***********************************************************
+ *  ~ShaderStateCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderStateCache::~ShaderStateCache()
+{
+	m_uniforms.clear();
+	m_handlesByName.clear();
+}
+
+/***********************************************************
+ *  RegisterUniform()
+ *
+ *  This method is used for registering a uniform by name and
+ *  returning the handle used by the fast setters.  The same
+ *  handle is returned when a name is registered again.  If a
+ *  shader program has already been resolved, the location of
+ *  the new uniform is looked up right away.
+ ***********************************************************/
+ShaderStateCache::UNIFORM_HANDLE ShaderStateCache::RegisterUniform(
+	const std::string& name,
+	UNIFORM_TYPE type)
+{
+	UNIFORM_HANDLE handle;
+
+	auto found = m_handlesByName.find(name);
+	if (found != m_handlesByName.end())
+	{
+		handle.index = found->second;
+		return(handle);
+	}
+
+	CACHED_UNIFORM uniform;
+	uniform.name = name;
+	uniform.type = type;
+	uniform.location = -1;
+	uniform.bValid = false;
+	memset(uniform.data, 0, sizeof(uniform.data));
+	if (0 != m_programID)
+	{
+		uniform.location = glGetUniformLocation(m_programID, name.c_str());
+	}
+
+	handle.index = m_uniforms.size();
+	m_uniforms.push_back(uniform);
+	m_handlesByName[name] = handle.index;
+	SaveProgramLocations();
+
+	return(handle);
+}
+
+/***********************************************************
+ *  RegisterUniformBlock()
+ *
+ *  This method is used for registering a uniform block that
+ *  is bound to the passed in binding point whenever the
+ *  uniforms are resolved, and right away in every program
+ *  that has already been resolved.
+ ***********************************************************/
+void ShaderStateCache::RegisterUniformBlock(
+	const std::string& name,
+	GLuint bindingPoint)
+{
+	UNIFORM_BLOCK block;
+	block.name = name;
+	block.bindingPoint = bindingPoint;
+	m_uniformBlocks.push_back(block);
+
+	if (0 != m_programID)
+	{
+		BindUniformBlocks(m_programID);
+	}
+	for (const auto& program : m_programStates)
+	{
+		if (program.first != m_programID)
+		{
+			BindUniformBlocks(program.first);
+		}
+	}
+}
+
+/***********************************************************
+ *  ResolveUniforms()
+ *
+ *  This method is used for looking up the locations of all
+ *  the registered uniforms in the currently used shader
+ *  program, and for binding its registered uniform blocks.
+ *  It must be called after the shader program has been
+ *  loaded and made current.
+ ***********************************************************/
+void ShaderStateCache::ResolveUniforms()
+{
+	GLint programID = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &programID);
+	m_programID = programID;
+
+	for (CACHED_UNIFORM& uniform : m_uniforms)
+	{
+		uniform.location = glGetUniformLocation(m_programID, uniform.name.c_str());
+		uniform.bValid = false;
+	}
+	BindUniformBlocks(m_programID);
+	SaveProgramLocations();
+
+	// the values the program holds are not known
+	if (NULL != m_pProgramState)
+	{
+		for (PROGRAM_VALUE& value : m_pProgramState->values)
+		{
+			value.bValid = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  ReloadUniforms()
+ *
+ *  This method is used for resolving the uniforms again once
+ *  the shader program has been relinked and made current.  A
+ *  new program starts with default values, so the cached
+ *  values are written into it - uniforms that are only set
+ *  once during setup keep their values across the reload.
+ ***********************************************************/
+void ShaderStateCache::ReloadUniforms()
+{
+	std::vector<bool> validValues(m_uniforms.size());
+	for (int i = 0; i < m_uniforms.size(); i++)
+	{
+		validValues[i] = m_uniforms[i].bValid;
+	}
+
+	ResolveUniforms();
+
+	for (int i = 0; i < m_uniforms.size(); i++)
+	{
+		CACHED_UNIFORM& uniform = m_uniforms[i];
+		uniform.bValid = validValues[i];
+		if ((validValues[i] == true) && (uniform.location >= 0))
+		{
+			UploadCachedValue(uniform);
+			SaveUploadedValue(i);
+		}
+	}
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This method is used for making the passed in program
+ *  current.  Its uniforms are resolved and its blocks bound
+ *  the first time it is used, and the locations are kept
+ *  for the next switch.  The program may hold older values
+ *  than the cache, so the cached values that differ from the
+ *  ones last uploaded into it are written.  Only the set calls
+ *  that are elided count as skipped uploads, not the values
+ *  the program already holds.
+ ***********************************************************/
+void ShaderStateCache::UseProgram(GLuint programID)
+{
+	if (programID == m_programID)
+	{
+		return;
+	}
+
+	glUseProgram(programID);
+	m_programID = programID;
+	m_pProgramState = NULL;
+	if (0 == m_programID)
+	{
+		return;
+	}
+
+	PROGRAM_STATE& program = m_programStates[m_programID];
+	m_pProgramState = &program;
+	if (program.locations.size() == 0)
+	{
+		BindUniformBlocks(m_programID);
+	}
+	// uniforms registered since the program was last used are
+	// looked up now
+	PROGRAM_VALUE unknownValue;
+	unknownValue.bValid = false;
+	for (int i = program.locations.size(); i < m_uniforms.size(); i++)
+	{
+		program.locations.push_back(glGetUniformLocation(m_programID, m_uniforms[i].name.c_str()));
+		program.values.push_back(unknownValue);
+	}
+
+	for (int i = 0; i < m_uniforms.size(); i++)
+	{
+		CACHED_UNIFORM& uniform = m_uniforms[i];
+		uniform.location = program.locations[i];
+		if ((uniform.bValid == false) || (uniform.location < 0))
+		{
+			continue;
+		}
+
+		const PROGRAM_VALUE& value = program.values[i];
+		if ((value.bValid == true) && (memcmp(value.data, uniform.data, sizeof(value.data)) == 0))
+		{
+			continue;
+		}
+		UploadCachedValue(uniform);
+		SaveUploadedValue(i);
+		m_frameStats.uploadsIssued++;
+	}
+}
+
+/***********************************************************
+ *  ForgetProgram()
+ *
+ *  This method is used for dropping the locations of the
+ *  passed in program before it is deleted, since OpenGL can
+ *  give its name to the next program that is created.
+ ***********************************************************/
+void ShaderStateCache::ForgetProgram(GLuint programID)
+{
+	m_programStates.erase(programID);
+	if (programID == m_programID)
+	{
+		m_programID = 0;
+		m_pProgramState = NULL;
+		for (CACHED_UNIFORM& uniform : m_uniforms)
+		{
+			uniform.location = -1;
+		}
+	}
+}
+
+/***********************************************************
+ *  BindUniformBlocks()
+ *
+ *  This method is used for binding the registered uniform
+ *  blocks of the passed in program to their binding points.
+ ***********************************************************/
+void ShaderStateCache::BindUniformBlocks(GLuint programID)
+{
+	// blocks not used by the program have no index
+	for (const UNIFORM_BLOCK& block : m_uniformBlocks)
+	{
+		GLuint blockIndex = glGetUniformBlockIndex(programID, block.name.c_str());
+		if (GL_INVALID_INDEX != blockIndex)
+		{
+			glUniformBlockBinding(programID, blockIndex, block.bindingPoint);
+		}
+	}
+}
+
+/***********************************************************
+ *  SaveProgramLocations()
+ *
+ *  This method is used for keeping the locations resolved in
+ *  the current program, so switching back to it later does
+ *  not look them up again.
+ ***********************************************************/
+void ShaderStateCache::SaveProgramLocations()
+{
+	if (0 == m_programID)
+	{
+		return;
+	}
+
+	PROGRAM_STATE& program = m_programStates[m_programID];
+	PROGRAM_VALUE unknownValue;
+	unknownValue.bValid = false;
+	program.locations.resize(m_uniforms.size());
+	program.values.resize(m_uniforms.size(), unknownValue);
+	for (int i = 0; i < m_uniforms.size(); i++)
+	{
+		program.locations[i] = m_uniforms[i].location;
+	}
+	m_pProgramState = &program;
+}
+
+/***********************************************************
+ *  SaveUploadedValue()
+ *
+ *  This method is used for recording the cached value of the
+ *  uniform at the passed in index as the value the current
+ *  program holds, so switching back to the program does not
+ *  upload it again.
+ ***********************************************************/
+void ShaderStateCache::SaveUploadedValue(int index)
+{
+	if ((NULL == m_pProgramState) || (index >= m_pProgramState->values.size()))
+	{
+		return;
+	}
+
+	PROGRAM_VALUE& value = m_pProgramState->values[index];
+	memcpy(value.data, m_uniforms[index].data, sizeof(value.data));
+	value.bValid = true;
+}
+
+/***********************************************************
+ *  UploadCachedValue()
+ *
+ *  This method is used for writing the cached value of the
+ *  passed in uniform into the current shader program.
+ ***********************************************************/
+void ShaderStateCache::UploadCachedValue(const CACHED_UNIFORM& uniform)
+{
+	int intValue = 0;
+
+	switch (uniform.type)
+	{
+	case UNIFORM_BOOL:
+	case UNIFORM_INT:
+	case UNIFORM_SAMPLER2D:
+		memcpy(&intValue, uniform.data, sizeof(intValue));
+		glUniform1i(uniform.location, intValue);
+		break;
+	case UNIFORM_FLOAT:
+		glUniform1f(uniform.location, uniform.data[0]);
+		break;
+	case UNIFORM_VEC2:
+		glUniform2fv(uniform.location, 1, uniform.data);
+		break;
+	case UNIFORM_VEC3:
+		glUniform3fv(uniform.location, 1, uniform.data);
+		break;
+	case UNIFORM_VEC4:
+		glUniform4fv(uniform.location, 1, uniform.data);
+		break;
+	case UNIFORM_MAT4:
+		glUniformMatrix4fv(uniform.location, 1, GL_FALSE, uniform.data);
+		break;
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for saving the upload counters of the
+ *  previous frame and resetting them for the next frame.
+ ***********************************************************/
+void ShaderStateCache::BeginFrame()
+{
+	m_lastFrameStats = m_frameStats;
+	m_frameStats.uploadsIssued = 0;
+	m_frameStats.uploadsSkipped = 0;
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for forgetting all the cached values,
+ *  and the values every program holds, so that the next
+ *  write to each uniform is always uploaded.
+ ***********************************************************/
+void ShaderStateCache::Invalidate()
+{
+	for (CACHED_UNIFORM& uniform : m_uniforms)
+	{
+		uniform.bValid = false;
+	}
+	for (auto& program : m_programStates)
+	{
+		for (PROGRAM_VALUE& value : program.second.values)
+		{
+			value.bValid = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  UpdateCachedValue()
+ *
+ *  This method is used for comparing the passed in value with
+ *  the cached value of the uniform.  When the value needs to
+ *  be uploaded, the cache is updated and the uniform is
+ *  returned, otherwise NULL is returned.
+ ***********************************************************/
+ShaderStateCache::CACHED_UNIFORM* ShaderStateCache::UpdateCachedValue(
+	UNIFORM_HANDLE handle,
+	UNIFORM_TYPE type,
+	const void* pData,
+	size_t size)
+{
+	if ((handle.index < 0) || (handle.index >= m_uniforms.size()))
+	{
+		return(NULL);
+	}
+
+	CACHED_UNIFORM& uniform = m_uniforms[handle.index];
+
+#ifdef _DEBUG
+	if (uniform.type != type)
+	{
+		std::cout << "Uniform " << uniform.name << " set with the wrong value type" << std::endl;
+	}
+#endif
+
+	if ((uniform.bValid == true) && (memcmp(uniform.data, pData, size) == 0))
+	{
+		m_frameStats.uploadsSkipped++;
+		return(NULL);
+	}
+
+	memcpy(uniform.data, pData, size);
+	uniform.bValid = true;
+
+	// uniforms that are not used by the shader have no location
+	if (uniform.location < 0)
+	{
+		return(NULL);
+	}
+
+	SaveUploadedValue(handle.index);
+	m_frameStats.uploadsIssued++;
+	return(&uniform);
+}
+
+/***********************************************************
+ *  setBoolValue()
+ *
+ *  This method is used for setting a bool uniform value when
+ *  it differs from the cached value.
+ ***********************************************************/
+void ShaderStateCache::setBoolValue(UNIFORM_HANDLE handle, bool value)
+{
+	int intValue = value;
+	CACHED_UNIFORM* pUniform = UpdateCachedValue(handle, UNIFORM_BOOL, &intValue, sizeof(intValue));
+	if (NULL != pUniform)
+	{
+		glUniform1i(pUniform->location, intValue);
+	}
+}
+
+/***********************************************************
+ *  setIntValue()
+ *
+ *  This method is used for setting an int uniform value when
+ *  it differs from the cached value.
+ ***********************************************************/
+void ShaderStateCache::setIntValue(UNIFORM_HANDLE handle, int value)
+{
+	CACHED_UNIFORM* pUniform = UpdateCachedValue(handle, UNIFORM_INT, &value, sizeof(value));
+	if (NULL != pUniform)
+	{
+		glUniform1i(pUniform->location, value);
+	}
+}
+
+/***********************************************************
+ *  setSampler2DValue()
+ *
+ *  This method is used for setting a sampler uniform value
+ *  when it differs from the cached value.
+ ***********************************************************/
+void ShaderStateCache::setSampler2DValue(UNIFORM_HANDLE handle, int value)
+{
+	CACHED_UNIFORM* pUniform = UpdateCachedValue(handle, UNIFORM_SAMPLER2D, &value, sizeof(value));
+	if (NULL != pUniform)
+	{
+		glUniform1i(pUniform->location, value);
+	}
+}
+
+/***********************************************************
+ *  setFloatValue()
+ *
+ *  This method is used for setting a float uniform value when
+ *  it differs from the cached value.
+ ***********************************************************/
+void ShaderStateCache::setFloatValue(UNIFORM_HANDLE handle, float value)
+{
+	CACHED_UNIFORM* pUniform = UpdateCachedValue(handle, UNIFORM_FLOAT, &value, sizeof(value));
+	if (NULL != pUniform)
+	{
+		glUniform1f(pUniform->location, value);
+	}
+}
+
+/***********************************************************
+ *  setVec2Value()
+ *
+ *  This method is used for setting a vec2 uniform value when
+ *  it differs from the cached value.
+ ***********************************************************/
+void ShaderStateCache::setVec2Value(UNIFORM_HANDLE handle, const glm::vec2& value)
+{
+	CACHED_UNIFORM* pUniform = UpdateCachedValue(handle, UNIFORM_VEC2, &value, sizeof(value));
+	if (NULL != pUniform)
+	{
+		glUniform2fv(pUniform->location, 1, &value[0]);
+	}
+}
+
+/***********************************************************
+ *  setVec3Value()
+ *
+ *  This method is used for setting a vec3 uniform value when
+ *  it differs from the cached value.
+ ***********************************************************/
+void ShaderStateCache::setVec3Value(UNIFORM_HANDLE handle, const glm::vec3& value)
+{
+	CACHED_UNIFORM* pUniform = UpdateCachedValue(handle, UNIFORM_VEC3, &value, sizeof(value));
+	if (NULL != pUniform)
+	{
+		glUniform3fv(pUniform->location, 1, &value[0]);
+	}
+}
+
+/***********************************************************
+ *  setVec4Value()
+ *
+ *  This method is used for setting a vec4 uniform value when
+ *  it differs from the cached value.
+ ***********************************************************/
+void ShaderStateCache::setVec4Value(UNIFORM_HANDLE handle, const glm::vec4& value)
+{
+	CACHED_UNIFORM* pUniform = UpdateCachedValue(handle, UNIFORM_VEC4, &value, sizeof(value));
+	if (NULL != pUniform)
+	{
+		glUniform4fv(pUniform->location, 1, &value[0]);
+	}
+}
+
+/***********************************************************
+ *  setMat4Value()
+ *
+ *  This method is used for setting a mat4 uniform value when
+ *  it differs from the cached value.
+ ***********************************************************/
+void ShaderStateCache::setMat4Value(UNIFORM_HANDLE handle, const glm::mat4& value)
+{
+	CACHED_UNIFORM* pUniform = UpdateCachedValue(handle, UNIFORM_MAT4, &value, sizeof(value));
+	if (NULL != pUniform)
+	{
+		glUniformMatrix4fv(pUniform->location, 1, GL_FALSE, &value[0][0]);
+	}
+}
+
+/***********************************************************
+ *  Name based setters
+ *
+ *  These methods look up (and register on first use) the
+ *  handle of the named uniform before setting the value.
+ *  They are meant for one-time setup code only - the render
+ *  loop should register its handles up front instead.
+ ***********************************************************/
+void ShaderStateCache::setBoolValue(const std::string& name, bool value)
+{
+	setBoolValue(RegisterUniform(name, UNIFORM_BOOL), value);
+}
+
+void ShaderStateCache::setIntValue(const std::string& name, int value)
+{
+	setIntValue(RegisterUniform(name, UNIFORM_INT), value);
+}
+
+void ShaderStateCache::setSampler2DValue(const std::string& name, int value)
+{
+	setSampler2DValue(RegisterUniform(name, UNIFORM_SAMPLER2D), value);
+}
+
+void ShaderStateCache::setFloatValue(const std::string& name, float value)
+{
+	setFloatValue(RegisterUniform(name, UNIFORM_FLOAT), value);
+}
+
+void ShaderStateCache::setVec2Value(const std::string& name, const glm::vec2& value)
+{
+	setVec2Value(RegisterUniform(name, UNIFORM_VEC2), value);
+}
+
+void ShaderStateCache::setVec3Value(const std::string& name, const glm::vec3& value)
+{
+	setVec3Value(RegisterUniform(name, UNIFORM_VEC3), value);
+}
+
+void ShaderStateCache::setVec3Value(const std::string& name, float x, float y, float z)
+{
+	setVec3Value(RegisterUniform(name, UNIFORM_VEC3), glm::vec3(x, y, z));
+}
+
+void ShaderStateCache::setVec4Value(const std::string& name, const glm::vec4& value)
+{
+	setVec4Value(RegisterUniform(name, UNIFORM_VEC4), value);
+}
+
+void ShaderStateCache::setMat4Value(const std::string& name, const glm::mat4& value)
+{
+	setMat4Value(RegisterUniform(name, UNIFORM_MAT4), value);
+}
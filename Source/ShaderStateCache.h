@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderstatecache.h
+// ============
+// cached uniform locations and values for the active shader program
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  ShaderStateCache
+ *
+ *  This class resolves the uniform locations of the shader
+ *  program once into handles, and keeps a copy of the last
+ *  value written to each uniform so that uploads of unchanged
+ *  values can be skipped.  It also binds the uniform blocks
+ *  of the program to their fixed binding points.  Several
+ *  programs can be switched between, each with its own
+ *  resolved locations and a copy of the values uploaded into
+ *  it, and only the cached values that program does not
+ *  already hold are written when it is switched to.
+ ***********************************************************/
+class ShaderStateCache
+{
+public:
+	// constructor
+	ShaderStateCache();
+	// destructor
+	~ShaderStateCache();
+
+	// value types that a uniform handle can be registered with
+	enum UNIFORM_TYPE
+	{
+		UNIFORM_BOOL = 0,
+		UNIFORM_INT,
+		UNIFORM_SAMPLER2D,
+		UNIFORM_FLOAT,
+		UNIFORM_VEC2,
+		UNIFORM_VEC3,
+		UNIFORM_VEC4,
+		UNIFORM_MAT4
+	};
+
+	// handle to a registered uniform
+	struct UNIFORM_HANDLE
+	{
+		int index;
+	};
+
+	// number of uniform uploads issued and skipped
+	struct UNIFORM_STATS
+	{
+		int uploadsIssued;
+		int uploadsSkipped;
+	};
+
+	// register a uniform by name and get a handle for the fast setters
+	UNIFORM_HANDLE RegisterUniform(const std::string& name, UNIFORM_TYPE type);
+	// register a uniform block by name to be bound at a fixed binding point
+	void RegisterUniformBlock(const std::string& name, GLuint bindingPoint);
+	// resolve the locations of all the registered uniforms and bind the
+	// registered uniform blocks in the current shader program - call
+	// again after the program changed
+	void ResolveUniforms();
+	// resolve the uniforms in the current shader program after
+	// it was relinked, and write the cached values into it
+	void ReloadUniforms();
+	// make the passed in program current, resolving its uniforms
+	// the first time and writing the cached values into it
+	void UseProgram(GLuint programID);
+	// forget the locations of a program that is being deleted
+	void ForgetProgram(GLuint programID);
+
+	// reset the per-frame upload counters
+	void BeginFrame();
+	// forget all the cached values so the next writes are uploaded
+	void Invalidate();
+
+	// get the upload counters of the current and previous frame
+	UNIFORM_STATS GetFrameStats() const { return(m_frameStats); }
+	UNIFORM_STATS GetLastFrameStats() const { return(m_lastFrameStats); }
+
+	// fast uniform setters using previously registered handles
+	void setBoolValue(UNIFORM_HANDLE handle, bool value);
+	void setIntValue(UNIFORM_HANDLE handle, int value);
+	void setSampler2DValue(UNIFORM_HANDLE handle, int value);
+	void setFloatValue(UNIFORM_HANDLE handle, float value);
+	void setVec2Value(UNIFORM_HANDLE handle, const glm::vec2& value);
+	void setVec3Value(UNIFORM_HANDLE handle, const glm::vec3& value);
+	void setVec4Value(UNIFORM_HANDLE handle, const glm::vec4& value);
+	void setMat4Value(UNIFORM_HANDLE handle, const glm::mat4& value);
+
+	// slow uniform setters that look up the handle by name
+	void setBoolValue(const std::string& name, bool value);
+	void setIntValue(const std::string& name, int value);
+	void setSampler2DValue(const std::string& name, int value);
+	void setFloatValue(const std::string& name, float value);
+	void setVec2Value(const std::string& name, const glm::vec2& value);
+	void setVec3Value(const std::string& name, const glm::vec3& value);
+	void setVec3Value(const std::string& name, float x, float y, float z);
+	void setVec4Value(const std::string& name, const glm::vec4& value);
+	void setMat4Value(const std::string& name, const glm::mat4& value);
+
+private:
+	// registered uniform with its location and last written value,
+	// which is large enough to hold a 4x4 matrix
+	struct CACHED_UNIFORM
+	{
+		std::string name;
+		UNIFORM_TYPE type;
+		GLint location;
+		bool bValid;
+		float data[16];
+	};
+
+	// value last uploaded into one uniform of a program
+	struct PROGRAM_VALUE
+	{
+		bool bValid;
+		float data[16];
+	};
+
+	// locations of the registered uniforms in one program and
+	// the values it holds, in handle order
+	struct PROGRAM_STATE
+	{
+		std::vector<GLint> locations;
+		std::vector<PROGRAM_VALUE> values;
+	};
+
+	// registered uniform block with its fixed binding point
+	struct UNIFORM_BLOCK
+	{
+		std::string name;
+		GLuint bindingPoint;
+	};
+
+	// shader program the uniform locations were resolved in
+	GLuint m_programID;
+	// locations and uploaded values of every program that has
+	// been resolved, and the state of the current program
+	std::unordered_map<GLuint, PROGRAM_STATE> m_programStates;
+	PROGRAM_STATE* m_pProgramState;
+	// all the registered uniforms, indexed by handle
+	std::vector<CACHED_UNIFORM> m_uniforms;
+	// handles of the registered uniforms, by name
+	std::unordered_map<std::string, int> m_handlesByName;
+	// all the registered uniform blocks
+	std::vector<UNIFORM_BLOCK> m_uniformBlocks;
+	// upload counters for the current and previous frame
+	UNIFORM_STATS m_frameStats;
+	UNIFORM_STATS m_lastFrameStats;
+
+	// bind the registered uniform blocks in the passed in program
+	void BindUniformBlocks(GLuint programID);
+	// store the locations of the current program for switching
+	void SaveProgramLocations();
+	// record the cached value of a uniform as uploaded into the
+	// current program
+	void SaveUploadedValue(int index);
+	// upload the cached value of a uniform
+	static void UploadCachedValue(const CACHED_UNIFORM& uniform);
+	// compare against and update the cached value of a uniform
+	CACHED_UNIFORM* UpdateCachedValue(
+		UNIFORM_HANDLE handle,
+		UNIFORM_TYPE type,
+		const void* pData,
+		size_t size);
+};
@@ -0,0 +1,642 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.cpp
+// ============
+// keep block compressed, mip-baked copies of the texture images on disk
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCache.h"
+
+#include "stb_image.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of the global variables and defines
+namespace
+{
+	// changing the encoder or the image orientation must change
+	// this, so that the entries written before are not used
+	const unsigned long long g_CacheVersion = 1;
+
+	// DDS file layout values
+	const unsigned int g_DDSMagic = 0x20534444;		// "DDS "
+	const unsigned int g_DDSHeaderSize = 124;
+	const unsigned int g_DDSPixelFormatSize = 32;
+	const unsigned int g_DDSFourCCDXT1 = 0x31545844;	// "DXT1"
+	const unsigned int g_DDSFourCCDXT5 = 0x35545844;	// "DXT5"
+	const size_t g_DDSDataOffset = 4 + 124;
+
+	/***********************************************************
+	 *  HashBytes()
+	 *
+	 *  This function is used for computing the 64 bit FNV-1a
+	 *  hash of the passed in bytes.
+	 ***********************************************************/
+	unsigned long long HashBytes(const std::vector<unsigned char>& bytes)
+	{
+		unsigned long long hash = 14695981039346656037ULL ^ g_CacheVersion;
+		for (unsigned char byte : bytes)
+		{
+			hash ^= byte;
+			hash *= 1099511628211ULL;
+		}
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  HashText()
+	 *
+	 *  This function is used for adding the passed in text to
+	 *  a 64 bit FNV-1a hash.
+	 ***********************************************************/
+	unsigned long long HashText(unsigned long long hash, const char* pText)
+	{
+		for (const char* pByte = pText; *pByte != '\0'; pByte++)
+		{
+			hash ^= (unsigned char)*pByte;
+			hash *= 1099511628211ULL;
+		}
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  GetLevelSize()
+	 *
+	 *  This function is used for getting the size in bytes of
+	 *  one compressed mip level, made of 4x4 pixel blocks.
+	 ***********************************************************/
+	GLsizei GetLevelSize(GLenum internalFormat, int width, int height)
+	{
+		int blockBytes = (internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) ? 8 : 16;
+		return(((width + 3) / 4) * ((height + 3) / 4) * blockBytes);
+	}
+
+	/***********************************************************
+	 *  ReadUInt32() / WriteUInt32()
+	 *
+	 *  These functions are used for reading and writing little
+	 *  endian 32 bit values in the DDS header.
+	 ***********************************************************/
+	unsigned int ReadUInt32(const unsigned char* pData, size_t offset)
+	{
+		return((unsigned int)pData[offset] |
+			((unsigned int)pData[offset + 1] << 8) |
+			((unsigned int)pData[offset + 2] << 16) |
+			((unsigned int)pData[offset + 3] << 24));
+	}
+
+	void WriteUInt32(std::vector<unsigned char>& data, size_t offset, unsigned int value)
+	{
+		data[offset] = (unsigned char)(value & 0xFF);
+		data[offset + 1] = (unsigned char)((value >> 8) & 0xFF);
+		data[offset + 2] = (unsigned char)((value >> 16) & 0xFF);
+		data[offset + 3] = (unsigned char)((value >> 24) & 0xFF);
+	}
+
+	/***********************************************************
+	 *  PackColor565() / UnpackColor565()
+	 *
+	 *  These functions are used for converting between 8 bit
+	 *  RGB colors and the 5:6:5 colors of the BC blocks.
+	 ***********************************************************/
+	unsigned short PackColor565(const int color[3])
+	{
+		return((unsigned short)(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3)));
+	}
+
+	void UnpackColor565(unsigned short packed, int color[3])
+	{
+		int red = (packed >> 11) & 31;
+		int green = (packed >> 5) & 63;
+		int blue = packed & 31;
+		color[0] = (red << 3) | (red >> 2);
+		color[1] = (green << 2) | (green >> 4);
+		color[2] = (blue << 3) | (blue >> 2);
+	}
+
+	/***********************************************************
+	 *  EncodeColorBlock()
+	 *
+	 *  This function is used for compressing the colors of 16
+	 *  RGBA pixels into an 8 byte BC1 block.  The end points are
+	 *  the corners of the color bounding box, inset slightly to
+	 *  lower the average error.
+	 ***********************************************************/
+	void EncodeColorBlock(const unsigned char* pBlock, unsigned char* pOut)
+	{
+		int minColor[3] = { 255, 255, 255 };
+		int maxColor[3] = { 0, 0, 0 };
+
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				int value = pBlock[i * 4 + c];
+				if (value < minColor[c]) minColor[c] = value;
+				if (value > maxColor[c]) maxColor[c] = value;
+			}
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			int inset = (maxColor[c] - minColor[c]) >> 4;
+			minColor[c] += inset;
+			maxColor[c] -= inset;
+		}
+
+		unsigned short color0 = PackColor565(maxColor);
+		unsigned short color1 = PackColor565(minColor);
+		// the first end point must be the larger for four colors
+		if (color0 < color1)
+		{
+			unsigned short swapColor = color0;
+			color0 = color1;
+			color1 = swapColor;
+		}
+
+		unsigned int indices = 0;
+		if (color0 != color1)
+		{
+			int palette[4][3];
+			UnpackColor565(color0, palette[0]);
+			UnpackColor565(color1, palette[1]);
+			for (int c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			for (int i = 0; i < 16; i++)
+			{
+				int bestIndex = 0;
+				int bestError = 0x7FFFFFFF;
+				for (int p = 0; p < 4; p++)
+				{
+					int error = 0;
+					for (int c = 0; c < 3; c++)
+					{
+						int difference = pBlock[i * 4 + c] - palette[p][c];
+						error += difference * difference;
+					}
+					if (error < bestError)
+					{
+						bestError = error;
+						bestIndex = p;
+					}
+				}
+				indices |= (unsigned int)bestIndex << (i * 2);
+			}
+		}
+
+		pOut[0] = (unsigned char)(color0 & 0xFF);
+		pOut[1] = (unsigned char)(color0 >> 8);
+		pOut[2] = (unsigned char)(color1 & 0xFF);
+		pOut[3] = (unsigned char)(color1 >> 8);
+		for (int i = 0; i < 4; i++)
+		{
+			pOut[4 + i] = (unsigned char)((indices >> (i * 8)) & 0xFF);
+		}
+	}
+
+	/***********************************************************
+	 *  EncodeAlphaBlock()
+	 *
+	 *  This function is used for compressing the alpha values
+	 *  of 16 RGBA pixels into the 8 byte alpha block of BC3,
+	 *  using the eight value mode between the lowest and
+	 *  highest alpha.
+	 ***********************************************************/
+	void EncodeAlphaBlock(const unsigned char* pBlock, unsigned char* pOut)
+	{
+		int minAlpha = 255;
+		int maxAlpha = 0;
+
+		for (int i = 0; i < 16; i++)
+		{
+			int alpha = pBlock[i * 4 + 3];
+			if (alpha < minAlpha) minAlpha = alpha;
+			if (alpha > maxAlpha) maxAlpha = alpha;
+		}
+
+		unsigned long long indices = 0;
+		if (maxAlpha != minAlpha)
+		{
+			int palette[8];
+			palette[0] = maxAlpha;
+			palette[1] = minAlpha;
+			for (int p = 1; p < 7; p++)
+			{
+				palette[p + 1] = ((7 - p) * maxAlpha + p * minAlpha) / 7;
+			}
+
+			for (int i = 0; i < 16; i++)
+			{
+				int bestIndex = 0;
+				int bestError = 0x7FFFFFFF;
+				for (int p = 0; p < 8; p++)
+				{
+					int error = pBlock[i * 4 + 3] - palette[p];
+					error *= error;
+					if (error < bestError)
+					{
+						bestError = error;
+						bestIndex = p;
+					}
+				}
+				indices |= (unsigned long long)bestIndex << (i * 3);
+			}
+		}
+
+		pOut[0] = (unsigned char)maxAlpha;
+		pOut[1] = (unsigned char)minAlpha;
+		for (int i = 0; i < 6; i++)
+		{
+			pOut[2 + i] = (unsigned char)((indices >> (i * 8)) & 0xFF);
+		}
+	}
+
+	/***********************************************************
+	 *  CompressLevel()
+	 *
+	 *  This function is used for compressing one RGBA mip level
+	 *  block by block.  Blocks reaching past the edges repeat
+	 *  the edge pixels.
+	 ***********************************************************/
+	void CompressLevel(
+		const std::vector<unsigned char>& pixels,
+		int width,
+		int height,
+		bool bAlpha,
+		unsigned char* pOut)
+	{
+		unsigned char block[64];
+
+		for (int blockY = 0; blockY < height; blockY += 4)
+		{
+			for (int blockX = 0; blockX < width; blockX += 4)
+			{
+				for (int y = 0; y < 4; y++)
+				{
+					int sourceY = (blockY + y < height) ? (blockY + y) : (height - 1);
+					for (int x = 0; x < 4; x++)
+					{
+						int sourceX = (blockX + x < width) ? (blockX + x) : (width - 1);
+						memcpy(&block[(y * 4 + x) * 4], &pixels[(sourceY * width + sourceX) * 4], 4);
+					}
+				}
+
+				if (bAlpha)
+				{
+					EncodeAlphaBlock(block, pOut);
+					pOut += 8;
+				}
+				EncodeColorBlock(block, pOut);
+				pOut += 8;
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  DownsampleLevel()
+	 *
+	 *  This function is used for building the next mip level
+	 *  by averaging each 2x2 square of RGBA pixels.
+	 ***********************************************************/
+	void DownsampleLevel(
+		const std::vector<unsigned char>& source,
+		int width,
+		int height,
+		std::vector<unsigned char>& target)
+	{
+		int targetWidth = (width > 1) ? (width / 2) : 1;
+		int targetHeight = (height > 1) ? (height / 2) : 1;
+
+		target.resize(targetWidth * targetHeight * 4);
+		for (int y = 0; y < targetHeight; y++)
+		{
+			int y0 = (y * 2 < height) ? (y * 2) : (height - 1);
+			int y1 = (y * 2 + 1 < height) ? (y * 2 + 1) : y0;
+			for (int x = 0; x < targetWidth; x++)
+			{
+				int x0 = (x * 2 < width) ? (x * 2) : (width - 1);
+				int x1 = (x * 2 + 1 < width) ? (x * 2 + 1) : x0;
+				for (int c = 0; c < 4; c++)
+				{
+					int sum = source[(y0 * width + x0) * 4 + c] +
+						source[(y0 * width + x1) * 4 + c] +
+						source[(y1 * width + x0) * 4 + c] +
+						source[(y1 * width + x1) * 4 + c];
+					target[(y * targetWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  CreateCacheDirectory()
+	 *
+	 *  This function is used for creating the passed in
+	 *  directory if it does not exist yet.
+	 ***********************************************************/
+	void CreateCacheDirectory(const std::string& directory)
+	{
+#ifdef _WIN32
+		_mkdir(directory.c_str());
+#else
+		mkdir(directory.c_str(), 0755);
+#endif
+	}
+}
+
+/***********************************************************
+ *  TextureCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureCache::TextureCache(const std::string& directory)
+{
+	m_directory = directory;
+	CreateCacheDirectory(m_directory);
+}
+
+/***********************************************************
+ *  ~TextureCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureCache::~TextureCache()
+{
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for loading the compressed texture
+ *  for the passed in image file.  The cache entry is found
+ *  from the hash of the image path and contents, and is built
+ *  and written first when it does not exist.  A small index
+ *  file named after the path holds the name of the latest
+ *  entry, so the entry it replaces is removed.  The returned
+ *  texture must be deleted by the caller.
+ ***********************************************************/
+TextureCache::COMPRESSED_TEXTURE* TextureCache::Load(const char* filename)
+{
+	std::ifstream sourceFile(filename, std::ios::binary);
+	if (!sourceFile)
+	{
+		return(NULL);
+	}
+	std::vector<unsigned char> source((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+	sourceFile.close();
+
+	// images with the same contents get their own entries, so
+	// replacing the entry of one path never removes another's
+	char hashName[32];
+	snprintf(hashName, sizeof(hashName), "%016llx", HashText(HashBytes(source), filename));
+	std::string entryName = std::string(hashName) + ".dds";
+	std::string cacheFilename = m_directory + "/" + entryName;
+	snprintf(hashName, sizeof(hashName), "%016llx", HashText(14695981039346656037ULL ^ g_CacheVersion, filename));
+	std::string indexFilename = m_directory + "/" + hashName + ".index";
+
+	COMPRESSED_TEXTURE* pTexture = new COMPRESSED_TEXTURE();
+
+	// use the existing cache entry in place
+	if ((pTexture->file.Open(cacheFilename.c_str()) == true) &&
+		(ParseCacheFile(*pTexture, pTexture->file.GetData(), pTexture->file.GetSize()) == true))
+	{
+		ReplaceCacheEntry(indexFilename, entryName);
+		return(pTexture);
+	}
+	pTexture->file.Close();
+
+	if (BuildCacheFile(source, pTexture->buffer) == false)
+	{
+		delete pTexture;
+		return(NULL);
+	}
+
+	// write the new entry under a name only this thread uses,
+	// since the same image may be loaded by another thread
+	std::string tempFilename = cacheFilename + "." +
+		std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	std::ofstream cacheFile(tempFilename.c_str(), std::ios::binary);
+	if (cacheFile)
+	{
+		cacheFile.write((const char*)pTexture->buffer.data(), pTexture->buffer.size());
+		cacheFile.close();
+		if (!cacheFile || (std::rename(tempFilename.c_str(), cacheFilename.c_str()) != 0))
+		{
+			std::remove(tempFilename.c_str());
+		}
+		else
+		{
+			ReplaceCacheEntry(indexFilename, entryName);
+		}
+	}
+	else
+	{
+		std::cout << "Could not write texture cache file:" << cacheFilename << std::endl;
+	}
+
+	ParseCacheFile(*pTexture, pTexture->buffer.data(), pTexture->buffer.size());
+
+	return(pTexture);
+}
+
+/***********************************************************
+ *  ReplaceCacheEntry()
+ *
+ *  This method is used for writing the name of the passed in
+ *  entry into the index file of its image, after removing
+ *  the entry the index named before.  Worker threads may load
+ *  the same image at once, so the index files are updated
+ *  one at a time.
+ ***********************************************************/
+void TextureCache::ReplaceCacheEntry(const std::string& indexFilename, const std::string& entryName)
+{
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+	std::string previousName;
+	{
+		std::ifstream indexFile(indexFilename.c_str());
+		std::getline(indexFile, previousName);
+	}
+
+	if (previousName == entryName)
+	{
+		return;
+	}
+	// only a name written by this class is removed
+	if ((previousName.length() > 0) && (previousName.find_first_of("/\\") == std::string::npos))
+	{
+		std::remove((m_directory + "/" + previousName).c_str());
+	}
+
+	std::ofstream indexFile(indexFilename.c_str());
+	indexFile << entryName << "\n";
+}
+
+/***********************************************************
+ *  ParseCacheFile()
+ *
+ *  This method is used for checking the header of the passed
+ *  in DDS file contents, and pointing the passed in texture
+ *  at each of its mip levels.
+ ***********************************************************/
+bool TextureCache::ParseCacheFile(
+	COMPRESSED_TEXTURE& texture,
+	const unsigned char* pData,
+	size_t size)
+{
+	if ((size < g_DDSDataOffset) ||
+		(ReadUInt32(pData, 0) != g_DDSMagic) ||
+		(ReadUInt32(pData, 4) != g_DDSHeaderSize))
+	{
+		return(false);
+	}
+
+	unsigned int height = ReadUInt32(pData, 4 + 8);
+	unsigned int width = ReadUInt32(pData, 4 + 12);
+	unsigned int mipLevels = ReadUInt32(pData, 4 + 24);
+	unsigned int fourCC = ReadUInt32(pData, 4 + 80);
+
+	if (fourCC == g_DDSFourCCDXT1)
+		texture.internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	else if (fourCC == g_DDSFourCCDXT5)
+		texture.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	else
+		return(false);
+
+	if ((width == 0) || (height == 0) || (mipLevels == 0) || (mipLevels > MAX_MIP_LEVELS))
+	{
+		return(false);
+	}
+
+	texture.width = (int)width;
+	texture.height = (int)height;
+	texture.mipLevels = (int)mipLevels;
+
+	size_t offset = g_DDSDataOffset;
+	int levelWidth = texture.width;
+	int levelHeight = texture.height;
+	for (int level = 0; level < texture.mipLevels; level++)
+	{
+		GLsizei levelSize = GetLevelSize(texture.internalFormat, levelWidth, levelHeight);
+		if (offset + levelSize > size)
+		{
+			return(false);
+		}
+
+		texture.pLevels[level] = pData + offset;
+		texture.levelSizes[level] = levelSize;
+		offset += levelSize;
+
+		levelWidth = (levelWidth > 1) ? (levelWidth / 2) : 1;
+		levelHeight = (levelHeight > 1) ? (levelHeight / 2) : 1;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  BuildCacheFile()
+ *
+ *  This method is used for decoding the passed in image file
+ *  contents, baking the full mip chain, and compressing every
+ *  level into a DDS file in memory.  The pixel rows keep the
+ *  bottom-up order OpenGL expects.
+ ***********************************************************/
+bool TextureCache::BuildCacheFile(
+	const std::vector<unsigned char>& source,
+	std::vector<unsigned char>& cacheFile)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	unsigned char* image = stbi_load_from_memory(
+		source.data(),
+		(int)source.size(),
+		&width,
+		&height,
+		&colorChannels,
+		4);
+	if (NULL == image)
+	{
+		return(false);
+	}
+
+	std::vector<unsigned char> pixels(image, image + width * height * 4);
+	stbi_image_free(image);
+
+	// only images that use their alpha channel need BC3
+	bool bAlpha = false;
+	if ((colorChannels == 2) || (colorChannels == 4))
+	{
+		for (size_t i = 3; (i < pixels.size()) && (bAlpha == false); i += 4)
+		{
+			bAlpha = (pixels[i] != 255);
+		}
+	}
+	GLenum internalFormat = bAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+
+	int mipLevels = 1;
+	while ((mipLevels < MAX_MIP_LEVELS) && (((width >> mipLevels) > 0) || ((height >> mipLevels) > 0)))
+	{
+		mipLevels++;
+	}
+
+	size_t totalSize = g_DDSDataOffset;
+	int levelWidth = width;
+	int levelHeight = height;
+	for (int level = 0; level < mipLevels; level++)
+	{
+		totalSize += GetLevelSize(internalFormat, levelWidth, levelHeight);
+		levelWidth = (levelWidth > 1) ? (levelWidth / 2) : 1;
+		levelHeight = (levelHeight > 1) ? (levelHeight / 2) : 1;
+	}
+
+	cacheFile.assign(totalSize, 0);
+	WriteUInt32(cacheFile, 0, g_DDSMagic);
+	WriteUInt32(cacheFile, 4, g_DDSHeaderSize);
+	// caps, height, width, pixel format, mip map count, linear size
+	WriteUInt32(cacheFile, 4 + 4, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000);
+	WriteUInt32(cacheFile, 4 + 8, height);
+	WriteUInt32(cacheFile, 4 + 12, width);
+	WriteUInt32(cacheFile, 4 + 16, GetLevelSize(internalFormat, width, height));
+	WriteUInt32(cacheFile, 4 + 24, mipLevels);
+	WriteUInt32(cacheFile, 4 + 72, g_DDSPixelFormatSize);
+	WriteUInt32(cacheFile, 4 + 76, 0x4);	// four CC
+	WriteUInt32(cacheFile, 4 + 80, bAlpha ? g_DDSFourCCDXT5 : g_DDSFourCCDXT1);
+	// texture, complex, mip map
+	WriteUInt32(cacheFile, 4 + 104, 0x1000 | 0x8 | 0x400000);
+
+	size_t offset = g_DDSDataOffset;
+	std::vector<unsigned char> nextPixels;
+	levelWidth = width;
+	levelHeight = height;
+	for (int level = 0; level < mipLevels; level++)
+	{
+		CompressLevel(pixels, levelWidth, levelHeight, bAlpha, &cacheFile[offset]);
+		offset += GetLevelSize(internalFormat, levelWidth, levelHeight);
+
+		if (level + 1 < mipLevels)
+		{
+			DownsampleLevel(pixels, levelWidth, levelHeight, nextPixels);
+			pixels.swap(nextPixels);
+			levelWidth = (levelWidth > 1) ? (levelWidth / 2) : 1;
+			levelHeight = (levelHeight > 1) ? (levelHeight / 2) : 1;
+		}
+	}
+
+	return(true);
+}
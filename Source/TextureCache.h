@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.h
+// ============
+// keep block compressed, mip-baked copies of the texture images on disk
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TextureCache
+ *
+ *  This class converts texture images into BC1 (opaque) or
+ *  BC3 (with alpha) compressed DDS files with all of their
+ *  mip levels baked in.  The files are named after a hash of
+ *  the source image path and contents, so a changed image
+ *  gets a new entry and stale entries are never read.  Each
+ *  image path keeps only its latest entry, so editing the
+ *  images does not grow the cache.  Existing entries are
+ *  memory mapped and uploaded without decoding.
+ *  Load() can be called from several worker threads at once.
+ ***********************************************************/
+class TextureCache
+{
+public:
+	// constructor
+	TextureCache(const std::string& directory);
+	// destructor
+	~TextureCache();
+
+	// most mip levels of a cached texture
+	static const int MAX_MIP_LEVELS = 16;
+
+	// compressed mip levels of one texture, pointing into the
+	// mapped cache file or into the buffer
+	struct COMPRESSED_TEXTURE
+	{
+		GLenum internalFormat;
+		int width;
+		int height;
+		int mipLevels;
+		const unsigned char* pLevels[MAX_MIP_LEVELS];
+		GLsizei levelSizes[MAX_MIP_LEVELS];
+		// mapped cache file holding the levels
+		MappedFile file;
+		// holds the levels when the cache file could not be written
+		std::vector<unsigned char> buffer;
+	};
+
+	// load the compressed texture for the passed in image file,
+	// building the cache entry first when there is none - it
+	// returns NULL when the image could not be read
+	COMPRESSED_TEXTURE* Load(const char* filename);
+
+private:
+	// directory holding the cache files
+	std::string m_directory;
+	// serializes the updates of the index files
+	std::mutex m_indexMutex;
+
+	// point the passed in texture at the levels in a DDS file
+	bool ParseCacheFile(
+		COMPRESSED_TEXTURE& texture,
+		const unsigned char* pData,
+		size_t size);
+	// record the passed in entry as the latest one of an image,
+	// removing the entry it replaces
+	void ReplaceCacheEntry(const std::string& indexFilename, const std::string& entryName);
+	// compress the passed in image into a DDS file in memory
+	bool BuildCacheFile(
+		const std::vector<unsigned char>& source,
+		std::vector<unsigned char>& cacheFile);
+};
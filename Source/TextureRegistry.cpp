@@ -0,0 +1,899 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureregistry.cpp
+// ============
+// manage the loaded textures as layers of 2D array textures
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureRegistry.h"
+
+#include <iostream>
+
+// declaration of the global variables and defines
+namespace
+{
+	// number of layers a new page is allocated with
+	const int g_InitialPageLayers = 4;
+	// color shown for textures that are still loading
+	const unsigned char g_PlaceholderColor[4] = { 128, 128, 128, 255 };
+
+	/***********************************************************
+	 *  GetPageBytes()
+	 *
+	 *  This function is used for estimating the bytes of the
+	 *  first mip level of every layer of the passed in page, and
+	 *  of the mip levels below it.  RGBA8 pages get the full
+	 *  chain from generating their mipmaps, while compressed
+	 *  pages have the levels they were allocated with.
+	 ***********************************************************/
+	void GetPageBytes(const TextureRegistry::TEXTURE_PAGE& page, size_t& baseBytes, size_t& mipBytes)
+	{
+		bool bCompressed = (page.internalFormat != GL_RGBA8);
+		size_t blockBytes = (page.internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) ? 8 : 16;
+		int levelWidth = page.width;
+		int levelHeight = page.height;
+
+		baseBytes = 0;
+		mipBytes = 0;
+		for (int level = 0; ; level++)
+		{
+			if (bCompressed && (level >= page.mipLevels))
+			{
+				break;
+			}
+
+			size_t levelBytes = bCompressed ?
+				((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockBytes :
+				(size_t)levelWidth * levelHeight * 4;
+			levelBytes *= page.layerCapacity;
+			if (level == 0)
+			{
+				baseBytes = levelBytes;
+			}
+			else
+			{
+				mipBytes += levelBytes;
+			}
+
+			if (!bCompressed && (levelWidth == 1) && (levelHeight == 1))
+			{
+				break;
+			}
+			levelWidth = (levelWidth > 1) ? (levelWidth / 2) : 1;
+			levelHeight = (levelHeight > 1) ? (levelHeight / 2) : 1;
+		}
+	}
+}
+
+/***********************************************************
+ *  TextureRegistry()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureRegistry::TextureRegistry(RenderStats* pRenderStats, GpuMemoryTracker* pMemoryTracker)
+{
+	m_pRenderStats = pRenderStats;
+	m_pMemoryTracker = pMemoryTracker;
+	m_copyFramebufferID = 0;
+	m_placeholderPage = -1;
+	m_placeholderLayer = 0;
+}
+
+/***********************************************************
+ *  ~TextureRegistry()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureRegistry::~TextureRegistry()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for registering a texture and copying
+ *  the passed in image into it at once.
+ ***********************************************************/
+int TextureRegistry::AddTexture(
+	const std::string& tag,
+	const unsigned char* pImage,
+	int width,
+	int height,
+	int colorChannels)
+{
+	int textureHandle = ReserveTexture(tag);
+	if (textureHandle < 0)
+	{
+		return(-1);
+	}
+
+	SetTextureImage(textureHandle, pImage, width, height, colorChannels);
+
+	return(textureHandle);
+}
+
+/***********************************************************
+ *  ReserveTexture()
+ *
+ *  This method is used for registering a texture under the
+ *  passed in tag before its image is available.  The texture
+ *  shows the placeholder until SetTextureImage() is called.
+ ***********************************************************/
+int TextureRegistry::ReserveTexture(const std::string& tag)
+{
+	if (FindTexture(tag) >= 0)
+	{
+		std::cout << "Texture tag is already registered:" << tag << std::endl;
+		return(-1);
+	}
+
+	CreatePlaceholder();
+
+	TEXTURE_INFO texture;
+	texture.tag = tag;
+	texture.page = m_placeholderPage;
+	texture.layer = m_placeholderLayer;
+	texture.bLoaded = false;
+	texture.references = 0;
+	texture.bEvicted = false;
+
+	m_textures.push_back(texture);
+	m_handlesByTag.emplace(tag, (int)m_textures.size() - 1);
+
+	return((int)m_textures.size() - 1);
+}
+
+/***********************************************************
+ *  SetTextureImage()
+ *
+ *  This method is used for copying the passed in RGB or RGBA
+ *  image into the next free layer of the page that holds the
+ *  textures of the same size, and pointing the reserved
+ *  texture at it.  The mipmaps of the page are regenerated
+ *  by the next GenerateMipmaps() call.
+ ***********************************************************/
+bool TextureRegistry::SetTextureImage(
+	int textureHandle,
+	const unsigned char* pImage,
+	int width,
+	int height,
+	int colorChannels)
+{
+	GLenum format = GL_RGB;
+
+	if ((textureHandle < 0) || (textureHandle >= m_textures.size()))
+	{
+		return(false);
+	}
+
+	// if the loaded image is in RGB format
+	if (colorChannels == 3)
+		format = GL_RGB;
+	// if the loaded image is in RGBA format - it supports transparency
+	else if (colorChannels == 4)
+		format = GL_RGBA;
+	else
+	{
+		std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+		return(false);
+	}
+
+	TEXTURE_INFO& texture = m_textures[textureHandle];
+	if (UploadLayer(pImage, width, height, format, texture.bLoaded, texture.page, texture.layer) == false)
+	{
+		return(false);
+	}
+	texture.bLoaded = true;
+	texture.bEvicted = false;
+
+	return(true);
+}
+
+/***********************************************************
+ *  UploadLayer()
+ *
+ *  This method is used for copying the passed in image into
+ *  the next free layer of the page of the same size, and
+ *  returning that page and layer.  A reloaded image of the
+ *  same size is written over the layer it had before, and
+ *  otherwise that layer is freed.
+ ***********************************************************/
+bool TextureRegistry::UploadLayer(
+	const unsigned char* pImage,
+	int width,
+	int height,
+	GLenum format,
+	bool bReplace,
+	int& page,
+	int& layer)
+{
+	int pageIndex = page;
+	int layerIndex = layer;
+
+	if ((bReplace == false) || (IsPageMatching(page, width, height, GL_RGBA8, 1) == false))
+	{
+		pageIndex = FindOrCreatePage(width, height, GL_RGBA8, 1);
+		if (pageIndex < 0)
+		{
+			return(false);
+		}
+		layerIndex = AllocateLayer(pageIndex);
+	}
+
+	TEXTURE_PAGE& targetPage = m_pages[pageIndex];
+
+	// the rows of an RGB image are not padded to four bytes
+	glBindTexture(GL_TEXTURE_2D_ARRAY, targetPage.arrayID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layerIndex, width, height, 1, format, GL_UNSIGNED_BYTE, pImage);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	if ((bReplace == true) && (pageIndex != page))
+	{
+		FreeLayer(page, layer);
+	}
+	page = pageIndex;
+	layer = layerIndex;
+	targetPage.bMipmapsDirty = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsPageMatching()
+ *
+ *  This method is used for checking whether the page at the
+ *  passed in index holds textures of the passed in size,
+ *  format and number of mip levels.
+ ***********************************************************/
+bool TextureRegistry::IsPageMatching(int page, int width, int height, GLenum internalFormat, int mipLevels) const
+{
+	if ((page < 0) || (page >= m_pages.size()))
+	{
+		return(false);
+	}
+
+	const TEXTURE_PAGE& texturePage = m_pages[page];
+	return((texturePage.width == width) &&
+		(texturePage.height == height) &&
+		(texturePage.internalFormat == internalFormat) &&
+		(texturePage.mipLevels == mipLevels));
+}
+
+/***********************************************************
+ *  SetCompressedTextureImage()
+ *
+ *  This method is used for copying the passed in compressed
+ *  mip levels into the next free layer of the page that holds
+ *  the textures of the same size and format, and pointing the
+ *  reserved texture at it.  The mip levels are used as they
+ *  are, instead of being generated.  A reloaded texture of
+ *  the same size and format keeps its layer, and otherwise
+ *  its old layer is freed.
+ ***********************************************************/
+bool TextureRegistry::SetCompressedTextureImage(
+	int textureHandle,
+	GLenum internalFormat,
+	int width,
+	int height,
+	int mipLevels,
+	const unsigned char* const* pLevels,
+	const GLsizei* levelSizes)
+{
+	if ((textureHandle < 0) || (textureHandle >= m_textures.size()))
+	{
+		return(false);
+	}
+
+	TEXTURE_INFO& texture = m_textures[textureHandle];
+	int pageIndex = texture.page;
+	int layerIndex = texture.layer;
+
+	if ((texture.bLoaded == false) || (IsPageMatching(texture.page, width, height, internalFormat, mipLevels) == false))
+	{
+		pageIndex = FindOrCreatePage(width, height, internalFormat, mipLevels);
+		if (pageIndex < 0)
+		{
+			return(false);
+		}
+		layerIndex = AllocateLayer(pageIndex);
+	}
+
+	TEXTURE_PAGE& targetPage = m_pages[pageIndex];
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, targetPage.arrayID);
+	int levelWidth = width;
+	int levelHeight = height;
+	for (int level = 0; level < mipLevels; level++)
+	{
+		glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layerIndex,
+			levelWidth, levelHeight, 1, internalFormat, levelSizes[level], pLevels[level]);
+		levelWidth = (levelWidth > 1) ? (levelWidth / 2) : 1;
+		levelHeight = (levelHeight > 1) ? (levelHeight / 2) : 1;
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	if ((texture.bLoaded == true) && (pageIndex != texture.page))
+	{
+		FreeLayer(texture.page, texture.layer);
+	}
+	texture.page = pageIndex;
+	texture.layer = layerIndex;
+	texture.bLoaded = true;
+	texture.bEvicted = false;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreatePlaceholder()
+ *
+ *  This method is used for uploading the single pixel
+ *  placeholder texture the first time it is needed.
+ ***********************************************************/
+void TextureRegistry::CreatePlaceholder()
+{
+	if (m_placeholderPage >= 0)
+	{
+		return;
+	}
+
+	UploadLayer(g_PlaceholderColor, 1, 1, GL_RGBA, false, m_placeholderPage, m_placeholderLayer);
+}
+
+/***********************************************************
+ *  FindOrCreatePage()
+ *
+ *  This method is used for finding a page of the passed in
+ *  size and format that has a free layer.  A full page is
+ *  grown, a released page is allocated again, and a new page
+ *  is allocated when there is none of that size and format,
+ *  or the page cannot grow any more.
+ ***********************************************************/
+int TextureRegistry::FindOrCreatePage(int width, int height, GLenum internalFormat, int mipLevels)
+{
+	GLint maxLayers = 0;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+	for (int i = 0; i < m_pages.size(); i++)
+	{
+		TEXTURE_PAGE& page = m_pages[i];
+		if ((page.width != width) || (page.height != height) ||
+			(page.internalFormat != internalFormat) || (page.mipLevels != mipLevels))
+		{
+			continue;
+		}
+
+		if ((page.freeLayers.size() > 0) || (page.layerCount < page.layerCapacity))
+		{
+			return(i);
+		}
+		if (page.layerCount >= maxLayers)
+		{
+			continue;
+		}
+
+		int layerCapacity = page.layerCapacity * 2;
+		if (layerCapacity < g_InitialPageLayers)
+		{
+			layerCapacity = g_InitialPageLayers;
+		}
+		if (layerCapacity > maxLayers)
+		{
+			layerCapacity = maxLayers;
+		}
+		if (GrowPage(page, layerCapacity) == true)
+		{
+			return(i);
+		}
+	}
+
+	TEXTURE_PAGE page;
+	page.arrayID = 0;
+	page.width = width;
+	page.height = height;
+	page.internalFormat = internalFormat;
+	page.mipLevels = mipLevels;
+	page.layerCount = 0;
+	page.layerCapacity = 0;
+	page.usedLayers = 0;
+	page.bMipmapsDirty = false;
+
+	if (GrowPage(page, g_InitialPageLayers) == false)
+	{
+		return(-1);
+	}
+
+	m_pages.push_back(page);
+	return((int)m_pages.size() - 1);
+}
+
+/***********************************************************
+ *  GrowPage()
+ *
+ *  This method is used for reallocating the passed in page
+ *  with the passed in number of layers.  The layers already
+ *  in the page are copied over on the GPU.  Compressed layers
+ *  can only be copied with ARB_copy_image, so without it a
+ *  full compressed page does not grow.
+ ***********************************************************/
+bool TextureRegistry::GrowPage(TEXTURE_PAGE& page, int layerCapacity)
+{
+	GLuint arrayID = 0;
+	bool bCompressed = (page.internalFormat != GL_RGBA8);
+
+	if (bCompressed && (page.layerCount > 0) && !GLEW_ARB_copy_image)
+	{
+		return(false);
+	}
+
+	glGenTextures(1, &arrayID);
+	if (0 == arrayID)
+	{
+		std::cout << "Could not create texture array for " << page.width << "x" << page.height << " textures" << std::endl;
+		return(false);
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, arrayID);
+	if (bCompressed)
+	{
+		// allocate every mip level, since they are uploaded
+		// instead of generated
+		int levelWidth = page.width;
+		int levelHeight = page.height;
+		int blockBytes = (page.internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) ? 8 : 16;
+		for (int level = 0; level < page.mipLevels; level++)
+		{
+			GLsizei levelSize = ((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockBytes * layerCapacity;
+			glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, page.internalFormat, levelWidth, levelHeight, layerCapacity, 0, levelSize, NULL);
+			levelWidth = (levelWidth > 1) ? (levelWidth / 2) : 1;
+			levelHeight = (levelHeight > 1) ? (levelHeight / 2) : 1;
+		}
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, page.mipLevels - 1);
+	}
+	else
+	{
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, page.width, page.height, layerCapacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	}
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters - minified textures blend
+	// between the uploaded or generated mip levels
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// copy the existing compressed layers level by level
+	if (bCompressed && (page.layerCount > 0))
+	{
+		int levelWidth = page.width;
+		int levelHeight = page.height;
+		for (int level = 0; level < page.mipLevels; level++)
+		{
+			glCopyImageSubData(page.arrayID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+				arrayID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+				levelWidth, levelHeight, page.layerCount);
+			levelWidth = (levelWidth > 1) ? (levelWidth / 2) : 1;
+			levelHeight = (levelHeight > 1) ? (levelHeight / 2) : 1;
+		}
+	}
+	// copy the existing layers into the new array, one layer
+	// at a time through the copy framebuffer
+	else if (page.layerCount > 0)
+	{
+		if (0 == m_copyFramebufferID)
+		{
+			glGenFramebuffers(1, &m_copyFramebufferID);
+		}
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_copyFramebufferID);
+		for (int layer = 0; layer < page.layerCount; layer++)
+		{
+			glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, page.arrayID, 0, layer);
+			glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, 0, 0, page.width, page.height);
+		}
+		glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 0, 0, 0);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+		page.bMipmapsDirty = true;
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	if (0 != page.arrayID)
+	{
+		glDeleteTextures(1, &page.arrayID);
+		TrackPageBytes(page, false);
+	}
+	page.arrayID = arrayID;
+	page.layerCapacity = layerCapacity;
+	TrackPageBytes(page, true);
+
+	// the old array may still be bound to a texture unit
+	m_boundPages.clear();
+
+	return(true);
+}
+
+/***********************************************************
+ *  AllocateLayer()
+ *
+ *  This method is used for taking a layer of the passed in
+ *  page for a texture.  A freed layer is used again before
+ *  the next one that was never used, and the page must have
+ *  room for one of them.
+ ***********************************************************/
+int TextureRegistry::AllocateLayer(int page)
+{
+	TEXTURE_PAGE& texturePage = m_pages[page];
+	int layer = 0;
+
+	if (texturePage.freeLayers.size() > 0)
+	{
+		layer = texturePage.freeLayers.back();
+		texturePage.freeLayers.pop_back();
+	}
+	else
+	{
+		layer = texturePage.layerCount;
+		texturePage.layerCount++;
+	}
+	texturePage.usedLayers++;
+
+	return(layer);
+}
+
+/***********************************************************
+ *  FreeLayer()
+ *
+ *  This method is used for giving back a layer of the passed
+ *  in page when its texture no longer uses it.  The array
+ *  texture of a page is released once none of its layers
+ *  are used.
+ ***********************************************************/
+void TextureRegistry::FreeLayer(int page, int layer)
+{
+	if ((page < 0) || (page >= m_pages.size()))
+	{
+		return;
+	}
+
+	TEXTURE_PAGE& texturePage = m_pages[page];
+	texturePage.freeLayers.push_back(layer);
+	texturePage.usedLayers--;
+	if (texturePage.usedLayers <= 0)
+	{
+		ReleasePage(texturePage);
+	}
+}
+
+/***********************************************************
+ *  ReleasePage()
+ *
+ *  This method is used for freeing the array texture of the
+ *  passed in page.  The page keeps its size and format, so
+ *  it is allocated again for the next texture that fits it.
+ ***********************************************************/
+void TextureRegistry::ReleasePage(TEXTURE_PAGE& page)
+{
+	if (0 != page.arrayID)
+	{
+		glDeleteTextures(1, &page.arrayID);
+		TrackPageBytes(page, false);
+		page.arrayID = 0;
+	}
+	page.layerCount = 0;
+	page.layerCapacity = 0;
+	page.usedLayers = 0;
+	page.freeLayers.clear();
+	page.bMipmapsDirty = false;
+
+	// the released array may still be bound to a texture unit
+	m_boundPages.clear();
+}
+
+/***********************************************************
+ *  TrackPageBytes()
+ *
+ *  This method is used for adding the size of the passed in
+ *  page to the memory tracker, with the first level of its
+ *  layers counted as textures and the levels below as mip
+ *  chains, or for removing it before the page is freed.
+ ***********************************************************/
+void TextureRegistry::TrackPageBytes(const TEXTURE_PAGE& page, bool bAllocate)
+{
+	size_t baseBytes = 0;
+	size_t mipBytes = 0;
+
+	if (NULL == m_pMemoryTracker)
+	{
+		return;
+	}
+
+	GetPageBytes(page, baseBytes, mipBytes);
+	if (bAllocate == true)
+	{
+		m_pMemoryTracker->Allocate(GpuMemoryTracker::MEMORY_TEXTURES, baseBytes);
+		m_pMemoryTracker->Allocate(GpuMemoryTracker::MEMORY_MIP_CHAINS, mipBytes);
+	}
+	else
+	{
+		m_pMemoryTracker->Release(GpuMemoryTracker::MEMORY_TEXTURES, baseBytes);
+		m_pMemoryTracker->Release(GpuMemoryTracker::MEMORY_MIP_CHAINS, mipBytes);
+	}
+}
+
+/***********************************************************
+ *  GenerateMipmaps()
+ *
+ *  This method is used for generating the texture mipmaps of
+ *  every page that has received new layers, for mapping the
+ *  textures to lower resolutions.
+ ***********************************************************/
+void TextureRegistry::GenerateMipmaps()
+{
+	for (TEXTURE_PAGE& page : m_pages)
+	{
+		if ((page.bMipmapsDirty == true) && (0 != page.arrayID))
+		{
+			glBindTexture(GL_TEXTURE_2D_ARRAY, page.arrayID);
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+			page.bMipmapsDirty = false;
+		}
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	m_boundPages.clear();
+}
+
+/***********************************************************
+ *  BindPage()
+ *
+ *  This method is used for binding the array texture of the
+ *  passed in page to the passed in texture unit.  Nothing is
+ *  bound when the page is already bound to that unit.
+ ***********************************************************/
+void TextureRegistry::BindPage(int page, GLuint textureUnit)
+{
+	if ((page < 0) || (page >= m_pages.size()))
+	{
+		return;
+	}
+
+	if (textureUnit >= m_boundPages.size())
+	{
+		m_boundPages.resize(textureUnit + 1, -1);
+	}
+	if (m_boundPages[textureUnit] == page)
+	{
+		return;
+	}
+
+	glActiveTexture(GL_TEXTURE0 + textureUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_pages[page].arrayID);
+	m_boundPages[textureUnit] = page;
+	if (NULL != m_pRenderStats)
+	{
+		m_pRenderStats->CountTextureBind();
+	}
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the array textures of all
+ *  the pages and forgetting the registered textures.
+ ***********************************************************/
+void TextureRegistry::Destroy()
+{
+	for (TEXTURE_PAGE& page : m_pages)
+	{
+		if (0 != page.arrayID)
+		{
+			glDeleteTextures(1, &page.arrayID);
+			TrackPageBytes(page, false);
+			page.arrayID = 0;
+		}
+	}
+	if (0 != m_copyFramebufferID)
+	{
+		glDeleteFramebuffers(1, &m_copyFramebufferID);
+		m_copyFramebufferID = 0;
+	}
+
+	m_pages.clear();
+	m_textures.clear();
+	m_handlesByTag.clear();
+	m_boundPages.clear();
+	m_placeholderPage = -1;
+	m_placeholderLayer = 0;
+}
+
+/***********************************************************
+ *  AddReference()
+ *
+ *  This method is used for counting one more user of the
+ *  texture with the passed in handle, which keeps it from
+ *  being evicted.
+ ***********************************************************/
+void TextureRegistry::AddReference(int textureHandle)
+{
+	if ((textureHandle < 0) || (textureHandle >= m_textures.size()))
+	{
+		return;
+	}
+
+	m_textures[textureHandle].references++;
+}
+
+/***********************************************************
+ *  ReleaseReference()
+ *
+ *  This method is used for counting one user less of the
+ *  texture with the passed in handle.  A texture without
+ *  users stays loaded until it is evicted.
+ ***********************************************************/
+void TextureRegistry::ReleaseReference(int textureHandle)
+{
+	if ((textureHandle < 0) || (textureHandle >= m_textures.size()))
+	{
+		return;
+	}
+
+	if (m_textures[textureHandle].references > 0)
+	{
+		m_textures[textureHandle].references--;
+	}
+}
+
+/***********************************************************
+ *  EvictUnusedTextures()
+ *
+ *  This method is used for freeing the layers of the loaded
+ *  textures that have no users, so the next textures use
+ *  them instead of growing the pages.  The evicted textures
+ *  stay registered under their tags and show the placeholder
+ *  until their image is set again.
+ ***********************************************************/
+int TextureRegistry::EvictUnusedTextures()
+{
+	int evictedCount = 0;
+
+	for (TEXTURE_INFO& texture : m_textures)
+	{
+		if ((texture.bLoaded == false) || (texture.references > 0))
+		{
+			continue;
+		}
+
+		FreeLayer(texture.page, texture.layer);
+		texture.page = m_placeholderPage;
+		texture.layer = m_placeholderLayer;
+		texture.bLoaded = false;
+		texture.bEvicted = true;
+		evictedCount++;
+	}
+
+	return(evictedCount);
+}
+
+/***********************************************************
+ *  RestoreTexture()
+ *
+ *  This method is used for checking whether the texture with
+ *  the passed in handle was evicted, in which case the caller
+ *  must set its image again.  The flag is cleared, so the
+ *  image is only requested once.
+ ***********************************************************/
+bool TextureRegistry::RestoreTexture(int textureHandle)
+{
+	if ((textureHandle < 0) || (textureHandle >= m_textures.size()) ||
+		(m_textures[textureHandle].bEvicted == false))
+	{
+		return(false);
+	}
+
+	m_textures[textureHandle].bEvicted = false;
+	return(true);
+}
+
+/***********************************************************
+ *  FindTexture()
+ *
+ *  This method is used for getting the handle of the texture
+ *  registered with the passed in tag, or -1 if there is none.
+ ***********************************************************/
+int TextureRegistry::FindTexture(const std::string& tag) const
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_handlesByTag.find(tag);
+	if (found == m_handlesByTag.end())
+	{
+		return(-1);
+	}
+
+	return(found->second);
+}
+
+/***********************************************************
+ *  GetTexturePage()
+ *
+ *  This method is used for getting the page holding the
+ *  texture with the passed in handle, or -1 if there is none.
+ ***********************************************************/
+int TextureRegistry::GetTexturePage(int textureHandle) const
+{
+	if ((textureHandle < 0) || (textureHandle >= m_textures.size()))
+	{
+		return(-1);
+	}
+
+	return(m_textures[textureHandle].page);
+}
+
+/***********************************************************
+ *  GetTextureLayer()
+ *
+ *  This method is used for getting the layer of the texture
+ *  with the passed in handle in its page.
+ ***********************************************************/
+int TextureRegistry::GetTextureLayer(int textureHandle) const
+{
+	if ((textureHandle < 0) || (textureHandle >= m_textures.size()))
+	{
+		return(0);
+	}
+
+	return(m_textures[textureHandle].layer);
+}
+
+/***********************************************************
+ *  IsTextureLoaded()
+ *
+ *  This method is used for checking whether the image of the
+ *  texture with the passed in handle has been set, instead
+ *  of it showing the placeholder.
+ ***********************************************************/
+bool TextureRegistry::IsTextureLoaded(int textureHandle) const
+{
+	if ((textureHandle < 0) || (textureHandle >= m_textures.size()))
+	{
+		return(false);
+	}
+
+	return(m_textures[textureHandle].bLoaded);
+}
+
+/***********************************************************
+ *  IsTextureEvicted()
+ *
+ *  This method is used for checking whether the image of the
+ *  texture with the passed in handle was freed to make room,
+ *  and has not been requested again.
+ ***********************************************************/
+bool TextureRegistry::IsTextureEvicted(int textureHandle) const
+{
+	if ((textureHandle < 0) || (textureHandle >= m_textures.size()))
+	{
+		return(false);
+	}
+
+	return(m_textures[textureHandle].bEvicted);
+}
+
+/***********************************************************
+ *  GetPageTextureID()
+ *
+ *  This method is used for getting the OpenGL array texture
+ *  of the passed in page.
+ ***********************************************************/
+GLuint TextureRegistry::GetPageTextureID(int page) const
+{
+	if ((page < 0) || (page >= m_pages.size()))
+	{
+		return(0);
+	}
+
+	return(m_pages[page].arrayID);
+}
@@ -0,0 +1,187 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureregistry.h
+// ============
+// manage the loaded textures as layers of 2D array textures
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderStats.h"
+#include "GpuMemoryTracker.h"
+
+#include <GL/glew.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  TextureRegistry
+ *
+ *  This class stores every registered texture as one layer
+ *  of a 2D array texture, called a page, that holds all the
+ *  textures of the same size and format.  A texture is selected by its
+ *  layer in a page instead of by a texture unit, so the
+ *  number of textures is not limited by the texture units.
+ *  The number of textures and the layers of a page grow as
+ *  textures are registered.  A texture can be reserved before
+ *  its image is available, and shows a placeholder until then.
+ *  The users of a texture hold references to it, and loaded
+ *  textures without references can be evicted to free their
+ *  layers for other textures - an evicted texture shows the
+ *  placeholder until its image is set again.  A page whose
+ *  layers are all free releases its array texture.
+ ***********************************************************/
+class TextureRegistry
+{
+public:
+	// constructor - the pages are counted in the memory
+	// tracker, when there is one
+	TextureRegistry(RenderStats* pRenderStats = NULL, GpuMemoryTracker* pMemoryTracker = NULL);
+	// destructor
+	~TextureRegistry();
+
+	// location of one registered texture
+	struct TEXTURE_INFO
+	{
+		std::string tag;
+		int page;
+		int layer;
+		bool bLoaded;
+		// number of users holding the texture
+		int references;
+		// true when the image was freed to make room
+		bool bEvicted;
+	};
+
+	// 2D array texture holding all the textures of one size
+	// and format - RGBA8 pages generate their mipmaps, while
+	// compressed pages have them uploaded
+	struct TEXTURE_PAGE
+	{
+		GLuint arrayID;
+		int width;
+		int height;
+		GLenum internalFormat;
+		int mipLevels;
+		int layerCount;
+		int layerCapacity;
+		// layers holding a texture, and the layers below
+		// layerCount that were freed and can be used again
+		int usedLayers;
+		std::vector<int> freeLayers;
+		bool bMipmapsDirty;
+	};
+
+	// copy the passed in image into a new layer and return
+	// the handle of the texture, or -1 when it failed
+	int AddTexture(
+		const std::string& tag,
+		const unsigned char* pImage,
+		int width,
+		int height,
+		int colorChannels);
+	// register a texture showing the placeholder and return
+	// its handle, or -1 when it failed
+	int ReserveTexture(const std::string& tag);
+	// copy the passed in image into a new layer for the
+	// previously reserved texture, or over its own layer when
+	// a loaded texture gets an image of the same size
+	bool SetTextureImage(
+		int textureHandle,
+		const unsigned char* pImage,
+		int width,
+		int height,
+		int colorChannels);
+	// copy the passed in compressed mip levels into a new
+	// layer for the previously reserved texture, or over its
+	// own layer as for SetTextureImage()
+	bool SetCompressedTextureImage(
+		int textureHandle,
+		GLenum internalFormat,
+		int width,
+		int height,
+		int mipLevels,
+		const unsigned char* const* pLevels,
+		const GLsizei* levelSizes);
+	// regenerate the mipmaps of the pages with new layers
+	void GenerateMipmaps();
+	// bind the passed in page to the passed in texture unit
+	void BindPage(int page, GLuint textureUnit);
+	// free all the pages and forget the registered textures
+	void Destroy();
+
+	// add or remove a user of the passed in texture
+	void AddReference(int textureHandle);
+	void ReleaseReference(int textureHandle);
+	// free the layers of the loaded textures without users and
+	// return how many were evicted
+	int EvictUnusedTextures();
+	// check whether a texture was evicted, clearing the flag so
+	// its image is requested only once
+	bool RestoreTexture(int textureHandle);
+
+	// find the handle of a registered texture by tag
+	int FindTexture(const std::string& tag) const;
+	// get the page and layer of a registered texture
+	int GetTexturePage(int textureHandle) const;
+	int GetTextureLayer(int textureHandle) const;
+	// check whether the image of a texture has been set
+	bool IsTextureLoaded(int textureHandle) const;
+	// check whether the image of a texture was evicted
+	bool IsTextureEvicted(int textureHandle) const;
+	// get the OpenGL array texture of a page
+	GLuint GetPageTextureID(int page) const;
+
+	int GetTextureCount() const { return((int)m_textures.size()); }
+	int GetPageCount() const { return((int)m_pages.size()); }
+
+private:
+	// counters of the texture binds, not owned and may be NULL
+	RenderStats* m_pRenderStats;
+	// tracker of the page memory, not owned and may be NULL
+	GpuMemoryTracker* m_pMemoryTracker;
+	// registered textures, indexed by handle
+	std::vector<TEXTURE_INFO> m_textures;
+	// texture handles by tag
+	std::unordered_map<std::string, int> m_handlesByTag;
+	// allocated pages
+	std::vector<TEXTURE_PAGE> m_pages;
+	// framebuffer used for copying layers when a page grows
+	GLuint m_copyFramebufferID;
+	// page bound to each texture unit, -1 when unknown
+	std::vector<int> m_boundPages;
+	// page and layer of the placeholder texture
+	int m_placeholderPage;
+	int m_placeholderLayer;
+
+	// find a page of the passed in size and format with a free layer
+	int FindOrCreatePage(int width, int height, GLenum internalFormat, int mipLevels);
+	// copy the passed in image into a new layer of its page,
+	// or over the passed in layer when bReplace is true and it
+	// is in a page of the same size
+	bool UploadLayer(
+		const unsigned char* pImage,
+		int width,
+		int height,
+		GLenum format,
+		bool bReplace,
+		int& page,
+		int& layer);
+	// check whether the passed in page holds textures of the
+	// passed in size and format
+	bool IsPageMatching(int page, int width, int height, GLenum internalFormat, int mipLevels) const;
+	// create the placeholder texture if it does not exist
+	void CreatePlaceholder();
+	// reallocate the passed in page with room for more layers
+	bool GrowPage(TEXTURE_PAGE& page, int layerCapacity);
+	// take a free layer of the passed in page, or give one back
+	int AllocateLayer(int page);
+	void FreeLayer(int page, int layer);
+	// free the array texture of the passed in page
+	void ReleasePage(TEXTURE_PAGE& page);
+	// count the size of the passed in page in the tracker, or
+	// stop counting it
+	void TrackPageBytes(const TEXTURE_PAGE& page, bool bAllocate);
+};
@@ -0,0 +1,217 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbuilder.cpp
+// ============
+// build the model matrices of many objects at once
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformBuilder.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of the global variables and defines
+namespace
+{
+	// objects built per block, so the values in between stay in
+	// the cache
+	const int g_BlockSize = 64;
+
+	/***********************************************************
+	 *  GetRotationScale()
+	 *
+	 *  This function is used for getting the upper 3x3 of the
+	 *  model matrix from the sines and cosines of the rotations
+	 *  about x, y and z and the scale, column by column.  It is
+	 *  the product rotation X * rotation Y * rotation Z with
+	 *  each column multiplied by its scale.  The nine values
+	 *  are written the passed in stride apart.
+	 ***********************************************************/
+	inline void GetRotationScale(
+		float cosX, float sinX,
+		float cosY, float sinY,
+		float cosZ, float sinZ,
+		float scaleX, float scaleY, float scaleZ,
+		float* pColumns,
+		int stride)
+	{
+		float sinXsinY = sinX * sinY;
+		float cosXsinY = cosX * sinY;
+
+		pColumns[0 * stride] = cosY * cosZ * scaleX;
+		pColumns[1 * stride] = (cosX * sinZ + sinXsinY * cosZ) * scaleX;
+		pColumns[2 * stride] = (sinX * sinZ - cosXsinY * cosZ) * scaleX;
+		pColumns[3 * stride] = -cosY * sinZ * scaleY;
+		pColumns[4 * stride] = (cosX * cosZ - sinXsinY * sinZ) * scaleY;
+		pColumns[5 * stride] = (sinX * cosZ + cosXsinY * sinZ) * scaleY;
+		pColumns[6 * stride] = sinY * scaleZ;
+		pColumns[7 * stride] = -sinX * cosY * scaleZ;
+		pColumns[8 * stride] = cosX * cosY * scaleZ;
+	}
+}
+
+/***********************************************************
+ *  TransformBuilder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformBuilder::TransformBuilder()
+{
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the transformations
+ *  of the batch, keeping the memory for the next batch.
+ ***********************************************************/
+void TransformBuilder::Clear()
+{
+	m_scaleX.clear();
+	m_scaleY.clear();
+	m_scaleZ.clear();
+	m_rotationX.clear();
+	m_rotationY.clear();
+	m_rotationZ.clear();
+	m_positionX.clear();
+	m_positionY.clear();
+	m_positionZ.clear();
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for adding the transformation values
+ *  of an object to the batch.
+ ***********************************************************/
+int TransformBuilder::Add(const glm::vec3& scaleXYZ, const glm::vec3& rotationDegrees, const glm::vec3& positionXYZ)
+{
+	m_scaleX.push_back(scaleXYZ.x);
+	m_scaleY.push_back(scaleXYZ.y);
+	m_scaleZ.push_back(scaleXYZ.z);
+	m_rotationX.push_back(glm::radians(rotationDegrees.x));
+	m_rotationY.push_back(glm::radians(rotationDegrees.y));
+	m_rotationZ.push_back(glm::radians(rotationDegrees.z));
+	m_positionX.push_back(positionXYZ.x);
+	m_positionY.push_back(positionXYZ.y);
+	m_positionZ.push_back(positionXYZ.z);
+
+	return((int)m_scaleX.size() - 1);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the model matrices of
+ *  the batch.  Each block first takes the sines and cosines
+ *  of all its rotations, then the rotation and scale columns
+ *  into separate arrays, and only then writes the matrices,
+ *  so the first two steps run over contiguous floats.
+ ***********************************************************/
+void TransformBuilder::Build(glm::mat4* pMatrices) const
+{
+	float cosX[g_BlockSize];
+	float sinX[g_BlockSize];
+	float cosY[g_BlockSize];
+	float sinY[g_BlockSize];
+	float cosZ[g_BlockSize];
+	float sinZ[g_BlockSize];
+	float columns[9][g_BlockSize];
+
+	int count = GetCount();
+	for (int first = 0; first < count; first += g_BlockSize)
+	{
+		int blockCount = std::min(g_BlockSize, count - first);
+		const float* pRotationX = m_rotationX.data() + first;
+		const float* pRotationY = m_rotationY.data() + first;
+		const float* pRotationZ = m_rotationZ.data() + first;
+		const float* pScaleX = m_scaleX.data() + first;
+		const float* pScaleY = m_scaleY.data() + first;
+		const float* pScaleZ = m_scaleZ.data() + first;
+
+		for (int i = 0; i < blockCount; i++)
+		{
+			cosX[i] = cosf(pRotationX[i]);
+			sinX[i] = sinf(pRotationX[i]);
+			cosY[i] = cosf(pRotationY[i]);
+			sinY[i] = sinf(pRotationY[i]);
+			cosZ[i] = cosf(pRotationZ[i]);
+			sinZ[i] = sinf(pRotationZ[i]);
+		}
+
+		for (int i = 0; i < blockCount; i++)
+		{
+			GetRotationScale(
+				cosX[i], sinX[i], cosY[i], sinY[i], cosZ[i], sinZ[i],
+				pScaleX[i], pScaleY[i], pScaleZ[i],
+				&columns[0][i],
+				g_BlockSize);
+		}
+
+		for (int i = 0; i < blockCount; i++)
+		{
+			glm::mat4& matrix = pMatrices[first + i];
+			matrix[0] = glm::vec4(columns[0][i], columns[1][i], columns[2][i], 0.0f);
+			matrix[1] = glm::vec4(columns[3][i], columns[4][i], columns[5][i], 0.0f);
+			matrix[2] = glm::vec4(columns[6][i], columns[7][i], columns[8][i], 0.0f);
+			matrix[3] = glm::vec4(m_positionX[first + i], m_positionY[first + i], m_positionZ[first + i], 1.0f);
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildModelMatrix()
+ *
+ *  This method is used for building a single model matrix
+ *  from the closed form of the batches.
+ ***********************************************************/
+glm::mat4 TransformBuilder::BuildModelMatrix(
+	const glm::vec3& scaleXYZ,
+	const glm::vec3& rotationDegrees,
+	const glm::vec3& positionXYZ)
+{
+	float rotationX = glm::radians(rotationDegrees.x);
+	float rotationY = glm::radians(rotationDegrees.y);
+	float rotationZ = glm::radians(rotationDegrees.z);
+	float columns[9];
+
+	GetRotationScale(
+		cosf(rotationX), sinf(rotationX),
+		cosf(rotationY), sinf(rotationY),
+		cosf(rotationZ), sinf(rotationZ),
+		scaleXYZ.x, scaleXYZ.y, scaleXYZ.z,
+		columns,
+		1);
+
+	glm::mat4 matrix;
+	matrix[0] = glm::vec4(columns[0], columns[1], columns[2], 0.0f);
+	matrix[1] = glm::vec4(columns[3], columns[4], columns[5], 0.0f);
+	matrix[2] = glm::vec4(columns[6], columns[7], columns[8], 0.0f);
+	matrix[3] = glm::vec4(positionXYZ, 1.0f);
+
+	return(matrix);
+}
+
+/***********************************************************
+ *  ComposeModelMatrix()
+ *
+ *  This method is used for building a model matrix the way
+ *  the scene manager used to - a separate matrix for the
+ *  scale, each rotation and the translation, multiplied
+ *  together.
+ ***********************************************************/
+glm::mat4 TransformBuilder::ComposeModelMatrix(
+	const glm::vec3& scaleXYZ,
+	const glm::vec3& rotationDegrees,
+	const glm::vec3& positionXYZ)
+{
+	glm::mat4 scale = glm::scale(scaleXYZ);
+	glm::mat4 rotationX = glm::rotate(glm::radians(rotationDegrees.x), glm::vec3(1.0f, 0.0f, 0.0f));
+	glm::mat4 rotationY = glm::rotate(glm::radians(rotationDegrees.y), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 rotationZ = glm::rotate(glm::radians(rotationDegrees.z), glm::vec3(0.0f, 0.0f, 1.0f));
+	glm::mat4 translation = glm::translate(positionXYZ);
+
+	return(translation * rotationX * rotationY * rotationZ * scale);
+}
@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbuilder.h
+// ============
+// build the model matrices of many objects at once
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  TransformBuilder
+ *
+ *  This class collects the scale, rotation and position of
+ *  a batch of objects in separate arrays, and builds their
+ *  model matrices in one pass.  Every matrix is written from
+ *  a closed form of translation * rotation X * rotation Y *
+ *  rotation Z * scale, without building the five separate
+ *  matrices and multiplying them.  The batch is processed in
+ *  blocks, each step a branch-free loop over the separate
+ *  arrays, so the compiler can run it on several objects at
+ *  a time.
+ ***********************************************************/
+class TransformBuilder
+{
+public:
+	// constructor
+	TransformBuilder();
+
+	// remove all the transformations of the batch
+	void Clear();
+	// add the transformation of an object to the batch,
+	// returning its index in the batch
+	int Add(const glm::vec3& scaleXYZ, const glm::vec3& rotationDegrees, const glm::vec3& positionXYZ);
+	int GetCount() const { return((int)m_scaleX.size()); }
+
+	// build the model matrix of every object of the batch, in
+	// the order they were added
+	void Build(glm::mat4* pMatrices) const;
+
+	// build one model matrix from the same closed form
+	static glm::mat4 BuildModelMatrix(
+		const glm::vec3& scaleXYZ,
+		const glm::vec3& rotationDegrees,
+		const glm::vec3& positionXYZ);
+	// build one model matrix by multiplying the separate scale,
+	// rotation and translation matrices, which the closed form
+	// is measured and checked against
+	static glm::mat4 ComposeModelMatrix(
+		const glm::vec3& scaleXYZ,
+		const glm::vec3& rotationDegrees,
+		const glm::vec3& positionXYZ);
+
+private:
+	// transformations of the batch as separate arrays, with
+	// the rotations in radians
+	std::vector<float> m_scaleX;
+	std::vector<float> m_scaleY;
+	std::vector<float> m_scaleZ;
+	std::vector<float> m_rotationX;
+	std::vector<float> m_rotationY;
+	std::vector<float> m_rotationZ;
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+};
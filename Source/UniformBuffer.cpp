@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformbuffer.cpp
+// ============
+// manage a std140 uniform buffer object bound at a fixed binding point
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UniformBuffer.h"
+
+#include <cstring>
+#include <iostream>
+
+/***********************************************************
+ *  UniformBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+UniformBuffer::UniformBuffer()
+{
+	m_bufferID = 0;
+	m_bindingPoint = 0;
+	m_size = 0;
+}
+
+/***********************************************************
+ *  ~UniformBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+UniformBuffer::~UniformBuffer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the uniform buffer with
+ *  the passed in size and binding it to the passed in
+ *  binding point, where it stays bound.
+ ***********************************************************/
+bool UniformBuffer::Create(GLuint bindingPoint, size_t size)
+{
+	Destroy();
+
+	glGenBuffers(1, &m_bufferID);
+	if (0 == m_bufferID)
+	{
+		std::cout << "Could not create uniform buffer for binding point " << bindingPoint << std::endl;
+		return(false);
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+	glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, m_bufferID);
+
+	m_bindingPoint = bindingPoint;
+	m_size = size;
+	m_shadowData.clear();
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the uniform buffer.
+ ***********************************************************/
+void UniformBuffer::Destroy()
+{
+	if (0 != m_bufferID)
+	{
+		glDeleteBuffers(1, &m_bufferID);
+		m_bufferID = 0;
+	}
+	m_size = 0;
+	m_shadowData.clear();
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for writing the passed in data into
+ *  the uniform buffer with a single sub-data call.  Nothing
+ *  is written when the data equals the last written data.
+ *  It returns true when the buffer was written.
+ ***********************************************************/
+bool UniformBuffer::Update(const void* pData, size_t size)
+{
+	if ((0 == m_bufferID) || (size > m_size))
+	{
+		return(false);
+	}
+
+	if ((m_shadowData.size() == size) && (memcmp(m_shadowData.data(), pData, size) == 0))
+	{
+		return(false);
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, size, pData);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	m_shadowData.assign((const unsigned char*)pData, (const unsigned char*)pData + size);
+
+	return(true);
+}
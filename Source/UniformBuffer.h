@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformbuffer.h
+// ============
+// manage a std140 uniform buffer object bound at a fixed binding point
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <vector>
+
+// fixed binding points of the uniform blocks shared by all shader programs
+enum UNIFORM_BLOCK_BINDING
+{
+	CAMERA_BLOCK_BINDING = 0,
+	LIGHT_BLOCK_BINDING = 1,
+	MATERIAL_BLOCK_BINDING = 2,
+	CLUSTER_BLOCK_BINDING = 3
+};
+
+/***********************************************************
+ *  UniformBuffer
+ *
+ *  This class owns one uniform buffer object that stays
+ *  bound to a fixed binding point.  Each update is written
+ *  with a single buffer sub-data call, and is skipped when
+ *  the data has not changed since the last update.
+ ***********************************************************/
+class UniformBuffer
+{
+public:
+	// constructor
+	UniformBuffer();
+	// destructor
+	~UniformBuffer();
+
+	// create the buffer with the passed in size and bind it
+	bool Create(GLuint bindingPoint, size_t size);
+	// free the buffer
+	void Destroy();
+	// write the passed in data into the buffer
+	bool Update(const void* pData, size_t size);
+
+	// check whether the buffer has been created
+	bool IsCreated() const { return(0 != m_bufferID); }
+
+private:
+	// OpenGL buffer object
+	GLuint m_bufferID;
+	// binding point the buffer is bound to
+	GLuint m_bindingPoint;
+	// size of the buffer in bytes
+	size_t m_size;
+	// copy of the last written data
+	std::vector<unsigned char> m_shadowData;
+};
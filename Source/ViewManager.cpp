@@ -14,14 +14,15 @@
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>    
 
+#include <cstring>
+
 // declaration of the global variables and defines
 namespace
 {
 	// Variables for window width and height
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
+	const char* g_CameraBlockName = "CameraBlock";
 
 	// camera object used for viewing and interacting with
 	// the 3D scene
@@ -32,13 +33,29 @@ namespace
 	float gLastY = WINDOW_HEIGHT / 2.0f;
 	bool gFirstMouse = true;
 
-	// time between current frame and last frame
+	// length of the time step the camera is moved by
 	float gDeltaTime = 0.0f; 
-	float gLastFrame = 0.0f;
 
 	// the following variable is false when orthographic projection
 	// is off and true when it is on
 	bool bOrthographicProjection = false;
+
+	// size of the framebuffer in pixels, and whether it has
+	// changed since the projection matrix was last built
+	int gFramebufferWidth = WINDOW_WIDTH;
+	int gFramebufferHeight = WINDOW_HEIGHT;
+	bool gFramebufferResized = true;
+
+	// keys that move the camera while they are held down
+	const int g_MovementKeys[] = {
+		GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_Q, GLFW_KEY_E };
+
+	// near and far clipping distances of both projections
+	const float g_NearPlane = 0.1f;
+	const float g_FarPlane = 100.0f;
+	// distance at which the orthographic view shows the same
+	// area as the perspective view with the same zoom
+	const float g_OrthographicDistance = 12.0f;
 }
 
 /***********************************************************
@@ -47,11 +64,28 @@ namespace
  *  The constructor for the class
  ***********************************************************/
 ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
+	ShaderManager *pShaderManager,
+	ShaderStateCache* pShaderState,
+	GpuMemoryTracker* pMemoryTracker)
 {
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
+	m_pShaderState = pShaderState;
+	m_pShaderState->RegisterUniformBlock(g_CameraBlockName, CAMERA_BLOCK_BINDING);
+	// the ring buffer is created once the OpenGL context exists
+	m_pCameraRing = NULL;
+	m_uniformAlignment = 0;
+	m_pMemoryTracker = pMemoryTracker;
 	m_pWindow = NULL;
+	m_view = glm::mat4(1.0f);
+	m_projection = glm::mat4(1.0f);
+	m_viewProjection = glm::mat4(1.0f);
+	// nothing has been built yet, so force the first build
+	m_projectionZoom = -1.0f;
+	m_bProjectionOrthographic = false;
+	m_cameraPosition = glm::vec3(0.0f);
+	m_cameraFront = glm::vec3(0.0f);
+	m_cameraUp = glm::vec3(0.0f);
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
@@ -69,7 +103,13 @@ ViewManager::~ViewManager()
 {
 	// free up allocated memory
 	m_pShaderManager = NULL;
+	m_pShaderState = NULL;
 	m_pWindow = NULL;
+	if (NULL != m_pCameraRing)
+	{
+		delete m_pCameraRing;
+		m_pCameraRing = NULL;
+	}
 	if (NULL != g_pCamera)
 	{
 		delete g_pCamera;
@@ -109,8 +149,16 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	// this callback is used to receive mouse scroll events
 	glfwSetScrollCallback(window, &ViewManager::Scroll_Callback);
 
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
+	// this callback is used to receive framebuffer size changes,
+	// the framebuffer can be larger than the window on high
+	// density displays, so start from its actual size
+	glfwSetFramebufferSizeCallback(window, &ViewManager::Framebuffer_Size_Callback);
+	glfwGetFramebufferSize(window, &gFramebufferWidth, &gFramebufferHeight);
+	glViewport(0, 0, gFramebufferWidth, gFramebufferHeight);
+	gFramebufferResized = true;
+
+	// set the blending used for supporting tranparent rendering -
+	// the scene manager only enables it for the transparent objects
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	m_pWindow = window;
@@ -159,6 +207,28 @@ void ViewManager::Scroll_Callback(GLFWwindow* window, double xoffset, double yof
 	}
 }
 
+/***********************************************************
+ *  Framebuffer_Size_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the framebuffer of the active GLFW display window is
+ *  resized.
+ ***********************************************************/
+void ViewManager::Framebuffer_Size_Callback(GLFWwindow* window, int width, int height)
+{
+	// a minimized window has an empty framebuffer, so keep the
+	// last size instead of building a degenerate projection
+	if ((width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	gFramebufferWidth = width;
+	gFramebufferHeight = height;
+	gFramebufferResized = true;
+	glViewport(0, 0, width, height);
+}
+
 
 /***********************************************************
  *  ProcessKeyboardEvents()
@@ -213,6 +283,39 @@ void ViewManager::ProcessKeyboardEvents()
 	// change between different projection views
 	if (glfwGetKey(m_pWindow, GLFW_KEY_1) == GLFW_PRESS)
 	{
+		ApplyViewPreset(VIEW_FRONT_ORTHOGRAPHIC);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_2) == GLFW_PRESS)
+	{
+		ApplyViewPreset(VIEW_SIDE_ORTHOGRAPHIC);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_3) == GLFW_PRESS)
+	{
+		ApplyViewPreset(VIEW_TOP_ORTHOGRAPHIC);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_4) == GLFW_PRESS)
+	{
+		ApplyViewPreset(VIEW_PERSPECTIVE);
+	}
+
+}
+
+/***********************************************************
+ *  ApplyViewPreset()
+ *
+ *  This method is used for moving the camera to one of the
+ *  preset views and switching to its projection.
+ ***********************************************************/
+void ViewManager::ApplyViewPreset(VIEW_PRESET preset)
+{
+	if (NULL == g_pCamera)
+	{
+		return;
+	}
+
+	switch (preset)
+	{
+	case VIEW_FRONT_ORTHOGRAPHIC:
 		// change to a multi-view orthographic projection
 		bOrthographicProjection = true;
 
@@ -220,9 +323,8 @@ void ViewManager::ProcessKeyboardEvents()
 		g_pCamera->Position = glm::vec3(-16.4f, 3.2f, 2.0f);
 		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
 		g_pCamera->Front = glm::vec3(0.9f, 0.0f, -1.0f);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_2) == GLFW_PRESS)
-	{
+		break;
+	case VIEW_SIDE_ORTHOGRAPHIC:
 		// change to a multi-view orthographic projection
 		bOrthographicProjection = true;
 
@@ -230,10 +332,8 @@ void ViewManager::ProcessKeyboardEvents()
 		g_pCamera->Position = glm::vec3(16.7f, 1.5f, -12.0f);
 		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
 		g_pCamera->Front = glm::vec3(-2.5f, 0.0f, -1.0f);
-
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_3) == GLFW_PRESS)
-	{
+		break;
+	case VIEW_TOP_ORTHOGRAPHIC:
 		// change to a multi-view orthographic projection
 		bOrthographicProjection = true;
 
@@ -241,9 +341,8 @@ void ViewManager::ProcessKeyboardEvents()
 		g_pCamera->Position = glm::vec3(0.0f, 27.0f, -20.0f); // 27 units above the table (which is at Y = 1.0, Z = -20.0)
 		g_pCamera->Up = glm::vec3(0.0f, 0.0f, -1.0f);         // Z-axis points "up" on screen
 		g_pCamera->Front = glm::vec3(0.0f, -1.0f, 0.0f);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_4) == GLFW_PRESS)
-	{
+		break;
+	case VIEW_PERSPECTIVE:
 		// change to perspective projection
 		bOrthographicProjection = false;
 
@@ -252,8 +351,95 @@ void ViewManager::ProcessKeyboardEvents()
 		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
 		g_pCamera->Front = glm::vec3(0.6f, -0.2f, -1.0f);
 		g_pCamera->Zoom = 80;
+		break;
+	}
+}
+
+/***********************************************************
+ *  SetCameraPose()
+ *
+ *  This method is used for placing the camera directly, for
+ *  scripted camera paths.
+ ***********************************************************/
+void ViewManager::SetCameraPose(
+	const glm::vec3& position,
+	const glm::vec3& front,
+	const glm::vec3& up,
+	bool bOrthographic)
+{
+	if (NULL == g_pCamera)
+	{
+		return;
 	}
 
+	bOrthographicProjection = bOrthographic;
+	g_pCamera->Position = position;
+	g_pCamera->Front = front;
+	g_pCamera->Up = up;
+}
+
+/***********************************************************
+ *  UpdateCamera()
+ *
+ *  This method is used for moving the camera by one fixed
+ *  time step of the held down keys, so it moves at the same
+ *  speed whatever the frame rate.
+ ***********************************************************/
+void ViewManager::UpdateCamera(float stepSeconds)
+{
+	gDeltaTime = stepSeconds;
+
+	// process any keyboard events that may be waiting in the 
+	// event queue
+	ProcessKeyboardEvents();
+}
+
+/***********************************************************
+ *  IsViewChanged()
+ *
+ *  This method is used for checking whether the camera, the
+ *  projection or the framebuffer size changed since the view
+ *  of the last frame was prepared.  The camera pose is
+ *  compared directly, without building the view matrix.
+ ***********************************************************/
+bool ViewManager::IsViewChanged() const
+{
+	if (NULL == g_pCamera)
+	{
+		return(false);
+	}
+
+	return((gFramebufferResized == true) ||
+		(m_projectionZoom != g_pCamera->Zoom) ||
+		(m_bProjectionOrthographic != bOrthographicProjection) ||
+		(m_cameraPosition != g_pCamera->Position) ||
+		(m_cameraFront != g_pCamera->Front) ||
+		(m_cameraUp != g_pCamera->Up));
+}
+
+/***********************************************************
+ *  IsCameraMoving()
+ *
+ *  This method is used for checking whether a key that moves
+ *  the camera is held down, since holding a key does not
+ *  send events to wake up the main loop.
+ ***********************************************************/
+bool ViewManager::IsCameraMoving() const
+{
+	if (NULL == m_pWindow)
+	{
+		return(false);
+	}
+
+	for (int key : g_MovementKeys)
+	{
+		if (glfwGetKey(m_pWindow, key) == GLFW_PRESS)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
 }
 
 /***********************************************************
@@ -266,31 +452,105 @@ void ViewManager::ProcessKeyboardEvents()
 void ViewManager::PrepareSceneView()
 {
 	glm::mat4 view;
-	glm::mat4 projection;
-
-	// per-frame timing
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
-
-	// process any keyboard events that may be waiting in the 
-	// event queue
-	ProcessKeyboardEvents();
 
 	// get the current view matrix from the camera
 	view = g_pCamera->GetViewMatrix();
+	m_cameraPosition = g_pCamera->Position;
+	m_cameraFront = g_pCamera->Front;
+	m_cameraUp = g_pCamera->Up;
+
+	// the projection only changes with the zoom, the projection
+	// mode and the framebuffer size
+	bool bProjectionChanged = false;
+	if ((gFramebufferResized == true) ||
+		(m_projectionZoom != g_pCamera->Zoom) ||
+		(m_bProjectionOrthographic != bOrthographicProjection))
+	{
+		UpdateProjection();
+		bProjectionChanged = true;
+	}
+
+	if ((bProjectionChanged == true) || (view != m_view))
+	{
+		m_view = view;
+		m_viewProjection = m_projection * m_view;
+	}
+
+	// create the camera ring buffer on first use, since the
+	// OpenGL context does not exist yet in the constructor
+	if (NULL == m_pCameraRing)
+	{
+		m_pCameraRing = new RingBuffer(m_pMemoryTracker);
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_uniformAlignment);
+	}
 
-	// define the current projection matrix
-	projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
+	// write the view and projection matrices and the view position
+	// of the camera into the next region of the ring buffer, and
+	// bind that range as the shared camera uniform block
+	size_t offset = 0;
+	m_pCameraRing->BeginFrame(sizeof(CAMERA_UNIFORMS) + m_uniformAlignment);
+	CAMERA_UNIFORMS* pCameraUniforms = (CAMERA_UNIFORMS*)m_pCameraRing->Map(
+		sizeof(CAMERA_UNIFORMS), m_uniformAlignment, offset);
+	if (NULL != pCameraUniforms)
+	{
+		CAMERA_UNIFORMS cameraUniforms;
+		cameraUniforms.view = m_view;
+		cameraUniforms.projection = m_projection;
+		cameraUniforms.viewPosition = glm::vec4(g_pCamera->Position, 1.0f);
+		memcpy(pCameraUniforms, &cameraUniforms, sizeof(cameraUniforms));
+		m_pCameraRing->Unmap();
+		glBindBufferRange(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING,
+			m_pCameraRing->GetBufferID(), offset, sizeof(CAMERA_UNIFORMS));
+	}
+}
+
+/***********************************************************
+ *  UpdateProjection()
+ *
+ *  This method is used for building the projection matrix
+ *  for the current zoom, projection mode and framebuffer
+ *  size.  The orthographic view covers the area that the
+ *  perspective view shows at a fixed distance, so the mouse
+ *  wheel zooms both of them.
+ ***********************************************************/
+void ViewManager::UpdateProjection()
+{
+	float aspectRatio = (GLfloat)gFramebufferWidth / (GLfloat)gFramebufferHeight;
 
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
+	if (bOrthographicProjection == true)
 	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		float halfHeight = g_OrthographicDistance * tanf(glm::radians(g_pCamera->Zoom) * 0.5f);
+		float halfWidth = halfHeight * aspectRatio;
+		m_projection = glm::ortho(-halfWidth, halfWidth, -halfHeight, halfHeight, g_NearPlane, g_FarPlane);
 	}
+	else
+	{
+		m_projection = glm::perspective(glm::radians(g_pCamera->Zoom), aspectRatio, g_NearPlane, g_FarPlane);
+	}
+
+	m_projectionZoom = g_pCamera->Zoom;
+	m_bProjectionOrthographic = bOrthographicProjection;
+	gFramebufferResized = false;
+}
+
+/***********************************************************
+ *  GetViewportWidth()
+ *
+ *  This method is used for getting the width of the
+ *  viewport in pixels.
+ ***********************************************************/
+int ViewManager::GetViewportWidth() const
+{
+	return(gFramebufferWidth);
+}
+
+/***********************************************************
+ *  GetViewportHeight()
+ *
+ *  This method is used for getting the height of the
+ *  viewport in pixels.
+ ***********************************************************/
+int ViewManager::GetViewportHeight() const
+{
+	return(gFramebufferHeight);
 }
\ No newline at end of file
@@ -10,6 +10,9 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "RingBuffer.h"
+#include "ShaderStateCache.h"
+#include "UniformBuffer.h"
 #include "camera.h"
 
 // GLFW library
@@ -18,9 +21,28 @@
 class ViewManager
 {
 public:
+	// std140 layout of the CameraBlock uniform block
+	struct CAMERA_UNIFORMS
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec4 viewPosition;
+	};
+
+	// camera views that can be selected with the keys 1 to 4
+	enum VIEW_PRESET
+	{
+		VIEW_FRONT_ORTHOGRAPHIC = 0,
+		VIEW_SIDE_ORTHOGRAPHIC,
+		VIEW_TOP_ORTHOGRAPHIC,
+		VIEW_PERSPECTIVE
+	};
+
 	// constructor
 	ViewManager(
-		ShaderManager* pShaderManager);
+		ShaderManager* pShaderManager,
+		ShaderStateCache* pShaderState,
+		GpuMemoryTracker* pMemoryTracker = NULL);
 	// destructor
 	~ViewManager();
 
@@ -29,11 +51,38 @@ public:
 
 	static void Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset);
 
+	// framebuffer size callback for keeping the viewport and the
+	// projection in step with the window
+	static void Framebuffer_Size_Callback(GLFWwindow* window, int width, int height);
+
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
+	// cached uniform locations and values of the shader program
+	ShaderStateCache* m_pShaderState;
+	// ring buffer the per-frame camera data is streamed
+	// through, and the offset alignment of uniform buffers
+	RingBuffer* m_pCameraRing;
+	GLint m_uniformAlignment;
+	// tracker of the ring buffer memory, not owned and may be NULL
+	GpuMemoryTracker* m_pMemoryTracker;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// view and projection matrices of the current frame, and
+	// their product for culling
+	glm::mat4 m_view;
+	glm::mat4 m_projection;
+	glm::mat4 m_viewProjection;
+	// zoom and projection mode the projection was built with
+	float m_projectionZoom;
+	bool m_bProjectionOrthographic;
+	// camera pose the view matrix was built from
+	glm::vec3 m_cameraPosition;
+	glm::vec3 m_cameraFront;
+	glm::vec3 m_cameraUp;
+
+	// rebuild the projection matrix
+	void UpdateProjection();
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
@@ -42,6 +91,29 @@ public:
 	// create the initial OpenGL display window
 	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
 	
+	// move the camera by one fixed time step of keyboard input
+	void UpdateCamera(float stepSeconds);
+	// check whether the view changed since the last frame
+	bool IsViewChanged() const;
+	// check whether a camera movement key is held down
+	bool IsCameraMoving() const;
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+
+	// move the camera to one of the preset views
+	void ApplyViewPreset(VIEW_PRESET preset);
+	// place the camera directly
+	void SetCameraPose(
+		const glm::vec3& position,
+		const glm::vec3& front,
+		const glm::vec3& up,
+		bool bOrthographic);
+
+	// get the view and projection matrices of the current frame
+	const glm::mat4& GetViewMatrix() const { return(m_view); }
+	const glm::mat4& GetProjectionMatrix() const { return(m_projection); }
+	const glm::mat4& GetViewProjectionMatrix() const { return(m_viewProjection); }
+	// get the size of the viewport in pixels
+	int GetViewportWidth() const;
+	int GetViewportHeight() const;
 };
\ No newline at end of file
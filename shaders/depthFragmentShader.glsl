@@ -0,0 +1,7 @@
+#version 330 core
+
+// the depth pre-pass only writes the depth of the opaque objects,
+// so there is nothing to shade
+void main()
+{
+}
@@ -0,0 +1,149 @@
+#version 330 core
+
+// the program is built in variants, each with its own set of these
+// defines added after the version line:
+//   USE_TEXTURE   the base color is read from the texture array
+//   USE_LIGHTING  the base color is lit by the light sources
+
+#define MAX_LIGHTS 256
+#define MAX_MATERIALS 256
+
+// std140 layout - each vec3 is packed together with the float after it
+struct Material
+{
+	vec3 ambientColor;
+	float ambientStrength;
+	vec3 diffuseColor;
+	float shininess;
+	vec3 specularColor;
+};
+
+// std140 layout - each vec3 is packed together with the float after it
+struct LightSource
+{
+	vec3 position;
+	float focalStrength;
+	vec3 ambientColor;
+	float specularIntensity;
+	vec3 diffuseColor;
+	float range;
+	vec3 specularColor;
+};
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+flat in int fragmentMaterialIndex;
+flat in int fragmentTextureLayer;
+
+out vec4 outFragmentColor;
+
+// per-frame camera data shared by all shader programs
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+// light table shared by all shader programs
+layout (std140) uniform LightBlock
+{
+	LightSource lightSources[MAX_LIGHTS];
+};
+
+// cluster grid the light lists are built for
+layout (std140) uniform ClusterBlock
+{
+	ivec4 clusterGrid;		// clusters in x, y and z, lights reaching every cluster
+	vec4 clusterSlicing;	// depth slice scale and bias, tile size in pixels
+};
+
+// offset and count of the light list of every cluster, followed by the lists
+uniform usamplerBuffer clusterLightLists;
+
+// material table shared by all shader programs
+layout (std140) uniform MaterialBlock
+{
+	Material materials[MAX_MATERIALS];
+};
+
+uniform sampler2DArray objectTexture;
+
+vec3 CalcLightSource(LightSource light, Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+
+void main()
+{
+#ifdef USE_TEXTURE
+	vec4 baseColor = texture(objectTexture, vec3(fragmentTextureCoordinate, fragmentTextureLayer));
+#else
+	// objects carry no color of their own, so an untextured object
+	// is white and takes its color from its material and the lights
+	vec4 baseColor = vec4(1.0f);
+#endif
+
+#ifdef USE_LIGHTING
+	vec3 lightNormal = normalize(fragmentVertexNormal);
+	vec3 viewDirection = normalize(viewPosition.xyz - fragmentPosition);
+	vec3 phongResult = vec3(0.0f);
+	Material material = materials[fragmentMaterialIndex];
+
+	// the light sources without a range come first and reach
+	// every fragment, the others are listed by the cluster of
+	// the fragment
+	for (int i = 0; i < clusterGrid.w; i++)
+	{
+		phongResult += CalcLightSource(lightSources[i], material, lightNormal, fragmentPosition, viewDirection);
+	}
+
+	float viewDepth = -(view * vec4(fragmentPosition, 1.0f)).z;
+	ivec3 cluster = ivec3(gl_FragCoord.xy / clusterSlicing.zw,
+		floor(log(max(viewDepth, 0.0001f)) * clusterSlicing.x + clusterSlicing.y));
+	cluster = clamp(cluster, ivec3(0), clusterGrid.xyz - 1);
+	int clusterIndex = (cluster.z * clusterGrid.y + cluster.y) * clusterGrid.x + cluster.x;
+	int listOffset = int(texelFetch(clusterLightLists, clusterIndex * 2).r);
+	int listCount = int(texelFetch(clusterLightLists, clusterIndex * 2 + 1).r);
+	for (int i = 0; i < listCount; i++)
+	{
+		int lightIndex = int(texelFetch(clusterLightLists, listOffset + i).r);
+		phongResult += CalcLightSource(lightSources[lightIndex], material, lightNormal, fragmentPosition, viewDirection);
+	}
+
+	outFragmentColor = vec4(phongResult * baseColor.xyz, baseColor.w);
+#else
+	outFragmentColor = baseColor;
+#endif
+}
+
+// calculate the phong lighting contribution of one light source
+vec3 CalcLightSource(LightSource light, Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+
+	// ambient lighting
+	ambient = light.ambientColor * material.ambientColor * material.ambientStrength;
+
+	// diffuse lighting
+	vec3 lightDirection = normalize(light.position - vertexPosition);
+	float impact = max(dot(lightNormal, lightDirection), 0.0f);
+	diffuse = impact * light.diffuseColor * material.diffuseColor;
+
+	// specular lighting
+	vec3 reflectDirection = reflect(-lightDirection, lightNormal);
+	float specularComponent = pow(max(dot(viewDirection, reflectDirection), 0.0f), light.focalStrength);
+	specular = light.specularIntensity * material.shininess * specularComponent * light.specularColor * material.specularColor;
+
+	// a light source with a range fades out smoothly and is
+	// gone at its range
+	float attenuation = 1.0f;
+	if (light.range > 0.0f)
+	{
+		float distanceRatio = length(light.position - vertexPosition) / light.range;
+		float falloff = clamp(1.0f - distanceRatio * distanceRatio, 0.0f, 1.0f);
+		attenuation = falloff * falloff;
+	}
+
+	return(attenuation * (ambient + diffuse + specular));
+}
@@ -0,0 +1,42 @@
+#version 330 core
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+// per-instance attributes - locations 3 to 6 hold the model matrix columns
+layout (location = 3) in mat4 instanceModel;
+layout (location = 7) in vec2 instanceUVscale;
+layout (location = 8) in ivec2 instanceIndices;	// material, texture
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+flat out int fragmentMaterialIndex;
+flat out int fragmentTextureLayer;
+
+// the depth pre-pass and the shading variants are separate programs
+// built from this shader, and the shading pass tests against the depth
+// of the pre-pass, so both must compute exactly the same positions
+invariant gl_Position;
+
+// per-frame camera data shared by all shader programs
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+void main()
+{
+	// transform the vertex into clip coordinates
+	gl_Position = projection * view * instanceModel * vec4(inVertexPosition, 1.0f);
+
+	// world space position and normal for the lighting calculations
+	fragmentPosition = vec3(instanceModel * vec4(inVertexPosition, 1.0f));
+	fragmentVertexNormal = mat3(transpose(inverse(instanceModel))) * inVertexNormal;
+	fragmentTextureCoordinate = inTextureCoordinate * instanceUVscale;
+	fragmentMaterialIndex = instanceIndices.x;
+	fragmentTextureLayer = instanceIndices.y;
+}